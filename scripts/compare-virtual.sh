@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Regression test of the socket-based stack: run ncs-plant and
+# ncs-controller in virtual-time mode on a packet trace and compare the
+# resulting state trace with simulate-event_queue (LQR, angle only) on the
+# same trace.
+#
+# Usage: compare-virtual.sh TRACE.csv [BUILD_DIR] [TOLERANCE]
+
+TRACE="$1"
+BUILD_DIR="${2:-.}"
+TOLERANCE="${3:-1e-6}"
+PORT=5999
+
+if [ -z "$TRACE" ]; then
+    echo "Usage: $0 TRACE.csv [BUILD_DIR] [TOLERANCE]"
+    exit 1
+fi
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "$TMP_DIR"' EXIT
+
+"$BUILD_DIR/simulate-event_queue" -i "$TRACE" -o "$TMP_DIR/reference.csv" -n 2 > /dev/null || exit 1
+
+"$BUILD_DIR/ncs-controller" -p $PORT -a > /dev/null &
+CONTROLLER_PID=$!
+sleep 0.5
+"$BUILD_DIR/ncs-plant" -d localhost -p $PORT -x 0.0 -a 0.349 -V "$TRACE" -f "$TMP_DIR/virtual.csv"
+STATUS=$?
+kill -INT $CONTROLLER_PID
+wait $CONTROLLER_PID 2> /dev/null
+[ $STATUS -eq 0 ] || exit 1
+
+# The virtual run is shorter (PARAM_RUNTIME); compare common time range.
+awk -F, -v tol="$TOLERANCE" '
+    NR == FNR { if (FNR > 1) ref[$1] = $0; next }
+    FNR == 1 { next }
+    {
+        if (!($1 in ref)) { missing++; next }
+        split(ref[$1], r, ",")
+        for (i = 2; i <= 5; i++) {
+            d = $i - r[i]; if (d < 0) d = -d
+            if (d > maxdiff) maxdiff = d
+        }
+        n++
+    }
+    END {
+        printf "compared %d states, max deviation %g, missing %d\n", n, maxdiff, missing
+        exit (n == 0 || missing > 0 || maxdiff > tol) ? 1 : 0
+    }' "$TMP_DIR/reference.csv" "$TMP_DIR/virtual.csv"
@@ -0,0 +1,50 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * Print an event trace written by simulate-event_queue or simulate-agv
+ * (option -E) as text, one line per event.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../events/event_trace.h"
+
+int main(int argc, char *argv[])
+{
+        if (argc != 2) {
+                fprintf(stderr, "Usage: %s TRACE \n", argv[0]);
+                exit(1);
+        }
+
+        FILE *f = fopen(argv[1], "rb");
+        if (f == NULL) {
+                perror("Could not open event trace");
+                exit(1);
+        }
+
+        char magic[sizeof(EVENT_TRACE_MAGIC)] = {0};
+        if (fread(magic, strlen(EVENT_TRACE_MAGIC), 1, f) != 1 || strcmp(magic, EVENT_TRACE_MAGIC) != 0) {
+                fprintf(stderr, "Not an event trace: %s\n", argv[1]);
+                exit(1);
+        }
+
+        event_record_t rec;
+        while (fread(&rec, sizeof(rec), 1, f) == 1)
+                EventTrace::print(rec, stdout);
+
+        if (ferror(f)) {
+                perror("Could not read event trace");
+                exit(1);
+        }
+        fclose(f);
+
+        return 0;
+}
@@ -0,0 +1,207 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * Offline computation of the gain table of the gain-scheduled LQR. Solves
+ * the Riccati equation of the state-dependent coefficient model of the
+ * pendulum on a grid of angles and angular velocities and writes the
+ * table loaded by GainScheduledLQR (option -G of simulate-event_queue and
+ * ncs-controller).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../controller/linear_model.h"
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#define MAX_STR_LEN 1024
+
+// Mass of pendulum [kg]
+#define PARAM_m 0.2
+// Mass of cart [kg]
+#define PARAM_M 0.5
+// Moment of Inertia [kg*m^2]
+#define PARAM_I 0.006
+// Length of pendulum to center of mass [m]
+#define PARAM_l 0.3
+
+// Default period of the discrete-time design [s] (simulation step, so
+// that the gain at the upright position is close to the continuous-time
+// LQR_K_ANGLE)
+#define PARAM_LQR_TS 0.0001
+// Default weights (same cost as the LQR of simulate-event_queue)
+#define PARAM_LQR_Q {1.0, 0.0, 1000.0, 0.0}
+#define PARAM_LQR_R 1.0
+
+// Default grid of angles [rad] and angular velocities [rad/s]
+#define PARAM_GRID_PHI_POINTS 61
+#define PARAM_GRID_PHI_MAX 1.2
+#define PARAM_GRID_OMEGA_POINTS 41
+#define PARAM_GRID_OMEGA_MAX 8.0
+
+// Global configuration parameters.
+char out_path[MAX_STR_LEN];
+double Ts = PARAM_LQR_TS;
+pendulum_state_t q = PARAM_LQR_Q;
+double r = PARAM_LQR_R;
+unsigned long n_phi = PARAM_GRID_PHI_POINTS;
+double phi_max = PARAM_GRID_PHI_MAX;
+unsigned long n_omega = PARAM_GRID_OMEGA_POINTS;
+double omega_max = PARAM_GRID_OMEGA_MAX;
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s -o FILENAME \n"
+                "-o FILENAME : output file (gain table) \n"
+                "-t TS : period of the discrete-time design in seconds (default: %g) \n"
+                "-q Q1,Q2,Q3,Q4 : state weights of x, v, phi, omega (default: 1,0,1000,0) \n"
+                "-r R : input weight (default: %g) \n"
+                "-a POINTS,MAX : grid of angles in [-MAX, MAX] rad (default: %d,%g) \n"
+                "-w POINTS,MAX : grid of angular velocities in [-MAX, MAX] rad/s (default: %d,%g) \n"
+                "\n",
+                prog, PARAM_LQR_TS, PARAM_LQR_R, PARAM_GRID_PHI_POINTS, PARAM_GRID_PHI_MAX,
+                PARAM_GRID_OMEGA_POINTS, PARAM_GRID_OMEGA_MAX);
+}
+
+/**
+ * Parse a comma-separated vector of four values.
+ */
+bool parse_vector(const char *str, pendulum_state_t &v)
+{
+        return (sscanf(str, "%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3]) == 4);
+}
+
+/**
+ * Parse a grid given as number of points and half width.
+ */
+bool parse_grid(const char *str, unsigned long &points, double &max)
+{
+        return (sscanf(str, "%lu,%lf", &points, &max) == 2 && points >= 2 && max > 0.0);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+
+        memset(out_path, 0, MAX_STR_LEN);
+
+        while ((opt = getopt(argc, argv, "o:t:q:r:a:w:")) != -1) {
+                switch (opt) {
+                case 'o':
+                        strncpy(out_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 't':
+                        Ts = atof(optarg);
+                        break;
+                case 'q':
+                        if (!parse_vector(optarg, q))
+                                return -1;
+                        break;
+                case 'r':
+                        r = atof(optarg);
+                        break;
+                case 'a':
+                        if (!parse_grid(optarg, n_phi, phi_max))
+                                return -1;
+                        break;
+                case 'w':
+                        if (!parse_grid(optarg, n_omega, omega_max))
+                                return -1;
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (strlen(out_path) == 0)
+                return -1;
+
+        if (Ts <= 0.0 || r <= 0.0)
+                return -1;
+
+        for (int i = 0; i < 4; i++) {
+                if (q[i] < 0.0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                exit(1);
+        }
+
+        struct timespec ts_start, ts_end;
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+        Matrix Q(4, 4);
+        for (int i = 0; i < 4; i++)
+                Q(i, i) = q[i];
+        Matrix R(1, 1);
+        R(0, 0) = r;
+
+        // Grid point (i, j) at index i*n_omega + j.
+        std::vector<pendulum_state_t> gains(n_phi * n_omega);
+        for (unsigned long i = 0; i < n_phi; i++) {
+                double phi = -phi_max + 2.0 * phi_max * i / (n_phi - 1);
+                for (unsigned long j = 0; j < n_omega; j++) {
+                        double omega = -omega_max + 2.0 * omega_max * j / (n_omega - 1);
+                        LinearModel model =
+                            discretize(sdc_pendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, phi, omega), Ts);
+                        Matrix P, K;
+                        if (!solve_dare(model, Q, R, P, K)) {
+                                fprintf(stderr,
+                                        "Riccati equation has no solution at phi = %g rad, omega = %g rad/s "
+                                        "(reduce the grid or check weights).\n",
+                                        phi, omega);
+                                exit(1);
+                        }
+                        for (int d = 0; d < 4; d++)
+                                gains[i * n_omega + j][d] = K(0, d);
+                }
+        }
+
+        FILE *f = fopen(out_path, "w");
+        if (f == NULL) {
+                perror("Could not write gain table");
+                exit(1);
+        }
+        fprintf(f, "# Gain table of the gain-scheduled LQR (Ts = %g s, Q = diag(%g,%g,%g,%g), R = %g)\n", Ts, q[0],
+                q[1], q[2], q[3], r);
+        fprintf(f, "gains %lu %.17g %lu %.17g\n", n_phi, phi_max, n_omega, omega_max);
+        for (const pendulum_state_t &K : gains)
+                fprintf(f, "%.17g %.17g %.17g %.17g\n", K[0], K[1], K[2], K[3]);
+        if (fclose(f) != 0) {
+                perror("Could not write gain table");
+                exit(1);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        double runtime = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+        printf("grid points: %zu (%.2f s)\n", gains.size(), runtime);
+
+        return 0;
+}
@@ -89,6 +89,32 @@ bool demarshaling_state(const uint8_t *data, size_t data_size, uint64_t &time, d
 	return true;
 }
 
+ssize_t marshaling_state_rtt(uint8_t *data, size_t max_data_size, uint64_t time, double angle, double omega, double x, double v, uint64_t rtt_usec)
+{
+	ssize_t len = marshaling_state(data, max_data_size, time, angle, omega, x, v);
+	
+	if (len == -1 || max_data_size < (size_t) len + sizeof(rtt_usec))
+		return -1;
+	
+	marshaling_uint64(rtt_usec, data+len);
+	len += sizeof(rtt_usec);
+	
+	return len;
+}
+
+bool demarshaling_state_rtt(const uint8_t *data, size_t data_size, uint64_t &rtt_usec)
+{
+	// The round-trip time follows time, angle, omega, x, and v.
+	size_t pos = sizeof(uint64_t) + 4*sizeof(double);
+	
+	if (data_size < pos + sizeof(rtt_usec))
+		return false;
+	
+	demarshaling_uint64(data+pos, rtt_usec);
+	
+	return true;
+}
+
 ssize_t marshaling_update(uint8_t *data, size_t max_data_size, uint64_t time, double u)
 {
 	size_t len = 0;
@@ -117,3 +143,50 @@ bool demarshaling_update(const uint8_t *data, size_t data_size, uint64_t &time,
 
 	return true;
 }
+
+ssize_t marshaling_horizon(uint8_t *data, size_t max_data_size, uint64_t time, uint64_t step_usec, const double *u, size_t n)
+{
+	size_t len = 0;
+	uint64_t n64 = n;
+
+	if (n == 0 || max_data_size < sizeof(time) + sizeof(step_usec) + sizeof(n64) + n*sizeof(double))
+		return -1;
+
+	marshaling_uint64(time, data);
+	len += sizeof(time);
+	marshaling_uint64(step_usec, data+len);
+	len += sizeof(step_usec);
+	marshaling_uint64(n64, data+len);
+	len += sizeof(n64);
+	for (size_t i = 0; i < n; i++) {
+		marshaling_double(u[i], data+len);
+		len += sizeof(double);
+	}
+
+	return len;
+}
+
+bool demarshaling_horizon(const uint8_t *data, size_t data_size, uint64_t &time, uint64_t &step_usec, double *u, size_t max_n, size_t &n)
+{
+	size_t pos = 0;
+	uint64_t n64;
+
+	if (data_size < sizeof(time) + sizeof(step_usec) + sizeof(n64) + sizeof(double))
+		return false;
+
+	demarshaling_uint64(data, time);
+	pos += sizeof(time);
+	demarshaling_uint64(data+pos, step_usec);
+	pos += sizeof(step_usec);
+	demarshaling_uint64(data+pos, n64);
+	pos += sizeof(n64);
+	if (n64 == 0 || n64 > max_n || data_size < pos + n64*sizeof(double))
+		return false;
+	for (size_t i = 0; i < n64; i++) {
+		demarshaling_double(data+pos, u[i]);
+		pos += sizeof(double);
+	}
+	n = n64;
+
+	return true;
+}
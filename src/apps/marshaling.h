@@ -16,8 +16,30 @@ ssize_t marshaling_state(uint8_t *data, size_t max_data_size, uint64_t time, dou
 
 bool demarshaling_state(const uint8_t *data, size_t data_size, uint64_t &time, double &angle, double &omega, double &x, double &v);
 
+/**
+ * State message with the plant's smoothed round-trip time appended.
+ * Receivers not interested in it can use demarshaling_state().
+ */
+ssize_t marshaling_state_rtt(uint8_t *data, size_t max_data_size, uint64_t time, double angle, double omega, double x, double v, uint64_t rtt_usec);
+
+/**
+ * Get the round-trip time of a state message.
+ *
+ * @return true if the message carries a round-trip time; false otherwise.
+ */
+bool demarshaling_state_rtt(const uint8_t *data, size_t data_size, uint64_t &rtt_usec);
+
 ssize_t marshaling_update(uint8_t *data, size_t max_data_size, uint64_t time, double u); 
 
 bool demarshaling_update(const uint8_t *data, size_t data_size, uint64_t &time, double &u);
 
+/**
+ * Horizon of future control values u[0..n-1], where u[k] applies from
+ * time + k*step_usec. Longer than an update message, so receivers can
+ * tell both apart by their length.
+ */
+ssize_t marshaling_horizon(uint8_t *data, size_t max_data_size, uint64_t time, uint64_t step_usec, const double *u, size_t n);
+
+bool demarshaling_horizon(const uint8_t *data, size_t data_size, uint64_t &time, uint64_t &step_usec, double *u, size_t max_n, size_t &n);
+
 #endif
@@ -0,0 +1,613 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * Microbenchmarks of the hot kernels of the simulators: the right-hand side
+ * of the pendulum ODE, RK4 steps, the event queue, the controllers, the state
+ * estimators, and the marshaling of messages.
+ *
+ * Every benchmark is repeated until one run takes at least the minimum time,
+ * and then run several more times with the same number of iterations. The
+ * median, minimum, and maximum time per operation are written as CSV, one
+ * line per benchmark. Given the output of an earlier run as baseline, the
+ * ratio to the baseline is added, and benchmarks that became slower than a
+ * threshold are reported through the exit status.
+ */
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../controller/kalman_filter.h"
+#include "../controller/lqr.h"
+#include "../controller/pid.h"
+#include "../events/event_queue.h"
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "marshaling.h"
+
+#define MAX_STR_LEN 1024
+#define MAX_PKT_SIZE 65535
+
+// Maximum number of repetitions of a benchmark
+#define MAX_REPETITIONS 1000
+
+// Same pendulum and controllers as simulate-event_queue.
+#define PARAM_m 0.2
+#define PARAM_M 0.5
+#define PARAM_I 0.006
+#define PARAM_l 0.3
+#define PARAM_angle 0.349
+#define PARAM_DT 0.0001
+
+#define PARAM_KP 10.0
+#define PARAM_KI 1.0
+#define PARAM_KD 1.0
+
+#define LQR_K_ANGLE                                                                                                    \
+        {                                                                                                              \
+                -1.0000000000001679, -2.7126628569811633, 42.94618303488281, 5.411763498735041                         \
+        }
+
+// Same estimator as ncs-controller.
+#define PARAM_KALMAN_TS 0.001
+#define PARAM_KALMAN_Q {1e-10, 1e-6, 1e-10, 1e-5}
+#define PARAM_KALMAN_R_X 1e-6
+#define PARAM_KALMAN_R_PHI 1e-6
+
+// Number of plants of the filter bank benchmark
+#define BENCH_BANK_PLANTS 1024
+
+// Duration simulated per call of simulate(d, dt, states) [s]
+#define BENCH_SIMULATE_DURATION 0.1
+
+// Number of packets of the packet trace read by the event queue
+// benchmarks; one packet is sent per ms and received 2 ms later.
+#define BENCH_PACKETS 10000
+#define BENCH_PACKET_INTERVAL 0.001
+#define BENCH_PACKET_DELAY 0.002
+
+// The states of simulate(dt, states) are dropped after this many steps,
+// such that memory does not grow with the number of iterations.
+#define BENCH_MAX_STATES 4096
+
+/**
+ * A benchmark runs its kernel a number of times and returns the time taken
+ * [ns] (without any setup) and the number of operations performed, which
+ * the time is divided by.
+ */
+struct benchmark_t {
+        const char *name;
+        // What one operation is
+        const char *op;
+        uint64_t (*run)(size_t iterations, size_t &ops);
+};
+
+struct result_t {
+        std::string name;
+        double ns_per_op;
+};
+
+// Global configuration parameters.
+char filter[MAX_STR_LEN];
+char baseline_path[MAX_STR_LEN];
+char output_path[MAX_STR_LEN];
+double min_time = 0.1;
+unsigned int repetitions = 5;
+double threshold = 1.1;
+bool list_only = false;
+
+// Packet trace read by the event queue benchmarks
+char packet_trace_path[MAX_STR_LEN];
+
+// Results of the kernels are added to this variable, such that the
+// compiler cannot drop the kernels.
+volatile double sink;
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s \n"
+                "-f SUBSTRING : run only benchmarks whose name contains SUBSTRING \n"
+                "-t SECONDS : minimum duration of one run of a benchmark (default: 0.1) \n"
+                "-r REPETITIONS : number of runs of a benchmark (1 to %d, default: 5) \n"
+                "-o FILENAME : write results to this CSV file instead of stdout \n"
+                "-b FILENAME : compare with the results of an earlier run \n"
+                "-x RATIO : report a regression if a benchmark is slower than RATIO times the baseline (default: 1.1) \n"
+                "-l : list benchmarks and exit \n"
+                "\n"
+                "Exit status 2 if a benchmark regressed compared to the baseline. \n"
+                "\n",
+                prog, MAX_REPETITIONS);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+        memset(filter, 0, MAX_STR_LEN);
+        memset(baseline_path, 0, MAX_STR_LEN);
+        memset(output_path, 0, MAX_STR_LEN);
+
+        while ((opt = getopt(argc, argv, "f:t:r:o:b:x:l")) != -1) {
+                switch (opt) {
+                case 'f':
+                        strncpy(filter, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 't':
+                        min_time = atof(optarg);
+                        break;
+                case 'r':
+                        repetitions = strtoul(optarg, NULL, 10);
+                        break;
+                case 'o':
+                        strncpy(output_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'b':
+                        strncpy(baseline_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'x':
+                        threshold = atof(optarg);
+                        break;
+                case 'l':
+                        list_only = true;
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (min_time <= 0.0 || threshold <= 0.0)
+                return -1;
+
+        if (repetitions < 1 || repetitions > MAX_REPETITIONS)
+                return -1;
+
+        return 0;
+}
+
+/**
+ * Monotonic time [ns].
+ */
+static uint64_t now_nsec()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static pendulum_state_t initial_state()
+{
+        return {0.0, 0.0, PARAM_angle, 0.0};
+}
+
+static uint64_t bench_pendulum_rhs(size_t iterations, size_t &ops)
+{
+        InvertedPendulum pendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, initial_state());
+        pendulum_state_t x = initial_state();
+        pendulum_state_t dxdt;
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                x[2] += 1e-9;
+                pendulum(x, dxdt, 0.0);
+                sum += dxdt[3];
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_pendulum_step(size_t iterations, size_t &ops)
+{
+        InvertedPendulum pendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, initial_state());
+        state_sequence_t states;
+        states.reserve(BENCH_MAX_STATES);
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                if (states.size() == BENCH_MAX_STATES)
+                        states.clear();
+                pendulum.simulate(PARAM_DT, states);
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + states.back().second[2];
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_pendulum_simulate(size_t iterations, size_t &ops)
+{
+        InvertedPendulum pendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, initial_state());
+        double sum = 0.0;
+
+        // Every call starts with an empty sequence, i.e., the time includes
+        // growing the sequence of states like in the simulators.
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                state_sequence_t states;
+                pendulum.simulate(BENCH_SIMULATE_DURATION, PARAM_DT, states);
+                sum += states.back().second[2];
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_event_queue_csv(size_t iterations, size_t &ops)
+{
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                EventQueue queue(packet_trace_path);
+                sum += queue.nextTime();
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations * BENCH_PACKETS;
+        return end - start;
+}
+
+static uint64_t bench_event_queue_run(size_t iterations, size_t &ops)
+{
+        uint64_t elapsed = 0;
+        size_t events = 0;
+
+        // Pushing the events of the packet trace (construction) is measured
+        // by event_queue_csv; this measures popping them and pushing and
+        // popping the cyclic updates.
+        for (size_t i = 0; i < iterations; i++) {
+                EventQueue queue(packet_trace_path);
+                queue.addReceiver([&events](const Event &) { events++; });
+                uint64_t start = now_nsec();
+                queue.run(BENCH_PACKETS * BENCH_PACKET_INTERVAL + BENCH_PACKET_DELAY);
+                elapsed += now_nsec() - start;
+        }
+
+        ops = events;
+        return elapsed;
+}
+
+static uint64_t bench_lqr_control(size_t iterations, size_t &ops)
+{
+        LQRegulator lqr(LQR_K_ANGLE);
+        pendulum_state_t state = initial_state();
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                state[2] += 1e-9;
+                sum += lqr.control(state);
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_lqr_control_position(size_t iterations, size_t &ops)
+{
+        LQRegulator lqr(LQR_K_ANGLE);
+        pendulum_state_t state = initial_state();
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                state[0] += 1e-9;
+                sum += lqr.control(state, 1.0);
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_pid_control(size_t iterations, size_t &ops)
+{
+        PIDController pid(PARAM_KP, PARAM_KI, PARAM_KD);
+        double t = 0.0;
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                t += PARAM_DT;
+                sum += pid.control(0.0, PARAM_angle, t);
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static KalmanFilter make_kalman_filter()
+{
+        const KalmanSettings settings = {PARAM_KALMAN_TS, PARAM_KALMAN_Q, PARAM_KALMAN_R_X, PARAM_KALMAN_R_PHI};
+        return KalmanFilter(PARAM_m, PARAM_M, PARAM_I, PARAM_l, settings, false);
+}
+
+static uint64_t bench_kalman_update(size_t iterations, size_t &ops)
+{
+        KalmanFilter kalman = make_kalman_filter();
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                const pendulum_state_t &x = kalman.update(i * PARAM_KALMAN_TS, 1e-9 * i, PARAM_angle);
+                kalman.input(0.1);
+                sum += x[2];
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_kalman_bank(size_t iterations, size_t &ops)
+{
+        KalmanFilterBank bank(make_kalman_filter(), BENCH_BANK_PLANTS);
+        std::vector<double> u(BENCH_BANK_PLANTS, 0.1);
+        std::vector<double> x(BENCH_BANK_PLANTS, 0.0);
+        std::vector<double> phi(BENCH_BANK_PLANTS, PARAM_angle);
+        for (size_t k = 0; k < BENCH_BANK_PLANTS; k++)
+                bank.reset(k, x[k], phi[k]);
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                x[i % BENCH_BANK_PLANTS] += 1e-9;
+                bank.update(u.data(), x.data(), phi.data());
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + bank.estimate(0)[2];
+        ops = iterations * BENCH_BANK_PLANTS;
+        return end - start;
+}
+
+static uint64_t bench_marshaling_state(size_t iterations, size_t &ops)
+{
+        uint8_t data[MAX_PKT_SIZE];
+        ssize_t sum = 0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++)
+                sum += marshaling_state(data, sizeof(data), i, PARAM_angle, 0.1, 0.2, 0.3);
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static uint64_t bench_demarshaling_state(size_t iterations, size_t &ops)
+{
+        uint8_t data[MAX_PKT_SIZE];
+        ssize_t size = marshaling_state(data, sizeof(data), 1, PARAM_angle, 0.1, 0.2, 0.3);
+        uint64_t time;
+        double angle, omega, x, v;
+        double sum = 0.0;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < iterations; i++) {
+                if (demarshaling_state(data, size, time, angle, omega, x, v))
+                        sum += angle;
+        }
+        uint64_t end = now_nsec();
+
+        sink = sink + sum;
+        ops = iterations;
+        return end - start;
+}
+
+static const benchmark_t benchmarks[] = {
+        {"pendulum_rhs", "evaluation", bench_pendulum_rhs},
+        {"pendulum_rk4_step", "step", bench_pendulum_step},
+        {"pendulum_simulate_100ms", "call", bench_pendulum_simulate},
+        {"event_queue_csv", "packet", bench_event_queue_csv},
+        {"event_queue_run", "event", bench_event_queue_run},
+        {"lqr_control", "call", bench_lqr_control},
+        {"lqr_control_position", "call", bench_lqr_control_position},
+        {"pid_control", "call", bench_pid_control},
+        {"kalman_update", "measurement", bench_kalman_update},
+        {"kalman_bank_1024", "plant", bench_kalman_bank},
+        {"marshaling_state", "message", bench_marshaling_state},
+        {"demarshaling_state", "message", bench_demarshaling_state},
+};
+
+/**
+ * Write the packet trace read by the event queue benchmarks to a temporary
+ * file.
+ *
+ * @return true on success; false on error (errno is set).
+ */
+static bool write_packet_trace()
+{
+        const char *tmpdir = getenv("TMPDIR");
+        snprintf(packet_trace_path, MAX_STR_LEN, "%s/microbench-XXXXXX", tmpdir ? tmpdir : "/tmp");
+        int fd = mkstemp(packet_trace_path);
+        if (fd == -1)
+                return false;
+        FILE *f = fdopen(fd, "w");
+        if (f == NULL) {
+                close(fd);
+                return false;
+        }
+
+        fprintf(f, "pktNumber,rcvdTime,sendTime\n");
+        for (unsigned int i = 0; i < BENCH_PACKETS; i++) {
+                double sent = i * BENCH_PACKET_INTERVAL;
+                fprintf(f, "%u,%.6f,%.6f\n", i, sent + BENCH_PACKET_DELAY, sent);
+        }
+
+        return (fclose(f) == 0);
+}
+
+/**
+ * Read the results of an earlier run.
+ *
+ * @return true on success; false on error (errno is set).
+ */
+static bool read_baseline(const char *path, std::vector<result_t> &results)
+{
+        FILE *f = fopen(path, "r");
+        if (f == NULL)
+                return false;
+
+        char line[MAX_STR_LEN];
+        while (fgets(line, sizeof(line), f) != NULL) {
+                if (line[0] == '#')
+                        continue;
+                char *comma = strchr(line, ',');
+                if (comma == NULL)
+                        continue;
+                // name,op,iterations,ns_per_op,...
+                char name[MAX_STR_LEN];
+                char op[MAX_STR_LEN];
+                unsigned long long iterations;
+                double ns_per_op;
+                if (sscanf(line, "%1023[^,],%1023[^,],%llu,%lf", name, op, &iterations, &ns_per_op) == 4)
+                        results.push_back({name, ns_per_op});
+        }
+
+        fclose(f);
+        return true;
+}
+
+/**
+ * Run a benchmark.
+ *
+ * @param iterations receives the number of iterations of one run
+ * @param ns_per_op receives the time per operation of every run [ns]
+ */
+static void run_benchmark(const benchmark_t &benchmark, size_t &iterations, std::vector<double> &ns_per_op)
+{
+        size_t ops;
+        uint64_t min_nsec = (uint64_t)(min_time * 1e9);
+
+        // Find the number of iterations taking at least the minimum time
+        // (this also warms up caches and branch predictors).
+        iterations = 1;
+        uint64_t elapsed = benchmark.run(iterations, ops);
+        while (elapsed < min_nsec) {
+                double factor = (elapsed > 0) ? 1.4 * min_nsec / elapsed : 100.0;
+                factor = std::min(std::max(factor, 2.0), 100.0);
+                iterations = (size_t)(iterations * factor);
+                elapsed = benchmark.run(iterations, ops);
+        }
+
+        ns_per_op.clear();
+        for (unsigned int r = 0; r < repetitions; r++) {
+                elapsed = benchmark.run(iterations, ops);
+                ns_per_op.push_back((double)elapsed / ops);
+        }
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                exit(1);
+        }
+
+        if (list_only) {
+                for (const benchmark_t &benchmark : benchmarks)
+                        printf("%s (per %s)\n", benchmark.name, benchmark.op);
+                return 0;
+        }
+
+        std::vector<result_t> baseline;
+        if (strlen(baseline_path) > 0 && !read_baseline(baseline_path, baseline)) {
+                perror("Could not read baseline");
+                exit(1);
+        }
+
+        FILE *out = stdout;
+        if (strlen(output_path) > 0) {
+                out = fopen(output_path, "w");
+                if (out == NULL) {
+                        perror("Could not open output file");
+                        exit(1);
+                }
+        }
+
+        if (!write_packet_trace()) {
+                perror("Could not write packet trace");
+                exit(1);
+        }
+
+        fprintf(out, "# name,op,iterations,ns_per_op,min_ns_per_op,max_ns_per_op");
+        if (!baseline.empty())
+                fprintf(out, ",baseline_ns_per_op,ratio");
+        fprintf(out, "\n");
+        fflush(out);
+
+        bool regression = false;
+        std::vector<double> ns_per_op;
+        for (const benchmark_t &benchmark : benchmarks) {
+                if (strstr(benchmark.name, filter) == NULL)
+                        continue;
+
+                size_t iterations;
+                run_benchmark(benchmark, iterations, ns_per_op);
+                std::sort(ns_per_op.begin(), ns_per_op.end());
+                double median = ns_per_op[ns_per_op.size() / 2];
+                if (ns_per_op.size() % 2 == 0)
+                        median = 0.5 * (median + ns_per_op[ns_per_op.size() / 2 - 1]);
+
+                fprintf(out, "%s,%s,%zu,%.3f,%.3f,%.3f", benchmark.name, benchmark.op, iterations, median,
+                        ns_per_op.front(), ns_per_op.back());
+                if (!baseline.empty()) {
+                        auto it = std::find_if(baseline.begin(), baseline.end(), [&](const result_t &result) {
+                                return result.name == benchmark.name;
+                        });
+                        if (it != baseline.end() && it->ns_per_op > 0.0) {
+                                double ratio = median / it->ns_per_op;
+                                fprintf(out, ",%.3f,%.3f", it->ns_per_op, ratio);
+                                if (ratio > threshold) {
+                                        regression = true;
+                                        fprintf(stderr, "Regression: %s takes %.2f times as long as the baseline\n",
+                                                benchmark.name, ratio);
+                                }
+                        } else {
+                                fprintf(out, ",,");
+                        }
+                }
+                fprintf(out, "\n");
+                fflush(out);
+        }
+
+        unlink(packet_trace_path);
+        if (out != stdout)
+                fclose(out);
+
+        return regression ? 2 : 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * Offline computation of the explicit MPC law with force limit for the
+ * pendulum. Writes the region table and kd-tree loaded by ExplicitMPC
+ * (option -M of simulate-event_queue and ncs-controller).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../controller/mpc_generator.h"
+
+#define MAX_STR_LEN 1024
+
+// Mass of pendulum [kg]
+#define PARAM_m 0.2
+// Mass of cart [kg]
+#define PARAM_M 0.5
+// Moment of Inertia [kg*m^2]
+#define PARAM_I 0.006
+// Length of pendulum to center of mass [m]
+#define PARAM_l 0.3
+
+// Default MPC problem
+#define PARAM_MPC_TS 0.02
+#define PARAM_MPC_N 10
+#define PARAM_MPC_UMAX 5.0
+// (same cost as the LQR of simulate-event_queue)
+#define PARAM_MPC_Q {1.0, 0.0, 1000.0, 0.0}
+#define PARAM_MPC_R 1.0
+
+// Default half widths of the explored box of states (x, v, phi, omega)
+#define PARAM_MPC_BOX {6.0, 4.0, 0.6, 4.0}
+
+// Default number of sampled states
+#define PARAM_MPC_SAMPLES 200000
+
+// Global configuration parameters.
+char out_path[MAX_STR_LEN];
+MPCSettings settings = {PARAM_MPC_TS, PARAM_MPC_N, PARAM_MPC_UMAX, PARAM_MPC_Q, PARAM_MPC_R, PARAM_MPC_BOX};
+unsigned long n_samples = PARAM_MPC_SAMPLES;
+unsigned int seed = 1;
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s -o FILENAME \n"
+                "-o FILENAME : output file (region table) \n"
+                "-N N : prediction horizon in steps (default: %d) \n"
+                "-t TS : duration of one step in seconds (default: %g) \n"
+                "-u UMAX : force limit in N (default: %g) \n"
+                "-q Q1,Q2,Q3,Q4 : state weights of x, v, phi, omega (default: 1,0,1000,0) \n"
+                "-r R : input weight (default: %g) \n"
+                "-b X,V,PHI,OMEGA : half widths of the explored box of states (default: 6,4,0.6,4) \n"
+                "-s SAMPLES : number of sampled states (default: %d) \n"
+                "-S SEED : seed of the random number generator (default: 1) \n"
+                "\n",
+                prog, PARAM_MPC_N, PARAM_MPC_TS, PARAM_MPC_UMAX, PARAM_MPC_R, PARAM_MPC_SAMPLES);
+}
+
+/**
+ * Parse a comma-separated vector of four values.
+ */
+bool parse_vector(const char *str, pendulum_state_t &v)
+{
+        return (sscanf(str, "%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3]) == 4);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+
+        memset(out_path, 0, MAX_STR_LEN);
+
+        while ((opt = getopt(argc, argv, "o:N:t:u:q:r:b:s:S:")) != -1) {
+                switch (opt) {
+                case 'o':
+                        strncpy(out_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'N':
+                        settings.N = atoi(optarg);
+                        break;
+                case 't':
+                        settings.Ts = atof(optarg);
+                        break;
+                case 'u':
+                        settings.umax = atof(optarg);
+                        break;
+                case 'q':
+                        if (!parse_vector(optarg, settings.q))
+                                return -1;
+                        break;
+                case 'r':
+                        settings.r = atof(optarg);
+                        break;
+                case 'b':
+                        if (!parse_vector(optarg, settings.box))
+                                return -1;
+                        break;
+                case 's':
+                        n_samples = strtoul(optarg, NULL, 10);
+                        break;
+                case 'S':
+                        seed = strtoul(optarg, NULL, 10);
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (strlen(out_path) == 0)
+                return -1;
+
+        if (settings.N == 0 || settings.Ts <= 0.0 || settings.umax <= 0.0 || settings.r <= 0.0)
+                return -1;
+
+        for (int i = 0; i < 4; i++) {
+                if (settings.q[i] < 0.0 || settings.box[i] <= 0.0)
+                        return -1;
+        }
+
+        return 0;
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                exit(1);
+        }
+
+        struct timespec ts_start, ts_end;
+        clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+        MPCGenerator generator(PARAM_m, PARAM_M, PARAM_I, PARAM_l, settings);
+        if (!generator.generate(n_samples, seed)) {
+                fprintf(stderr, "Riccati equation has no solution (check weights).\n");
+                exit(1);
+        }
+        if (!generator.write(out_path)) {
+                perror("Could not write region table");
+                exit(1);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &ts_end);
+        double runtime = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+        printf("regions: %zu, tree nodes: %zu, failed samples: %zu (%.2f s)\n", generator.regions(),
+               generator.nodes(), generator.failed_samples(), runtime);
+
+        return 0;
+}
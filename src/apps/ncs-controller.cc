@@ -6,26 +6,97 @@
  * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
  */
 
+#include <errno.h>
 #include <iostream>
 #include <unistd.h>
 #include <inttypes.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
+#include <time.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../inverted_pendulum/inverted_pendulum.h"
+#include "../controller/explicit_mpc.h"
+#include "../controller/gain_scheduled_lqr.h"
+#include "../controller/kalman_filter.h"
 #include "../controller/lqr.h"
-#include "../netutils/socket_utils.h"
+#include "../controller/packet_control.h"
+#include "../controller/state_predictor.h"
+#include "../netutils/shm_transport.h"
+#include "../netutils/transport.h"
+#include "../netutils/uring_transport.h"
 #include "marshaling.h"
 
 #define MAX_STR_LEN 1024
 #define MAX_PKT_SIZE 65535
 
+// Resolution of the wakeup latency histogram [ns]
+#define WAKEUP_HIST_RES_NSEC 100
+
+// Number of bins of the wakeup latency histogram (last bin: overflow).
+#define WAKEUP_HIST_BINS 100000
+
+// Plant model used for predicting horizons (same as ncs-plant)
+// Mass of pendulum [kg]
+#define PARAM_m 0.2
+// Mass of cart [kg]
+#define PARAM_M 0.5
+// Moment of Inertia [kg*m^2]
+#define PARAM_I 0.006
+// Length of pendulum to center of mass [m]
+#define PARAM_l 0.3
+
+// Default duration of one horizon step [us]
+#define PARAM_HORIZON_STEP_USEC 1000
+
+// Length of a horizon message with n control values (time, step, n, and
+// the values; see marshaling_horizon()) [bytes]
+#define HORIZON_MSG_LEN(n) (24 + 8*(n))
+
+// Longest round-trip delay covered by the linear state predictor [s]
+#define PARAM_PREDICTOR_MAX_DELAY 0.1
+
+// Noise model of the state estimator: sampling period of ncs-plant [s],
+// process noise variances per period, and variances of the measured
+// position [m^2] and angle [rad^2]
+#define PARAM_KALMAN_TS 0.001
+#define PARAM_KALMAN_Q {1e-10, 1e-6, 1e-10, 1e-5}
+#define PARAM_KALMAN_R_X 1e-6
+#define PARAM_KALMAN_R_PHI 1e-6
+
 // LQR gain matrix
 #define LQR_K {-3.162277660168483, -6.105688949485788, 49.16351188321586, 7.204143097154165}
 
+// LQR gain matrix for controlling the angle only (same as simulate-event_queue)
+#define LQR_K_ANGLE {-1.0000000000001679, -2.7126628569811633, 42.94618303488281, 5.411763498735041}
+
 // Global configuration parameters.
 char ctrl_service[MAX_STR_LEN];
-int sock;
+char shm_name[MAX_STR_LEN];
+char mpc_table[MAX_STR_LEN];
+char gain_table[MAX_STR_LEN];
+bool shm_busy_poll = false;
+bool use_uring = false;
+unsigned int busy_poll_usec = 0;
+bool angle_only = false;
+unsigned int horizon_len = 0;
+uint64_t horizon_step_usec = PARAM_HORIZON_STEP_USEC;
+bool delay_compensation = false;
+uint64_t expected_rtt_usec = 0;
+bool use_kalman = false;
+bool kalman_extended = false;
+
+volatile sig_atomic_t stop_requested = 0;
+
+// Wakeup latency (kernel receive timestamp until recv() returns).
+std::vector<uint64_t> wakeup_hist(WAKEUP_HIST_BINS, 0);
+uint64_t wakeup_cnt = 0;
+uint64_t wakeup_sum_nsec = 0;
+uint64_t wakeup_max_nsec = 0;
 
 /**
  * Exit application with given exit status.
@@ -45,6 +116,19 @@ void usage(const char *prog)
 {
      fprintf(stderr, "Usage: %s \n"
              "-p PORT : service name or port number \n"
+             "-s NAME : use shared-memory segment NAME instead of UDP (plant on same host) \n"
+             "-B : busy-poll for messages instead of sleeping (shared memory only) \n"
+             "-u : use io_uring for UDP (batches replies to bursts of states) \n"
+             "-P USEC : busy-poll UDP socket for up to USEC micro-seconds before blocking \n"
+             "-a : control angle only (LQR gains of simulate-event_queue) \n"
+             "-H N : send horizon of N predicted future control values instead of single value \n"
+             "       (at most 64; 60 with -s) \n"
+             "-h STEP : duration of one horizon step in micro-seconds (default: 1000) \n"
+             "-D USEC : compensate delay by predicting the state over the round-trip time reported by the plant \n"
+             "          (USEC: round-trip time in micro-seconds if the plant reports none) \n"
+             "-M FILE : explicit MPC with force limit (region table written by mpc-generate) instead of LQR \n"
+             "-G FILE : gain-scheduled LQR (gain table written by lqr-generate) instead of LQR \n"
+             "-K MODE : estimate the state of each plant from position and angle with a Kalman filter: linear or extended \n"
              "\n", prog);
 }
 
@@ -57,12 +141,58 @@ int parse_cmdline_args(int argc, char *argv[])
      int opt;
      
      memset(ctrl_service, 0, MAX_STR_LEN);
+     memset(shm_name, 0, MAX_STR_LEN);
+     memset(mpc_table, 0, MAX_STR_LEN);
+     memset(gain_table, 0, MAX_STR_LEN);
 
-     while ( (opt = getopt(argc, argv, "p:")) != -1 ) {
+     while ( (opt = getopt(argc, argv, "p:s:BuP:aH:h:D:M:G:K:")) != -1 ) {
 	     switch(opt) {
 	     case 'p' :
 		     strncpy(ctrl_service, optarg, MAX_STR_LEN-1);
 		     break;
+	     case 's' :
+		     strncpy(shm_name, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'B' :
+		     shm_busy_poll = true;
+		     break;
+	     case 'u' :
+		     use_uring = true;
+		     break;
+	     case 'P' :
+		     busy_poll_usec = atoi(optarg);
+		     break;
+	     case 'a' :
+		     angle_only = true;
+		     break;
+	     case 'H' : {
+		     char *end;
+		     long len = strtol(optarg, &end, 10);
+		     if (*end != '\0' || len < 0 || len > HORIZON_MAX_LEN)
+			     return -1;
+		     horizon_len = len;
+		     break;
+	     }
+	     case 'h' :
+		     horizon_step_usec = strtoull(optarg, NULL, 10);
+		     break;
+	     case 'D' :
+		     delay_compensation = true;
+		     expected_rtt_usec = strtoull(optarg, NULL, 10);
+		     break;
+	     case 'M' :
+		     strncpy(mpc_table, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'G' :
+		     strncpy(gain_table, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'K' :
+		     use_kalman = true;
+		     if (strcmp(optarg, "extended") == 0)
+			     kalman_extended = true;
+		     else if (strcmp(optarg, "linear") != 0)
+			     return -1;
+		     break;
 	     case ':' :
 	     case '?' :
 	     default :
@@ -70,12 +200,114 @@ int parse_cmdline_args(int argc, char *argv[])
 	     }
      }
      
-     if (strlen(ctrl_service) == 0)
+     if (strlen(ctrl_service) == 0 && strlen(shm_name) == 0)
+          return -1;
+
+     if (busy_poll_usec > 0 && (strlen(shm_name) > 0 || use_uring))
+          return -1;
+
+     if (horizon_len > HORIZON_MAX_LEN || horizon_step_usec == 0)
+          return -1;
+
+     // Horizon messages must fit into a message of the shared-memory
+     // transport (at most 60 values).
+     if (strlen(shm_name) > 0 && HORIZON_MSG_LEN(horizon_len) > SHM_MAX_MSG_SIZE)
+          return -1;
+
+     // Horizons are relative to the sampling time.
+     if (delay_compensation && horizon_len > 0)
+          return -1;
+
+     // Horizons are predicted with the LQR.
+     if ((strlen(mpc_table) > 0 || strlen(gain_table) > 0) && horizon_len > 0)
+          return -1;
+
+     if (strlen(mpc_table) > 0 && strlen(gain_table) > 0)
           return -1;
 
      return 0;
 }
 
+/**
+ * Signal handler requesting termination. A second signal terminates
+ * immediately (handler is reset).
+ */
+void handle_signal(int /* sig */)
+{
+     stop_requested = 1;
+}
+
+/**
+ * Record the wakeup latency of the last received message.
+ */
+void record_wakeup_latency(const UdpServerTransport *udp)
+{
+     struct timespec ts_rx;
+     if (!udp->rx_timestamp(ts_rx))
+	  return;
+     struct timespec ts_now;
+     clock_gettime(CLOCK_REALTIME, &ts_now);
+
+     int64_t latency_nsec = (int64_t)(ts_now.tv_sec - ts_rx.tv_sec)*1000000000 +
+	  (ts_now.tv_nsec - ts_rx.tv_nsec);
+     if (latency_nsec < 0)
+	  latency_nsec = 0;
+
+     size_t bin = latency_nsec/WAKEUP_HIST_RES_NSEC;
+     if (bin >= WAKEUP_HIST_BINS)
+	  bin = WAKEUP_HIST_BINS-1;
+     wakeup_hist[bin]++;
+     wakeup_cnt++;
+     wakeup_sum_nsec += latency_nsec;
+     if ((uint64_t)latency_nsec > wakeup_max_nsec)
+	  wakeup_max_nsec = latency_nsec;
+}
+
+/**
+ * Percentile of the wakeup latency [us].
+ */
+double wakeup_percentile(double p)
+{
+     uint64_t rank = (uint64_t)(p*wakeup_cnt);
+     uint64_t sum = 0;
+     for (size_t i = 0; i < WAKEUP_HIST_BINS; i++) {
+	  sum += wakeup_hist[i];
+	  if (sum > rank)
+	       return (i+0.5)*WAKEUP_HIST_RES_NSEC/1000.0;
+     }
+     return wakeup_max_nsec/1000.0;
+}
+
+/**
+ * Print CPU usage and wakeup latency.
+ */
+void print_stats(const struct timespec &ts_start, uint64_t n_msgs, const UdpServerTransport *udp)
+{
+     struct timespec ts_end;
+     clock_gettime(CLOCK_MONOTONIC, &ts_end);
+     double runtime = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec)/1e9;
+
+     struct rusage usage;
+     getrusage(RUSAGE_SELF, &usage);
+     double utime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec/1e6;
+     double stime = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec/1e6;
+
+     printf("runtime:         %f s\n", runtime);
+     printf("messages:        %" PRIu64 "\n", n_msgs);
+     printf("CPU time:        %f s user, %f s system (%.1f %% of one core)\n",
+	    utime, stime, 100.0*(utime+stime)/runtime);
+     if (n_msgs > 0)
+	  printf("CPU per message: %.2f us\n", 1e6*(utime+stime)/n_msgs);
+     if (udp != NULL && busy_poll_usec > 0)
+	  printf("spin hits:       %" PRIu64 " (blocked: %" PRIu64 ")\n",
+		 udp->spin_hits(), udp->block_hits());
+     if (wakeup_cnt > 0) {
+	  printf("wakeup latency:  mean %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us\n",
+		 wakeup_sum_nsec/1000.0/wakeup_cnt, wakeup_percentile(0.5),
+		 wakeup_percentile(0.99), wakeup_max_nsec/1000.0);
+     }
+}
+
 int main(int argc, char *argv[])
 {
 	if (parse_cmdline_args(argc, argv) == -1) {
@@ -83,24 +315,91 @@ int main(int argc, char *argv[])
 		die(1);
 	}	
 
-	// Create server socket for communication with plant.
-	if (datagram_server_sockets(NULL, ctrl_service, AF_UNSPEC, 0, &sock, 1) != 1) {
-                perror("Could not create socket");
-                die(1);
-        }
+	// Create transport for communication with plant.
+	Transport *transport;
+	UdpServerTransport *udp = NULL;
+	if (strlen(shm_name) > 0) {
+		ShmTransport *shm = new ShmTransport();
+		ShmTransport::Wakeup wakeup = shm_busy_poll ? ShmTransport::Wakeup::BUSY_POLL :
+			ShmTransport::Wakeup::FUTEX;
+		if (!shm->open(shm_name, ShmTransport::Role::CONTROLLER, wakeup)) {
+			perror("Could not create shared-memory segment");
+			die(1);
+		}
+		transport = shm;
+	} else if (use_uring) {
+		UringTransport *uring = new UringTransport();
+		if (!uring->open_server(ctrl_service, true)) {
+			perror("Could not set up io_uring socket");
+			die(1);
+		}
+		transport = uring;
+	} else {
+		udp = new UdpServerTransport();
+		if (!udp->open(ctrl_service)) {
+			perror("Could not create socket");
+			die(1);
+		}
+		if (!udp->enable_rx_timestamps())
+			perror("Could not enable receive timestamps");
+		if (busy_poll_usec > 0 && !udp->set_busy_poll(busy_poll_usec))
+			perror("Kernel busy polling not available, spinning in user space only");
+		transport = udp;
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handle_signal;
+	sa.sa_flags = SA_RESETHAND;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	struct timespec ts_start;
+	clock_gettime(CLOCK_MONOTONIC, &ts_start);
+	uint64_t n_msgs = 0;
 	
 	// Create LQR.
-	LQRegulator lqr(LQR_K);
+	const pendulum_state_t K = LQR_K;
+	const pendulum_state_t K_angle = LQR_K_ANGLE;
+	LQRegulator lqr(angle_only ? K_angle : K);
+	HorizonPredictor predictor(PARAM_m, PARAM_M, PARAM_I, PARAM_l, angle_only ? K_angle : K,
+				   0.000001*horizon_step_usec);
+	ExplicitMPC mpc;
+	bool use_mpc = (strlen(mpc_table) > 0);
+	if (use_mpc && !mpc.load(mpc_table)) {
+		perror("Could not load MPC region table");
+		die(1);
+	}
+	GainScheduledLQR scheduled_lqr;
+	bool use_gain_table = (strlen(gain_table) > 0);
+	if (use_gain_table && !scheduled_lqr.load(gain_table)) {
+		perror("Could not load gain table");
+		die(1);
+	}
+	StatePredictor state_predictor(PARAM_m, PARAM_M, PARAM_I, PARAM_l, angle_only ? K_angle : K,
+				       PARAM_PREDICTOR_MAX_DELAY);
+	const KalmanSettings kalman_settings = {PARAM_KALMAN_TS, PARAM_KALMAN_Q, PARAM_KALMAN_R_X,
+						PARAM_KALMAN_R_PHI};
+	const KalmanFilter kalman_initial(PARAM_m, PARAM_M, PARAM_I, PARAM_l, kalman_settings, kalman_extended);
+	if (use_kalman && !kalman_initial.valid()) {
+		fprintf(stderr, "Kalman filter has no steady-state gain.\n");
+		die(1);
+	}
+	// One filter per plant (peer address of the transport), such that the
+	// measurements of one plant never reach the estimate of another one.
+	std::unordered_map<std::string, KalmanFilter> kalman_filters;
 
-	while (true) {
+	while (!stop_requested) {
 		uint8_t data[MAX_PKT_SIZE];
-		struct sockaddr_storage plant_addr;
-		socklen_t plant_addr_len = sizeof(plant_addr);
-		ssize_t data_len = recvfrom(sock, data, MAX_PKT_SIZE, 0,
-					    (sockaddr *) &plant_addr, &plant_addr_len);
+		ssize_t data_len = transport->recv(data, MAX_PKT_SIZE);
 		if (data_len == -1) {
-			perror("Could not receive message");
+			if (errno != EINTR)
+				perror("Could not receive message");
+			continue;
 		}
+		if (udp != NULL)
+			record_wakeup_latency(udp);
+		n_msgs++;
 
 		double angle;
 		double omega;
@@ -113,20 +412,72 @@ int main(int argc, char *argv[])
 		}
 		//printf("State received: time = %" PRIu64 " us  angle = %f degree\n", t_usec, angle);
 		pendulum_state_t state = {x, v, angle, omega};
-		
-		double u = lqr.control(state);
 
-		data_len = marshaling_update(data, MAX_PKT_SIZE, t_usec, u);
+		// Only position and angle are measured; states sampled before
+		// the newest one (reordered packets) update the estimate in
+		// timestamp order.
+		KalmanFilter *kalman = NULL;
+		if (use_kalman) {
+			struct sockaddr_storage peer;
+			socklen_t peer_len = transport->peer_address(peer);
+			std::string key((const char *)&peer, peer_len);
+			kalman = &kalman_filters.try_emplace(key, kalman_initial).first->second;
+			state = kalman->update(0.000001*t_usec, x, angle);
+		}
+
+		// Predict the state at the time the update arrives at the plant.
+		if (delay_compensation) {
+			uint64_t rtt_usec;
+			if (!demarshaling_state_rtt(data, data_len, rtt_usec))
+				rtt_usec = expected_rtt_usec;
+			state = state_predictor.predict(state, 0.000001*rtt_usec);
+		}
+		
+		if (horizon_len > 0) {
+			double u[HORIZON_MAX_LEN];
+			predictor.predict(state, u, horizon_len);
+			if (kalman != NULL)
+				kalman->input(u[0]);
+			data_len = marshaling_horizon(data, MAX_PKT_SIZE, t_usec, horizon_step_usec, u, horizon_len);
+		} else {
+			double u;
+			if (use_mpc)
+				u = mpc.control(state);
+			else if (use_gain_table)
+				u = scheduled_lqr.control(state);
+			else
+				u = lqr.control(state);
+			if (kalman != NULL)
+				kalman->input(u);
+			data_len = marshaling_update(data, MAX_PKT_SIZE, t_usec, u);
+		}
 		if (data_len == -1) {
 			fprintf(stderr, "Could not marshal update.\n");
 			continue;
 		}
 
-		ssize_t n_sent = sendto(sock, data, data_len, 0, (sockaddr *) &plant_addr, plant_addr_len);
+		ssize_t n_sent = transport->send(data, data_len);
 		if (n_sent != data_len) {
 			perror("Could not send update");
 		}
 	}
-  
+
+	print_stats(ts_start, n_msgs, udp);
+	if (delay_compensation)
+		printf("predictions:     %" PRIu64 " linear, %" PRIu64 " nonlinear\n",
+		       state_predictor.linear_predictions(), state_predictor.nonlinear_predictions());
+	if (use_kalman) {
+		uint64_t n_reordered = 0;
+		uint64_t n_dropped = 0;
+		for (const auto &f : kalman_filters) {
+			n_reordered += f.second.reordered();
+			n_dropped += f.second.dropped();
+		}
+		printf("estimator:       %zu plants, %" PRIu64 " out-of-sequence, %" PRIu64 " dropped\n",
+		       kalman_filters.size(), n_reordered, n_dropped);
+	}
+
+	delete transport;
+
 	return 0;
 }
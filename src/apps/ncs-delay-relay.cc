@@ -0,0 +1,530 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * UDP relay emulating network delay between ncs-plant and ncs-controller.
+ *
+ * The plant sends its datagrams to the relay instead of the controller. The
+ * relay holds every datagram for a delay drawn from a packet trace (same CSV
+ * format as used by simulate-event_queue) or from a log-normal distribution
+ * fitted to the trace, and then forwards it. The loop delay of a trace entry
+ * (rcvdTime - sendTime) is split between uplink (plant to controller) and
+ * downlink (controller to plant).
+ *
+ * Datagrams are released by a timer wheel with a resolution of 1 us. The
+ * relay sleeps until shortly before the next release and busy-waits for the
+ * rest to achieve us-accurate release times.
+ *
+ * Every plant (source address) gets its own upstream socket, so several
+ * plants (e.g., ncs-loadgen) can share one relay.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <inttypes.h>
+#include <map>
+#include <random>
+#include <signal.h>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../events/timer_wheel.h"
+#include "../netutils/socket_utils.h"
+
+#define MAX_STR_LEN 1024
+
+// Maximum size of a relayed datagram [bytes]
+#define MAX_DGRAM_SIZE 2048
+
+// Maximum number of datagrams held by the relay at the same time.
+#define MAX_PENDING 8192
+
+// Number of slots of the timer wheel (1 us per slot).
+#define TIMER_WHEEL_SLOTS (1 << 18)
+
+// Maximum number of socket events handled per call of epoll_wait().
+#define MAX_EPOLL_EVENTS 64
+
+// Wake up this long before the next release and busy-wait for the rest [us].
+#define SPIN_USEC 100
+
+// Resolution of the release error histogram is 1 us up to this error [us].
+#define RELEASE_HIST_MAX_USEC 10000
+
+enum class Direction {
+        UPLINK,
+        DOWNLINK
+};
+
+struct PendingDatagram {
+        uint8_t data[MAX_DGRAM_SIZE];
+        size_t len;
+        Direction dir;
+        // Index of the plant session.
+        uint32_t session;
+};
+
+struct Session {
+        struct sockaddr_storage plant_addr;
+        socklen_t plant_addr_len;
+        // Socket "connected" to the controller.
+        int upstream_sock;
+        uint64_t n_uplink;
+        uint64_t n_downlink;
+};
+
+// Global configuration parameters.
+char listen_service[MAX_STR_LEN];
+char ctrl_host[MAX_STR_LEN];
+char ctrl_service[MAX_STR_LEN];
+char trace_path[MAX_STR_LEN];
+bool fit_distribution = false;
+double uplink_share = 0.5;
+unsigned long seed = 1;
+
+volatile sig_atomic_t stop_requested = 0;
+
+/**
+ * Exit application with given exit status.
+ * Clean up before exiting.
+ *
+ * @param exit_status exit status
+ */
+void die(int exit_status)
+{
+        exit(exit_status);
+}
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s \n"
+                "-l PORT : service name or port number to receive datagrams from plants \n"
+                "-d HOST : controller host (name or IP address) \n"
+                "-p PORT : controller service (service name or port number) \n"
+                "-t FILENAME : packet trace (CSV: pctNumber,rcvdTime,sendTime) \n"
+                "-D : draw delays from a log-normal distribution fitted to the trace instead of replaying it \n"
+                "-u SHARE : share of the loop delay applied to the uplink (0.0 to 1.0, default: 0.5) \n"
+                "-r SEED : seed of the random number generator (default: 1) \n"
+                "\n",
+                prog);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+        memset(listen_service, 0, MAX_STR_LEN);
+        memset(ctrl_host, 0, MAX_STR_LEN);
+        memset(ctrl_service, 0, MAX_STR_LEN);
+        memset(trace_path, 0, MAX_STR_LEN);
+
+        while ((opt = getopt(argc, argv, "l:d:p:t:Du:r:")) != -1) {
+                switch (opt) {
+                case 'l':
+                        strncpy(listen_service, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'd':
+                        strncpy(ctrl_host, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'p':
+                        strncpy(ctrl_service, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 't':
+                        strncpy(trace_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'D':
+                        fit_distribution = true;
+                        break;
+                case 'u':
+                        uplink_share = atof(optarg);
+                        break;
+                case 'r':
+                        seed = strtoul(optarg, NULL, 10);
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (strlen(listen_service) == 0 || strlen(ctrl_host) == 0 || strlen(ctrl_service) == 0 ||
+            strlen(trace_path) == 0)
+                return -1;
+
+        if (uplink_share < 0.0 || uplink_share > 1.0)
+                return -1;
+
+        return 0;
+}
+
+void handle_signal(int /* sig */)
+{
+        stop_requested = 1;
+}
+
+/**
+ * Read the loop delays (rcvdTime - sendTime) of all packets of a packet trace.
+ *
+ * @param path path of the trace file
+ * @param delays receives delays in the order of the trace [us]
+ * @return true on success; false on error.
+ */
+bool read_trace_delays(const char *path, std::vector<uint64_t> &delays)
+{
+        std::ifstream csvFile(path);
+        if (!csvFile.is_open()) {
+                perror("Could not open .csv file");
+                return false;
+        }
+
+        std::string line;
+        std::getline(csvFile, line); // skip header
+        auto nextToken = [](std::stringstream &ss) -> std::string {
+                std::string token;
+                std::getline(ss, token, ',');
+                return token;
+        };
+        while (std::getline(csvFile, line)) {
+                std::stringstream ss(line);
+
+                std::string pktStr = nextToken(ss);
+                std::string recvStr = nextToken(ss);
+                std::string sendStr = nextToken(ss);
+
+                if (sendStr.empty() || pktStr.empty() || recvStr.empty())
+                        continue;
+                double d = std::stod(recvStr) - std::stod(sendStr);
+                if (d < 0.0)
+                        continue;
+                delays.push_back((uint64_t)std::llround(d * 1000000.0));
+        }
+
+        return !delays.empty();
+}
+
+/**
+ * Source of packet delays, either replaying a trace or drawing from a
+ * log-normal distribution fitted to the trace.
+ */
+class DelaySource
+{
+      public:
+        DelaySource(const std::vector<uint64_t> &delays, bool fit, unsigned long seed)
+                : delays(delays), fit(fit), next_uplink(0), next_downlink(0), rng(seed)
+        {
+                if (fit) {
+                        // Maximum likelihood estimate of log-normal parameters.
+                        // Zero delays are clamped to 1 us.
+                        double sum = 0.0;
+                        double sum2 = 0.0;
+                        for (uint64_t d : delays) {
+                                double ld = std::log(d > 0 ? (double)d : 1.0);
+                                sum += ld;
+                                sum2 += ld * ld;
+                        }
+                        double n = delays.size();
+                        double mu = sum / n;
+                        double sigma = std::sqrt(std::max(0.0, sum2 / n - mu * mu));
+                        lognormal = std::lognormal_distribution<double>(mu, sigma);
+                        fprintf(stderr, "Fitted log-normal distribution: mu = %f, sigma = %f (delays in us)\n", mu,
+                                sigma);
+                }
+        }
+
+        /**
+         * Next loop delay for the given direction [us].
+         */
+        uint64_t next(Direction dir)
+        {
+                if (fit)
+                        return (uint64_t)std::llround(lognormal(rng));
+
+                size_t &idx = (dir == Direction::UPLINK) ? next_uplink : next_downlink;
+                uint64_t d = delays[idx];
+                idx = (idx + 1) % delays.size();
+                return d;
+        }
+
+      private:
+        const std::vector<uint64_t> &delays;
+        const bool fit;
+        size_t next_uplink;
+        size_t next_downlink;
+        std::mt19937_64 rng;
+        std::lognormal_distribution<double> lognormal;
+};
+
+/**
+ * Monotonic time [us].
+ */
+uint64_t now_usec()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool make_nonblocking(int sock)
+{
+        int flags = fcntl(sock, F_GETFL);
+        return (flags != -1 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) != -1);
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                die(1);
+        }
+
+        std::vector<uint64_t> delays;
+        if (!read_trace_delays(trace_path, delays)) {
+                fprintf(stderr, "Could not read delays from packet trace.\n");
+                die(1);
+        }
+        DelaySource delay_source(delays, fit_distribution, seed);
+
+        signal(SIGINT, handle_signal);
+        signal(SIGTERM, handle_signal);
+
+        // Default timer slack of 50 us would spoil the release times.
+        prctl(PR_SET_TIMERSLACK, 1);
+
+        int listen_sock;
+        if (datagram_server_sockets(NULL, listen_service, AF_UNSPEC, 0, &listen_sock, 1) != 1) {
+                perror("Could not create socket");
+                die(1);
+        }
+        if (!make_nonblocking(listen_sock)) {
+                perror("Could not make socket non-blocking");
+                die(1);
+        }
+
+        int epfd = epoll_create1(0);
+        if (epfd == -1) {
+                perror("Could not create epoll instance");
+                die(1);
+        }
+        // Socket events carry the session index + 1; 0 is the listen socket.
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = 0;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, listen_sock, &ev) == -1) {
+                perror("Could not add socket to epoll instance");
+                die(1);
+        }
+
+        std::vector<Session> sessions;
+        std::map<std::string, uint32_t> session_index;
+
+        // Pool of datagrams waiting for release.
+        std::vector<PendingDatagram> pool(MAX_PENDING);
+        std::vector<uint32_t> free_slots;
+        for (uint32_t i = 0; i < MAX_PENDING; i++)
+                free_slots.push_back(MAX_PENDING - 1 - i);
+
+        TimerWheel wheel(TIMER_WHEEL_SLOTS, MAX_PENDING, now_usec());
+
+        uint64_t n_dropped = 0;
+        uint64_t n_oversized = 0;
+        uint64_t n_send_errors = 0;
+        uint64_t n_released = 0;
+        std::vector<uint64_t> release_error_hist(RELEASE_HIST_MAX_USEC + 1, 0);
+        uint64_t release_error_max = 0;
+        double release_error_sum = 0.0;
+
+        // Hold a datagram for the next delay of its direction.
+        auto enqueue = [&](uint32_t slot, uint64_t t_arrival) {
+                PendingDatagram &pd = pool[slot];
+                uint64_t d = delay_source.next(pd.dir);
+                double share = (pd.dir == Direction::UPLINK) ? uplink_share : 1.0 - uplink_share;
+                uint64_t t_release = t_arrival + (uint64_t)std::llround(share * d);
+                wheel.schedule(t_release, slot);
+        };
+
+        // Forward a datagram whose delay has expired.
+        auto release = [&](uint32_t slot, uint64_t t_due) {
+                PendingDatagram &pd = pool[slot];
+                Session &s = sessions[pd.session];
+                ssize_t n;
+                if (pd.dir == Direction::UPLINK)
+                        n = send(s.upstream_sock, pd.data, pd.len, 0);
+                else
+                        n = sendto(listen_sock, pd.data, pd.len, 0, (struct sockaddr *)&s.plant_addr,
+                                   s.plant_addr_len);
+                uint64_t t_sent = now_usec();
+                if (n != (ssize_t)pd.len)
+                        n_send_errors++;
+
+                uint64_t err = (t_sent > t_due) ? t_sent - t_due : 0;
+                release_error_hist[err < RELEASE_HIST_MAX_USEC ? err : RELEASE_HIST_MAX_USEC]++;
+                release_error_sum += err;
+                if (err > release_error_max)
+                        release_error_max = err;
+                n_released++;
+
+                free_slots.push_back(slot);
+        };
+
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+
+        while (!stop_requested) {
+                // Sleep until shortly before the next release, or until a
+                // datagram arrives.
+                int timeout_ms = -1;
+                uint64_t t_next;
+                uint64_t t_now = now_usec();
+                if (wheel.next_expiry(t_next)) {
+                        if (t_next <= t_now + SPIN_USEC)
+                                timeout_ms = 0;
+                        else
+                                timeout_ms = (t_next - t_now - SPIN_USEC) / 1000;
+                }
+
+                int n_events = epoll_wait(epfd, events, MAX_EPOLL_EVENTS, timeout_ms);
+                if (n_events == -1 && errno != EINTR) {
+                        perror("epoll_wait failed");
+                        die(1);
+                }
+
+                for (int i = 0; i < n_events; i++) {
+                        uint32_t src = events[i].data.u32;
+                        while (true) {
+                                if (free_slots.empty()) {
+                                        // Pool exhausted: drop datagram.
+                                        uint8_t discard[MAX_DGRAM_SIZE];
+                                        int sock = (src == 0) ? listen_sock : sessions[src - 1].upstream_sock;
+                                        if (recv(sock, discard, MAX_DGRAM_SIZE, 0) < 0)
+                                                break;
+                                        n_dropped++;
+                                        continue;
+                                }
+
+                                uint32_t slot = free_slots.back();
+                                PendingDatagram &pd = pool[slot];
+                                ssize_t n;
+                                if (src == 0) {
+                                        struct sockaddr_storage addr;
+                                        socklen_t addr_len = sizeof(addr);
+                                        // MSG_TRUNC: n is the length of the datagram, also if
+                                        // it does not fit.
+                                        n = recvfrom(listen_sock, pd.data, MAX_DGRAM_SIZE, MSG_TRUNC,
+                                                     (struct sockaddr *)&addr, &addr_len);
+                                        if (n < 0)
+                                                break;
+                                        if (n > MAX_DGRAM_SIZE) {
+                                                n_oversized++;
+                                                continue;
+                                        }
+
+                                        // Look up session of plant or create a new one.
+                                        std::string key((const char *)&addr, addr_len);
+                                        auto it = session_index.find(key);
+                                        if (it == session_index.end()) {
+                                                Session s;
+                                                memcpy(&s.plant_addr, &addr, addr_len);
+                                                s.plant_addr_len = addr_len;
+                                                s.upstream_sock = datagram_client_socket(ctrl_host, ctrl_service);
+                                                s.n_uplink = 0;
+                                                s.n_downlink = 0;
+                                                if (s.upstream_sock == -1 || !make_nonblocking(s.upstream_sock)) {
+                                                        perror("Could not create upstream socket");
+                                                        die(1);
+                                                }
+                                                ev.events = EPOLLIN;
+                                                ev.data.u32 = sessions.size() + 1;
+                                                if (epoll_ctl(epfd, EPOLL_CTL_ADD, s.upstream_sock, &ev) == -1) {
+                                                        perror("Could not add socket to epoll instance");
+                                                        die(1);
+                                                }
+                                                sessions.push_back(s);
+                                                it = session_index.insert({key, sessions.size() - 1}).first;
+                                        }
+                                        pd.dir = Direction::UPLINK;
+                                        pd.session = it->second;
+                                        sessions[it->second].n_uplink++;
+                                } else {
+                                        n = recv(sessions[src - 1].upstream_sock, pd.data, MAX_DGRAM_SIZE,
+                                                 MSG_TRUNC);
+                                        if (n < 0)
+                                                break;
+                                        if (n > MAX_DGRAM_SIZE) {
+                                                n_oversized++;
+                                                continue;
+                                        }
+                                        pd.dir = Direction::DOWNLINK;
+                                        pd.session = src - 1;
+                                        sessions[src - 1].n_downlink++;
+                                }
+                                pd.len = n;
+                                free_slots.pop_back();
+                                enqueue(slot, now_usec());
+                        }
+                }
+
+                // Busy-wait for the remaining time until the next release.
+                if (wheel.next_expiry(t_next)) {
+                        while ((t_now = now_usec()) < t_next && t_next <= t_now + SPIN_USEC)
+                                ;
+                }
+                wheel.advance(now_usec(), release);
+        }
+
+        uint64_t n_uplink = 0;
+        uint64_t n_downlink = 0;
+        for (const Session &s : sessions) {
+                n_uplink += s.n_uplink;
+                n_downlink += s.n_downlink;
+                close(s.upstream_sock);
+        }
+        close(listen_sock);
+        close(epfd);
+
+        fprintf(stderr, "plants:              %zu\n", sessions.size());
+        fprintf(stderr, "uplink datagrams:    %" PRIu64 "\n", n_uplink);
+        fprintf(stderr, "downlink datagrams:  %" PRIu64 "\n", n_downlink);
+        fprintf(stderr, "released:            %" PRIu64 "\n", n_released);
+        fprintf(stderr, "dropped:             %" PRIu64 "\n", n_dropped);
+        fprintf(stderr, "oversized:           %" PRIu64 "\n", n_oversized);
+        fprintf(stderr, "send errors:         %" PRIu64 "\n", n_send_errors);
+        if (n_released > 0) {
+                uint64_t cnt = 0;
+                uint64_t p99 = RELEASE_HIST_MAX_USEC;
+                for (uint64_t i = 0; i <= RELEASE_HIST_MAX_USEC; i++) {
+                        cnt += release_error_hist[i];
+                        if (cnt >= (uint64_t)std::ceil(0.99 * n_released)) {
+                                p99 = i;
+                                break;
+                        }
+                }
+                fprintf(stderr, "release error mean:  %.2f us\n", release_error_sum / n_released);
+                fprintf(stderr, "release error p99:   %" PRIu64 " us\n", p99);
+                fprintf(stderr, "release error max:   %" PRIu64 " us\n", release_error_max);
+        }
+
+        return 0;
+}
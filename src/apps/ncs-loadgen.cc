@@ -0,0 +1,436 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * Load generator for ncs-controller.
+ *
+ * Simulates many virtual plants within one process. Every plant runs its own
+ * pendulum simulation, samples its state once per cycle, sends the state to
+ * the controller, and applies the updates received from the controller, just
+ * like ncs-plant does (without visualization). Every plant uses its own UDP
+ * socket, so the controller sees every plant as a separate peer.
+ *
+ * At the end, the achieved packet rates, deadline misses, response latency
+ * percentiles, and the fraction of plants that stayed stable are reported.
+ */
+
+#include <cmath>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "../netutils/socket_utils.h"
+#include "marshaling.h"
+
+#define MAX_STR_LEN 1024
+#define MAX_PKT_SIZE 65535
+
+#define MAX_PLANTS 100000
+
+// Maximum number of socket events handled per call of epoll_wait().
+#define MAX_EPOLL_EVENTS 1024
+
+// Resolution of the latency histogram is 1 us up to this latency [us].
+#define LATENCY_HIST_MAX_USEC 1000000
+
+// Mass of pendulum [kg]
+#define PARAM_m 0.2
+// Mass of cart [kg]
+#define PARAM_M 0.5
+// Moment of Inertia [kg*m^2]
+#define PARAM_I 0.006
+// Length of pendulum to center of mass [m]
+#define PARAM_l 0.3
+// Initial speed of cart [m/s]
+#define PARAM_v 0.0
+// Initial position cart [m]
+#define PARAM_x 5.0
+
+// Duration of a simulation step [s]
+#define PARAM_DT 0.001
+
+// A plant is considered unstable once its angle exceeded this value [rad].
+#define PARAM_STABLE_ANGLE (M_PI / 4.0)
+
+// Global configuration parameters.
+char ctrl_host[MAX_STR_LEN];
+char ctrl_service[MAX_STR_LEN];
+char stats_file_path[MAX_STR_LEN];
+uint64_t cycletime_usec = 0;
+unsigned int n_plants = 1;
+double runtime = 20.0;
+double initial_angle = 0.0;
+
+struct VirtualPlant {
+        VirtualPlant(const InvertedPendulum &pendulum) : pendulum(pendulum)
+        {
+        }
+
+        InvertedPendulum pendulum;
+        int sock = -1;
+        // Start of the next cycle [us]
+        uint64_t t_next_cycle_usec = 0;
+        // Sampling time of the last state sent [us]
+        uint64_t t_last_sent_usec = 0;
+        // True while the response to the last state sent is outstanding.
+        bool response_pending = false;
+        bool stable = true;
+        uint64_t n_sent = 0;
+        uint64_t n_received = 0;
+        uint64_t n_deadline_misses = 0;
+};
+
+/**
+ * Exit application with given exit status.
+ * Clean up before exiting.
+ *
+ * @param exit_status exit status
+ */
+void die(int exit_status)
+{
+        exit(exit_status);
+}
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s \n"
+                "-d HOST : destination host (name or IP address) \n"
+                "-p PORT : destination service (service name or port number) \n"
+                "-c CYCLETIME : cycle time in micro-seconds of every plant \n"
+                "-n PLANTS : number of virtual plants (1 to %d, default: 1) \n"
+                "-t RUNTIME : duration of the load test in seconds (default: 20) \n"
+                "-a ANGLE : initial angle of the pendulums in rad (default: 0.0) \n"
+                "-o FILENAME : write per-plant statistics to this CSV file \n"
+                "\n",
+                prog, MAX_PLANTS);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+        memset(ctrl_host, 0, MAX_STR_LEN);
+        memset(ctrl_service, 0, MAX_STR_LEN);
+        memset(stats_file_path, 0, MAX_STR_LEN);
+        bool isdef_cycletime = false;
+
+        while ((opt = getopt(argc, argv, "d:p:c:n:t:a:o:")) != -1) {
+                switch (opt) {
+                case 'd':
+                        strncpy(ctrl_host, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'p':
+                        strncpy(ctrl_service, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'c':
+                        cycletime_usec = strtoull(optarg, NULL, 10);
+                        isdef_cycletime = true;
+                        break;
+                case 'n':
+                        n_plants = strtoul(optarg, NULL, 10);
+                        break;
+                case 't':
+                        runtime = atof(optarg);
+                        break;
+                case 'a':
+                        initial_angle = atof(optarg);
+                        break;
+                case 'o':
+                        strncpy(stats_file_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (strlen(ctrl_host) == 0 || strlen(ctrl_service) == 0 || !isdef_cycletime || cycletime_usec == 0)
+                return -1;
+
+        if (n_plants < 1 || n_plants > MAX_PLANTS)
+                return -1;
+
+        return 0;
+}
+
+/**
+ * Monotonic time since the given start time [us].
+ */
+uint64_t now_usec(const struct timespec &start)
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)(ts.tv_sec - start.tv_sec) * 1000000 + (ts.tv_nsec - start.tv_nsec) / 1000;
+}
+
+/**
+ * Raise the limit of open file descriptors such that every plant can have
+ * its own socket.
+ */
+bool raise_fd_limit(rlim_t n)
+{
+        struct rlimit lim;
+        if (getrlimit(RLIMIT_NOFILE, &lim))
+                return false;
+        if (lim.rlim_cur >= n)
+                return true;
+        if (lim.rlim_max != RLIM_INFINITY && lim.rlim_max < n)
+                return false;
+        lim.rlim_cur = n;
+        return (setrlimit(RLIMIT_NOFILE, &lim) == 0);
+}
+
+/**
+ * Advance the simulation of a plant to the given time.
+ */
+void advance_plant(VirtualPlant &plant, uint64_t t_usec, state_sequence_t &states)
+{
+        double d = 0.000001 * t_usec - plant.pendulum.get_time();
+        if (d >= PARAM_DT) {
+                plant.pendulum.simulate(d, PARAM_DT, states);
+                states.clear(); // don't need intermediate states
+        }
+}
+
+/**
+ * Get latency percentile from histogram.
+ *
+ * @param hist latency histogram with 1 us bins
+ * @param n total number of samples including overflows
+ * @param p percentile in [0, 1]
+ * @return latency [us]; LATENCY_HIST_MAX_USEC if the percentile is in the overflow bin.
+ */
+uint64_t percentile(const std::vector<uint64_t> &hist, uint64_t n, double p)
+{
+        uint64_t rank = (uint64_t)std::ceil(p * n);
+        uint64_t cnt = 0;
+        for (size_t i = 0; i < hist.size(); i++) {
+                cnt += hist[i];
+                if (cnt >= rank)
+                        return i;
+        }
+        return LATENCY_HIST_MAX_USEC;
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                die(1);
+        }
+
+        if (!raise_fd_limit(n_plants + 64)) {
+                fprintf(stderr, "Could not raise limit of open files to %u (see ulimit -n).\n", n_plants + 64);
+                die(1);
+        }
+
+        int epfd = epoll_create1(0);
+        if (epfd == -1) {
+                perror("Could not create epoll instance");
+                die(1);
+        }
+
+        // Create plants. The cycles of the plants are evenly spread over one cycle time.
+        std::vector<VirtualPlant> plants;
+        plants.reserve(n_plants);
+        pendulum_state_t state_initial = {PARAM_x, PARAM_v, initial_angle, 0.0};
+        for (unsigned int i = 0; i < n_plants; i++) {
+                plants.emplace_back(InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial));
+                VirtualPlant &plant = plants.back();
+                plant.sock = datagram_client_socket(ctrl_host, ctrl_service);
+                if (plant.sock == -1) {
+                        perror("Could not create socket");
+                        die(1);
+                }
+                if (fcntl(plant.sock, F_SETFL, O_NONBLOCK) == -1) {
+                        perror("Could not make socket non-blocking");
+                        die(1);
+                }
+                struct epoll_event ev;
+                ev.events = EPOLLIN;
+                ev.data.u32 = i;
+                if (epoll_ctl(epfd, EPOLL_CTL_ADD, plant.sock, &ev) == -1) {
+                        perror("Could not add socket to epoll instance");
+                        die(1);
+                }
+                plant.t_next_cycle_usec = (cycletime_usec * i) / n_plants;
+        }
+
+        std::vector<uint64_t> latency_hist(LATENCY_HIST_MAX_USEC, 0);
+        uint64_t n_latency_samples = 0;
+        uint64_t latency_max_usec = 0;
+        uint64_t n_sent = 0;
+        uint64_t n_received = 0;
+        uint64_t n_send_errors = 0;
+        // Cycles started more than one cycle time late, i.e., the load
+        // generator itself could not keep up.
+        uint64_t n_late_cycles = 0;
+
+        state_sequence_t states;
+        struct epoll_event events[MAX_EPOLL_EVENTS];
+        uint8_t data[MAX_PKT_SIZE];
+
+        // All plants have the same cycle time, so the plants become due in
+        // round-robin order.
+        unsigned int next_plant = 0;
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        const uint64_t runtime_usec = (uint64_t)(runtime * 1000000.0);
+        uint64_t t_current_usec = 0;
+
+        while ((t_current_usec = now_usec(start)) < runtime_usec) {
+                // Sample and send the state of all plants whose next cycle has started.
+                unsigned int n_served = 0;
+                while (plants[next_plant].t_next_cycle_usec <= t_current_usec && n_served < n_plants) {
+                        VirtualPlant &plant = plants[next_plant];
+                        if (t_current_usec - plant.t_next_cycle_usec > cycletime_usec)
+                                n_late_cycles++;
+                        if (plant.response_pending)
+                                plant.n_deadline_misses++;
+
+                        advance_plant(plant, t_current_usec, states);
+                        const pendulum_state_t &state = plant.pendulum.get_state();
+                        if (std::fabs(state[2]) > PARAM_STABLE_ANGLE)
+                                plant.stable = false;
+
+                        ssize_t data_len = marshaling_state(data, MAX_PKT_SIZE, t_current_usec, state[2], state[3],
+                                                            state[0], state[1]);
+                        if (data_len == -1 || send(plant.sock, data, data_len, 0) == -1) {
+                                n_send_errors++;
+                        } else {
+                                plant.t_last_sent_usec = t_current_usec;
+                                plant.response_pending = true;
+                                plant.n_sent++;
+                                n_sent++;
+                        }
+
+                        plant.t_next_cycle_usec += cycletime_usec;
+                        next_plant = (next_plant + 1) % n_plants;
+                        n_served++;
+                }
+
+                // Wait for updates until the next plant becomes due. Short
+                // waits are busy-polled, since epoll only has millisecond
+                // resolution.
+                uint64_t t_next_usec = plants[next_plant].t_next_cycle_usec;
+                int timeout_ms = 0;
+                t_current_usec = now_usec(start);
+                if (t_next_usec > t_current_usec + 1000)
+                        timeout_ms = (t_next_usec - t_current_usec) / 1000;
+
+                int n_events = epoll_wait(epfd, events, MAX_EPOLL_EVENTS, timeout_ms);
+                if (n_events == -1) {
+                        if (errno == EINTR)
+                                continue;
+                        perror("epoll_wait failed");
+                        die(1);
+                }
+
+                t_current_usec = now_usec(start);
+                for (int i = 0; i < n_events; i++) {
+                        VirtualPlant &plant = plants[events[i].data.u32];
+                        ssize_t data_len;
+                        while ((data_len = recv(plant.sock, data, MAX_PKT_SIZE, 0)) > 0) {
+                                uint64_t t_sent_usec;
+                                double u;
+                                if (!demarshaling_update(data, data_len, t_sent_usec, u))
+                                        continue;
+
+                                // Apply the update at its arrival time.
+                                advance_plant(plant, t_current_usec, states);
+                                plant.pendulum.set_force(u);
+
+                                plant.n_received++;
+                                n_received++;
+                                if (t_sent_usec == plant.t_last_sent_usec)
+                                        plant.response_pending = false;
+
+                                uint64_t latency_usec = t_current_usec - t_sent_usec;
+                                if (latency_usec < LATENCY_HIST_MAX_USEC)
+                                        latency_hist[latency_usec]++;
+                                if (latency_usec > latency_max_usec)
+                                        latency_max_usec = latency_usec;
+                                n_latency_samples++;
+                        }
+                }
+        }
+
+        double t_wall = 0.000001 * now_usec(start);
+
+        // Per-plant statistics.
+        unsigned int n_stable = 0;
+        unsigned int n_plants_missed = 0;
+        uint64_t n_deadline_misses = 0;
+        uint64_t max_deadline_misses = 0;
+        for (const VirtualPlant &plant : plants) {
+                if (plant.stable)
+                        n_stable++;
+                if (plant.n_deadline_misses > 0)
+                        n_plants_missed++;
+                n_deadline_misses += plant.n_deadline_misses;
+                if (plant.n_deadline_misses > max_deadline_misses)
+                        max_deadline_misses = plant.n_deadline_misses;
+        }
+
+        printf("plants:              %u\n", n_plants);
+        printf("cycle time:          %" PRIu64 " us\n", cycletime_usec);
+        printf("runtime:             %f s\n", t_wall);
+        printf("sent:                %" PRIu64 " (%.1f pkt/s)\n", n_sent, n_sent / t_wall);
+        printf("received:            %" PRIu64 " (%.1f pkt/s)\n", n_received, n_received / t_wall);
+        printf("send errors:         %" PRIu64 "\n", n_send_errors);
+        printf("late cycles:         %" PRIu64 "\n", n_late_cycles);
+        printf("deadline misses:     %" PRIu64 " (plants affected: %u, max per plant: %" PRIu64 ")\n",
+               n_deadline_misses, n_plants_missed, max_deadline_misses);
+        if (n_latency_samples > 0) {
+                printf("latency p50:         %" PRIu64 " us\n", percentile(latency_hist, n_latency_samples, 0.5));
+                printf("latency p90:         %" PRIu64 " us\n", percentile(latency_hist, n_latency_samples, 0.9));
+                printf("latency p99:         %" PRIu64 " us\n", percentile(latency_hist, n_latency_samples, 0.99));
+                printf("latency p99.9:       %" PRIu64 " us\n", percentile(latency_hist, n_latency_samples, 0.999));
+                printf("latency max:         %" PRIu64 " us\n", latency_max_usec);
+        }
+        printf("stable plants:       %u (%.2f %%)\n", n_stable, (100.0 * n_stable) / n_plants);
+
+        if (strlen(stats_file_path) > 0) {
+                FILE *stats_file = fopen(stats_file_path, "w");
+                if (stats_file == NULL) {
+                        perror("Could not open statistics file");
+                        die(1);
+                }
+                fprintf(stats_file, "# plant,sent,received,deadline_misses,stable\n");
+                for (unsigned int i = 0; i < n_plants; i++) {
+                        const VirtualPlant &plant = plants[i];
+                        fprintf(stats_file, "%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%d\n", i, plant.n_sent,
+                                plant.n_received, plant.n_deadline_misses, plant.stable ? 1 : 0);
+                }
+                fclose(stats_file);
+        }
+
+        for (VirtualPlant &plant : plants)
+                close(plant.sock);
+        close(epfd);
+
+        return 0;
+}
@@ -36,20 +36,36 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <atomic>
-#include <mutex>
+#include <errno.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <cmath>
+#include <fstream>
 #include <sys/socket.h>
+#include <time.h>
 
+#include "../controller/fallback_controller.h"
+#include "../controller/packet_control.h"
+#include "../controller/trigger.h"
+#include "../events/event.h"
+#include "../events/event_queue.h"
 #include "../inverted_pendulum/inverted_pendulum.h"
-#include "../netutils/socket_utils.h"
+#include "../netutils/shm_transport.h"
+#include "../netutils/state_feed.h"
+#include "../netutils/transport.h"
+#include "../netutils/uring_transport.h"
+#include "../utils/async_logger.h"
+#include "../utils/seqlock.h"
+#include "../utils/spsc_ring.h"
 #include "marshaling.h"
 
 #define MAX_STR_LEN 1024
 #define MAX_PKT_SIZE 65535
 
+// Length of an update message with a single control value [bytes]
+#define UPDATE_MSG_LEN 16
+
 #define LOG_INTERVAL_USEC 10000
 
 // Mass of pendulum [kg]
@@ -73,21 +89,134 @@
 // Duration of a simulation step [s]
 #define PARAM_DT 0.001
 
+// Duration of a simulation step in virtual-time mode [s]
+// (same as simulate-event_queue)
+#define PARAM_VIRTUAL_DT 0.0001
+
+// In virtual-time mode, the state is sent again if the update does not
+// arrive within this time (lost datagram) [us] ...
+#define PARAM_VIRTUAL_RECV_TIMEOUT_USEC 200000
+// ... up to this many times before the run fails.
+#define PARAM_VIRTUAL_MAX_RETRIES 10
+
+// Maximum number of simulation steps executed at once to catch up with
+// wall time. If the physics thread falls further behind, the remaining lag
+// is skipped (overrun).
+#define PHYSICS_MAX_CATCHUP_STEPS 20
+
+// LQR gain matrix of the local fallback controller (same as ncs-controller)
+#define LQR_K {-3.162277660168483, -6.105688949485788, 49.16351188321586, 7.204143097154165}
+
+// Maximum time to extrapolate remote updates [us]
+#define FALLBACK_MAX_EXTRAPOLATION_USEC 50000
+
+// Capacity of the queue of switch events between remote and local control
+// (must be a power of 2).
+#define SWITCH_EVENT_QUEUE_CAPACITY 1024
+
+// Default parameters of event-triggered transmission
+#define PARAM_TRIGGER_THRESHOLD 0.01
+#define PARAM_TRIGGER_MAX_SILENCE 0.1
+
+// Capacity of the queue of control updates from the receiver thread to the
+// physics thread (must be a power of 2).
+#define UPDATE_QUEUE_CAPACITY 256
+
+// Gain of the moving average of the round-trip time (1/2^RTT_EWMA_SHIFT)
+#define RTT_EWMA_SHIFT 3
+
 // Global configuration parameters.
 char ctrl_host[MAX_STR_LEN];
 char ctrl_service[MAX_STR_LEN];
 uint64_t cycletime_usec = 0;
-
-int sock = -1;
+char shm_name[MAX_STR_LEN];
+bool shm_busy_poll = false;
+bool use_uring = false;
+char virtual_trace_path[MAX_STR_LEN];
+double initial_x = PARAM_x;
+double initial_angle = PARAM_angle;
+uint64_t staleness_deadline_usec = 0;
+FallbackController::Mode fallback_mode = FallbackController::Mode::LQR;
+char switch_log_path[MAX_STR_LEN];
+char live_feed_name[MAX_STR_LEN];
+TransmissionTrigger::Policy trigger_policy = TransmissionTrigger::Policy::PERIODIC;
+double trigger_threshold = PARAM_TRIGGER_THRESHOLD;
+double trigger_max_silence = PARAM_TRIGGER_MAX_SILENCE;
+
+Transport *transport = NULL;
+
+// Start of the plant clock (CLOCK_MONOTONIC). Timestamps sent to the
+// controller and simulation time are relative to this point in time.
+struct timespec ts_plant_start;
 
 char log_file_path[MAX_STR_LEN];
-
-pthread_t thread;
-std::atomic_int update_ready(0);
-std::mutex update_lock;
-struct {
+bool log_full_rate = false;
+AsyncLogger logger;
+bool logging = false;
+
+pthread_t receiver_thread;
+pthread_t physics_thread;
+pthread_t sampler_thread;
+std::atomic<bool> running(true);
+
+// Control update (single value or horizon) together with its arrival
+// time, passed from the receiver thread to the physics thread.
+struct update_t {
+	uint64_t t_arrival_usec;
+	uint64_t t_sample_usec;
 	double u;
-} update;
+	// Horizon of future control values (n = 0 for single value).
+	uint64_t step_usec;
+	size_t n;
+	double horizon[HORIZON_MAX_LEN];
+};
+SpscRing<update_t, UPDATE_QUEUE_CAPACITY> updates;
+std::atomic<uint64_t> updates_dropped(0);
+
+// State of the plant after the last simulation step, published by the
+// physics thread to the sampler and renderer.
+struct plant_snapshot_t {
+	uint64_t t_usec;
+	pendulum_state_t state;
+	double force;
+};
+Seqlock<plant_snapshot_t> snapshot;
+
+// Live feed of the state to viewers (physics thread or virtual-time loop
+// only).
+StateFeedPublisher live_feed;
+
+// Horizon of future control values received last (physics thread only).
+HorizonBuffer horizon;
+
+// Local fallback controller (NULL if no staleness deadline is configured).
+FallbackController *fallback = NULL;
+
+// Switches between remote and local control, passed from the physics
+// thread to the main thread for logging.
+struct switch_event_t {
+	uint64_t t_usec;
+	uint64_t age_usec;
+	bool to_local;
+};
+SpscRing<switch_event_t, SWITCH_EVENT_QUEUE_CAPACITY> switch_events;
+std::atomic<uint64_t> switches_to_local(0);
+std::atomic<uint64_t> local_steps(0);
+
+// Statistics of the physics thread.
+std::atomic<uint64_t> physics_steps(0);
+std::atomic<uint64_t> physics_overruns(0);
+std::atomic<uint64_t> physics_skipped_usec(0);
+
+// Round-trip time statistics (written by receiver thread only) [us].
+std::atomic<uint64_t> rtt_cnt(0);
+std::atomic<uint64_t> rtt_sum_usec(0);
+std::atomic<uint64_t> rtt_min_usec(UINT64_MAX);
+std::atomic<uint64_t> rtt_max_usec(0);
+
+// Smoothed round-trip time reported to the controller for delay
+// compensation (0: no sample yet) [us].
+std::atomic<uint64_t> rtt_smoothed_usec(0);
 
 /**
  * Exit application with given exit status.
@@ -110,6 +239,25 @@ void usage(const char *prog)
              "-p PORT : destination service (service name or port number) \n"
              "-c CYCLETIME : cycle time in micro-seconds for sending datagrams \n"
 	     "-f FILENAME : log file \n"
+	     "-F : log full state and force in every cycle (default: x and angle every 10 ms) \n"
+	     "-s NAME : use shared-memory segment NAME instead of UDP (controller on same host) \n"
+	     "-B : busy-poll for messages instead of sleeping (shared memory only) \n"
+	     "-u : use io_uring for UDP \n"
+	     "-x X : initial position of cart in m (default: 5.0) \n"
+	     "-a ANGLE : initial angle of pendulum in rad (default: 0.0) \n"
+	     "-S DEADLINE : staleness deadline in micro-seconds; switch to local fallback \n"
+	     "              controller if the last update is based on an older state \n"
+	     "              (not in virtual-time mode) \n"
+	     "-L MODE : local fallback: lqr (default) or extrapolate (last updates) \n"
+	     "-E FILENAME : log switches between remote and local control \n"
+	     "-T POLICY : transmission policy: periodic (default), delta, lyapunov, or self \n"
+	     "            (not in virtual-time mode) \n"
+	     "-e THRESHOLD : threshold of transmission policy (default: 0.01) \n"
+	     "-m MAX_SILENCE : maximum time between two transmissions in seconds (default: 0.1) \n"
+	     "-V FILENAME : virtual-time mode: run headless as fast as possible, sending states \n"
+	     "              and applying updates at the times of the given packet trace \n"
+	     "              (log file receives the state trace like simulate-event_queue) \n"
+	     "-W NAME : publish the state to the live feed NAME (see visualization -w) \n"
              "\n", prog);
 }
 
@@ -123,10 +271,14 @@ int parse_cmdline_args(int argc, char *argv[])
      memset(ctrl_host, 0, MAX_STR_LEN);
      memset(ctrl_service, 0, MAX_STR_LEN);
      memset(log_file_path, 0, MAX_STR_LEN);
+     memset(shm_name, 0, MAX_STR_LEN);
+     memset(virtual_trace_path, 0, MAX_STR_LEN);
+     memset(switch_log_path, 0, MAX_STR_LEN);
+     memset(live_feed_name, 0, MAX_STR_LEN);
      bool isdef_cycletime = false;
 
      
-     while ( (opt = getopt(argc, argv, "d:p:c:f:")) != -1 ) {
+     while ( (opt = getopt(argc, argv, "d:p:c:f:Fs:Bux:a:V:S:L:E:T:e:m:W:")) != -1 ) {
 	     switch(opt) {
 	     case 'd' :
 		     strncpy(ctrl_host, optarg, MAX_STR_LEN-1);
@@ -141,6 +293,54 @@ int parse_cmdline_args(int argc, char *argv[])
 	     case 'f' :
 		     strncpy(log_file_path, optarg, MAX_STR_LEN-1);
 		     break;
+	     case 'F' :
+		     log_full_rate = true;
+		     break;
+	     case 's' :
+		     strncpy(shm_name, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'B' :
+		     shm_busy_poll = true;
+		     break;
+	     case 'u' :
+		     use_uring = true;
+		     break;
+	     case 'x' :
+		     initial_x = atof(optarg);
+		     break;
+	     case 'a' :
+		     initial_angle = atof(optarg);
+		     break;
+	     case 'V' :
+		     strncpy(virtual_trace_path, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'S' :
+		     staleness_deadline_usec = strtoull(optarg, NULL, 10);
+		     break;
+	     case 'L' :
+		     if (strcmp(optarg, "lqr") == 0)
+			     fallback_mode = FallbackController::Mode::LQR;
+		     else if (strcmp(optarg, "extrapolate") == 0)
+			     fallback_mode = FallbackController::Mode::EXTRAPOLATE;
+		     else
+			     return -1;
+		     break;
+	     case 'E' :
+		     strncpy(switch_log_path, optarg, MAX_STR_LEN-1);
+		     break;
+	     case 'T' :
+		     if (!TransmissionTrigger::parse_policy(optarg, trigger_policy))
+			     return -1;
+		     break;
+	     case 'e' :
+		     trigger_threshold = atof(optarg);
+		     break;
+	     case 'm' :
+		     trigger_max_silence = atof(optarg);
+		     break;
+	     case 'W' :
+		     strncpy(live_feed_name, optarg, MAX_STR_LEN-1);
+		     break;
 	     case ':' :
 	     case '?' :
 	     default :
@@ -148,31 +348,97 @@ int parse_cmdline_args(int argc, char *argv[])
 	     }
      }
      
-     if (strlen(ctrl_host) == 0 || strlen(ctrl_service) == 0 || !isdef_cycletime)
+     if (!isdef_cycletime && strlen(virtual_trace_path) == 0)
+          return -1;
+
+     if (strlen(shm_name) == 0 && (strlen(ctrl_host) == 0 || strlen(ctrl_service) == 0))
+          return -1;
+
+     // Virtual-time mode always applies the update of the controller.
+     if (strlen(virtual_trace_path) > 0 && (staleness_deadline_usec > 0 || strlen(switch_log_path) > 0))
+          return -1;
+
+     // Virtual-time mode sends a state at every send time of the packet trace.
+     if (strlen(virtual_trace_path) > 0 && trigger_policy != TransmissionTrigger::Policy::PERIODIC)
           return -1;
 
      return 0;
 }
 
+/**
+ * Current time of the plant clock [us].
+ */
+uint64_t plant_time_usec()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) (ts.tv_sec - ts_plant_start.tv_sec)*1000000 +
+		(ts.tv_nsec - ts_plant_start.tv_nsec)/1000;
+}
+
+/**
+ * Sleep until the plant clock reaches the given time.
+ */
+void sleep_until_usec(uint64_t t_usec)
+{
+	struct timespec ts;
+	uint64_t nsec = ts_plant_start.tv_nsec + (t_usec%1000000)*1000;
+	ts.tv_sec = ts_plant_start.tv_sec + t_usec/1000000 + nsec/1000000000;
+	ts.tv_nsec = nsec%1000000000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
 void *receiver_thread_run(void *param)
 {
 	uint8_t data[MAX_PKT_SIZE];
 	ssize_t data_len;
 	
 	while (true) {
-		data_len = recv(sock, data, MAX_PKT_SIZE, 0);
+		data_len = transport->recv(data, MAX_PKT_SIZE);
 		if (data_len == -1) {
 			perror("Could not receive message");
 		} else {
 			uint64_t time;
 			double u;
-			if (!demarshaling_update(data, data_len, time, u)) {
+			update_t upd;
+			upd.n = 0;
+			bool ok;
+			// Horizon messages are longer than single updates.
+			if (data_len > UPDATE_MSG_LEN) {
+				ok = demarshaling_horizon(data, data_len, time, upd.step_usec, upd.horizon,
+							  HORIZON_MAX_LEN, upd.n);
+				u = upd.horizon[0];
+			} else {
+				ok = demarshaling_update(data, data_len, time, u);
+			}
+			if (!ok) {
 				fprintf(stderr, "Demarshaling failed\n");
 			} else {
-				update_lock.lock();
-				update.u = u;
-				update_lock.unlock();
-				update_ready.store(1);
+				// The physics thread applies the update at its
+				// arrival time.
+				uint64_t t_now_usec = plant_time_usec();
+				upd.t_arrival_usec = t_now_usec;
+				upd.t_sample_usec = time;
+				upd.u = u;
+				if (!updates.push(upd))
+					updates_dropped.fetch_add(1);
+
+				// The controller echoes the sampling time of the state.
+				if (t_now_usec >= time) {
+					uint64_t rtt_usec = t_now_usec - time;
+					rtt_cnt.store(rtt_cnt.load() + 1);
+					rtt_sum_usec.store(rtt_sum_usec.load() + rtt_usec);
+					if (rtt_usec < rtt_min_usec.load())
+						rtt_min_usec.store(rtt_usec);
+					if (rtt_usec > rtt_max_usec.load())
+						rtt_max_usec.store(rtt_usec);
+					uint64_t srtt = rtt_smoothed_usec.load();
+					if (srtt == 0)
+						srtt = rtt_usec;
+					else
+						srtt = srtt - (srtt >> RTT_EWMA_SHIFT) + (rtt_usec >> RTT_EWMA_SHIFT);
+					rtt_smoothed_usec.store(srtt);
+				}
 			}
 		}
 	}
@@ -180,6 +446,325 @@ void *receiver_thread_run(void *param)
 	return NULL;
 }
 
+/**
+ * Record a switch between remote and local control.
+ */
+void log_switch(FallbackController::Switch sw, uint64_t t_usec)
+{
+	if (sw == FallbackController::Switch::NONE)
+		return;
+
+	switch_event_t evt = {t_usec, fallback->age(t_usec), sw == FallbackController::Switch::TO_LOCAL};
+	if (evt.to_local)
+		switches_to_local.fetch_add(1);
+	// Events are only lost if the main thread stalls for many switches.
+	switch_events.push(evt);
+}
+
+/**
+ * Write pending switch events to the switch log.
+ */
+void write_switch_events(FILE *f)
+{
+	switch_event_t evt;
+	while (switch_events.pop(evt)) {
+		if (f != NULL)
+			fprintf(f, "%" PRIu64 ",%s,%" PRIu64 "\n", evt.t_usec,
+				evt.to_local ? "local" : "remote", evt.age_usec);
+	}
+}
+
+/**
+ * Physics thread advancing the plant in fixed steps of PARAM_DT, locked to
+ * wall time.
+ *
+ * Simulation time runs behind the plant clock by the total skipped time,
+ * which only grows on overruns. Control updates are applied exactly at
+ * their arrival time by splitting the step in which they arrived.
+ */
+void *physics_thread_run(void *param)
+{
+	InvertedPendulum *pendulum = (InvertedPendulum *) param;
+	const uint64_t step_usec = PARAM_DT*1000000.0;
+	// End of the last step and time up to which the current step has been
+	// simulated (both in simulation time) [us].
+	uint64_t t_step_usec = 0;
+	uint64_t t_sim_usec = 0;
+	uint64_t skipped_usec = 0;
+	uint64_t t_next_log_output_usec = 0;
+	update_t upd;
+	bool has_upd = false;
+
+	while (running.load()) {
+		sleep_until_usec(t_step_usec + step_usec + skipped_usec);
+
+		uint64_t t_now_usec = plant_time_usec();
+		uint64_t steps_due = (t_now_usec - skipped_usec - t_step_usec)/step_usec;
+		if (steps_due > PHYSICS_MAX_CATCHUP_STEPS) {
+			uint64_t skip = (steps_due - PHYSICS_MAX_CATCHUP_STEPS)*step_usec;
+			skipped_usec += skip;
+			physics_overruns.fetch_add(1);
+			physics_skipped_usec.fetch_add(skip);
+			steps_due = PHYSICS_MAX_CATCHUP_STEPS;
+		}
+
+		for (uint64_t i = 0; i < steps_due; i++) {
+			uint64_t t_end_usec = t_step_usec + step_usec;
+
+			// Check staleness and let the local fallback
+			// controller act on the latest state.
+			// With a horizon, the remote control value
+			// matching the current time is applied.
+			uint64_t t_wall_usec = t_step_usec + skipped_usec;
+			if (fallback != NULL) {
+				FallbackController::Switch sw;
+				double u = fallback->control(t_wall_usec, pendulum->get_state(), sw);
+				if (!fallback->is_local() && horizon.valid())
+					u = horizon.value(0.000001*t_wall_usec);
+				pendulum->set_force(u);
+				log_switch(sw, t_wall_usec);
+				if (fallback->is_local())
+					local_steps.fetch_add(1);
+			} else if (horizon.valid()) {
+				pendulum->set_force(horizon.value(0.000001*t_wall_usec));
+			}
+
+			// Apply updates that arrived within this step at
+			// their arrival time. Updates that arrived during
+			// skipped time are applied immediately.
+			while (has_upd || (has_upd = updates.pop(upd))) {
+				uint64_t t_arrival_usec = (upd.t_arrival_usec > skipped_usec) ?
+					upd.t_arrival_usec - skipped_usec : 0;
+				if (t_arrival_usec >= t_end_usec)
+					break;
+				if (t_arrival_usec > t_sim_usec) {
+					pendulum->step(0.000001*(t_arrival_usec - t_sim_usec));
+					t_sim_usec = t_arrival_usec;
+				}
+				double u = upd.u;
+				if (upd.n > 0) {
+					horizon.received(0.000001*upd.t_sample_usec, 0.000001*upd.step_usec,
+							 upd.horizon, upd.n);
+					u = horizon.value(0.000001*upd.t_arrival_usec);
+				}
+				if (fallback != NULL) {
+					FallbackController::Switch sw = fallback->received(
+						upd.t_arrival_usec, upd.t_sample_usec, u);
+					log_switch(sw, upd.t_arrival_usec);
+					if (!fallback->is_local())
+						pendulum->set_force(u);
+				} else {
+					pendulum->set_force(u);
+				}
+				has_upd = false;
+			}
+			if (t_end_usec > t_sim_usec)
+				pendulum->step(0.000001*(t_end_usec - t_sim_usec));
+			t_step_usec = t_end_usec;
+			t_sim_usec = t_end_usec;
+
+			plant_snapshot_t snap;
+			snap.t_usec = t_step_usec + skipped_usec;
+			snap.state = pendulum->get_state();
+			snap.force = pendulum->get_force();
+			snapshot.store(snap);
+			if (live_feed.is_open())
+				live_feed.publish(0.000001*snap.t_usec, snap.state);
+
+			if (logging) {
+				if (log_full_rate) {
+					logger.log(snap.t_usec, snap.state.data(), snap.force);
+				} else if (t_next_log_output_usec <= t_step_usec) {
+					logger.log(snap.t_usec, snap.state.data(), snap.force);
+					t_next_log_output_usec += LOG_INTERVAL_USEC;
+				}
+			}
+		}
+		physics_steps.fetch_add(steps_due);
+	}
+
+	return NULL;
+}
+
+/**
+ * Sampler thread sending the latest state snapshot to the controller
+ * once per cycle if the transmission policy decides so.
+ */
+void *sampler_thread_run(void *param)
+{
+	TransmissionTrigger *trigger = (TransmissionTrigger *) param;
+	uint64_t t_next_cycle_usec = 0;
+
+	while (running.load()) {
+		sleep_until_usec(t_next_cycle_usec);
+
+		// The state is stamped with the time of the physics step that
+		// computed it (echoed by the controller as sampling time).
+		plant_snapshot_t snap = snapshot.load();
+		if (!trigger->should_send(0.000001*snap.t_usec, snap.state)) {
+			t_next_cycle_usec += cycletime_usec;
+			continue;
+		}
+		double x = snap.state[0];
+		double v = snap.state[1];
+		double angle = snap.state[2];
+		double omega = snap.state[3];
+		uint64_t t_sample_usec = snap.t_usec;
+		size_t data_len;
+		uint8_t data[MAX_PKT_SIZE];
+		uint64_t srtt = rtt_smoothed_usec.load();
+		if (srtt > 0)
+			data_len = marshaling_state_rtt(data, MAX_PKT_SIZE, t_sample_usec, angle, omega, x, v, srtt);
+		else
+			data_len = marshaling_state(data, MAX_PKT_SIZE, t_sample_usec, angle, omega, x, v);
+		if (data_len == -1) {
+			fprintf(stderr, "Could not marshal data.\n");
+		} else if (transport->send(data, data_len) == -1) {
+			perror("Could not send update to controller");
+		} else {
+			//printf("State sent: time = %" PRIu64 " us  x = %f angle = %f degree\n", t_sample_usec, x, angle);
+		}
+
+		t_next_cycle_usec += cycletime_usec;
+	}
+
+	return NULL;
+}
+
+/**
+ * Send the state to the controller and wait for the corresponding update.
+ *
+ * @param t_usec virtual sampling time (echoed by the controller)
+ * @param state state to send
+ * @param u receives the update
+ * @return true on success; false on error.
+ */
+bool exchange_state(uint64_t t_usec, const pendulum_state_t &state, double &u)
+{
+	uint8_t data[MAX_PKT_SIZE];
+	ssize_t state_len = marshaling_state(data, MAX_PKT_SIZE, t_usec, state[2], state[3], state[0], state[1]);
+	if (state_len == -1) {
+		fprintf(stderr, "Could not marshal data.\n");
+		return false;
+	}
+	uint8_t state_msg[MAX_PKT_SIZE];
+	memcpy(state_msg, data, state_len);
+
+	// The state or the update might get lost (UDP): send the state again
+	// after a timeout. Updates of duplicate states carry the same time and
+	// are ignored as stale later.
+	for (unsigned int retries = 0; retries <= PARAM_VIRTUAL_MAX_RETRIES; retries++) {
+		if (transport->send(state_msg, state_len) == -1) {
+			perror("Could not send state to controller");
+			return false;
+		}
+
+		while (true) {
+			ssize_t data_len = transport->recv(data, MAX_PKT_SIZE);
+			if (data_len == -1) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+					break;
+				// Also ends the run if interrupted by a signal (EINTR).
+				perror("Could not receive message");
+				return false;
+			}
+			uint64_t time;
+			if (data_len > UPDATE_MSG_LEN) {
+				fprintf(stderr, "Horizon messages are not supported in virtual-time mode\n");
+				return false;
+			}
+			if (!demarshaling_update(data, data_len, time, u)) {
+				fprintf(stderr, "Demarshaling failed\n");
+				continue;
+			}
+			// Ignore stale updates of earlier states.
+			if (time == t_usec)
+				return true;
+		}
+	}
+
+	fprintf(stderr, "No update from controller for state at %" PRIu64 " us after %d retries\n", t_usec,
+		PARAM_VIRTUAL_MAX_RETRIES);
+	return false;
+}
+
+/**
+ * Virtual-time mode: plant and controller still communicate over the
+ * configured transport, but time is a logical clock driven by the event
+ * queue of the packet trace instead of wall time.
+ *
+ * At every send time of the trace, the plant sends its state and waits
+ * for the controller's update (controller time does not advance while
+ * it computes). The update is applied at the receive time of the trace.
+ * Event handling is the same as in simulate-event_queue, so both produce
+ * the same state trace for the same controller.
+ *
+ * @return exit status
+ */
+int run_virtual()
+{
+	pendulum_state_t state_initial = {initial_x, PARAM_v, initial_angle, 0.0};
+	InvertedPendulum pendulum = InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial);
+	state_sequence_t states;
+
+	EventQueue eventQueue = EventQueue(virtual_trace_path, PARAM_VIRTUAL_DT);
+
+	std::vector<double> u_vec;
+	unsigned long currentRcvSeqNumber = 0;
+	bool failed = false;
+
+	pendulum.action = [&pendulum, &u_vec, &states, &currentRcvSeqNumber, &failed](const Event &e) {
+		if (failed)
+			return;
+		if (e.type == Event::Type::UPDATE) {
+			pendulum.simulate(PARAM_VIRTUAL_DT, states);
+			if (live_feed.is_open() && !states.empty())
+				live_feed.publish(states.back().first, states.back().second);
+		} else if (e.type == Event::Type::SEND) {
+			if (u_vec.size() <= e.pktNr)
+				u_vec.resize(e.pktNr+1, 0.0);
+			// Nothing has been sampled before the first step.
+			if (states.empty())
+				return;
+			uint64_t t_usec = llround(e.time*1000000.0);
+			if (!exchange_state(t_usec, states.back().second, u_vec[e.pktNr]))
+				failed = true;
+		} else if (e.type == Event::Type::RECEIVE) {
+			if (e.pktNr >= currentRcvSeqNumber && e.pktNr < u_vec.size()) {
+				pendulum.set_force(u_vec[e.pktNr]);
+				currentRcvSeqNumber = e.pktNr;
+			}
+		}
+	};
+	eventQueue.addReceiver(pendulum.action, "plant");
+
+	struct timespec ts_start, ts_end;
+	clock_gettime(CLOCK_MONOTONIC, &ts_start);
+	eventQueue.run(PARAM_RUNTIME);
+	clock_gettime(CLOCK_MONOTONIC, &ts_end);
+	if (failed)
+		return 1;
+
+	double runtime = (ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec)/1e9;
+	printf("Simulated %.1f s in %.3f s wall time (%.1fx real time)\n",
+	       PARAM_RUNTIME, runtime, PARAM_RUNTIME/runtime);
+
+	if (strlen(log_file_path) > 0) {
+		std::ofstream out(log_file_path);
+		if (!out.is_open()) {
+			perror("Could not open log file");
+			return 1;
+		}
+		out << "t,x,v,phi,omega" << std::endl;
+		for (const time_state_t &ts : states) {
+			out << ts.first << "," << ts.second[0] << "," << ts.second[1] << ","
+			    << ts.second[2] << "," << ts.second[3] << std::endl;
+		}
+	}
+
+	return 0;
+}
+
 double to_deg(float rad)
 {
         return rad*(180.0 / M_PI);
@@ -192,24 +777,63 @@ int main(int argc, char *argv[])
 		die(1);
 	}
 
-	//Create client socket for communicating with controller.
-	sock = datagram_client_socket(ctrl_host, ctrl_service);
-        if (sock == -1) {
-                perror("Could not create socket");
-                die(1);
-        }
+	if (strlen(live_feed_name) > 0 && !live_feed.open(live_feed_name)) {
+		perror("Could not create live feed");
+		die(1);
+	}
+
+	// Create transport for communicating with controller.
+	if (strlen(shm_name) > 0) {
+		ShmTransport *shm = new ShmTransport();
+		ShmTransport::Wakeup wakeup = shm_busy_poll ? ShmTransport::Wakeup::BUSY_POLL :
+			ShmTransport::Wakeup::FUTEX;
+		if (!shm->open(shm_name, ShmTransport::Role::PLANT, wakeup)) {
+			perror("Could not attach to shared-memory segment");
+			die(1);
+		}
+		transport = shm;
+	} else if (use_uring) {
+		// Sender and receiver are different threads, so sends must
+		// not be batched.
+		UringTransport *uring = new UringTransport();
+		if (!uring->open_client(ctrl_host, ctrl_service, false)) {
+			perror("Could not set up io_uring socket");
+			die(1);
+		}
+		transport = uring;
+	} else {
+		UdpClientTransport *udp = new UdpClientTransport();
+		if (!udp->open(ctrl_host, ctrl_service)) {
+			perror("Could not create socket");
+			die(1);
+		}
+		transport = udp;
+	}
 	
+	if (strlen(virtual_trace_path) > 0) {
+		if (!transport->set_recv_timeout(PARAM_VIRTUAL_RECV_TIMEOUT_USEC)) {
+			perror("Could not set receive timeout");
+			die(1);
+		}
+		int status = run_virtual();
+		delete transport;
+		return status;
+	}
+
 	// Create thread receiving updates from controller.
-	if (pthread_create(&thread, NULL, receiver_thread_run, NULL)) {
+	if (pthread_create(&receiver_thread, NULL, receiver_thread_run, NULL)) {
 		perror("Could not create thread");
 		die(1);
 	}
 
 	// Open log file if requested.
-	FILE *log_file = NULL;
-	if (strlen(log_file_path) > 0) {
-		log_file = fopen(log_file_path, "w");
-		if (log_file == NULL) {
+	// Log entries are written asynchronously by the logger thread
+	// such that file I/O does not stall the real-time loop.
+	logging = (strlen(log_file_path) > 0);
+	if (logging) {
+		AsyncLogger::Format format = log_full_rate ? AsyncLogger::Format::FULL_STATE :
+			AsyncLogger::Format::POSITION_ANGLE;
+		if (!logger.open(log_file_path, format)) {
 			perror("Could not open log file");
 			die(1);
 		}
@@ -218,7 +842,7 @@ int main(int argc, char *argv[])
 	sf::RenderWindow window(sf::VideoMode(1024, 480), "Inverted Pendulum");
 	
 	// Create a model with default parameters
-	pendulum_state_t state_initial = {PARAM_x, PARAM_v, PARAM_angle, 0.0};
+	pendulum_state_t state_initial = {initial_x, PARAM_v, initial_angle, 0.0};
         InvertedPendulum pendulum = InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial);
 
         // Create a track for the cart
@@ -240,18 +864,39 @@ int main(int argc, char *argv[])
         const sf::Color brown = sf::Color(0xCC, 0x99, 0x66);
         pole.setFillColor(brown);
 
-        // Create a clock to run the simulation
-        sf::Clock clock;
+        // Start the clock to run the simulation
+	clock_gettime(CLOCK_MONOTONIC, &ts_plant_start);
+
+	// Create local fallback controller if requested.
+	FILE *switch_log = NULL;
+	if (staleness_deadline_usec > 0) {
+		const pendulum_state_t K = LQR_K;
+		fallback = new FallbackController(K, fallback_mode, staleness_deadline_usec,
+						  FALLBACK_MAX_EXTRAPOLATION_USEC);
+		if (strlen(switch_log_path) > 0) {
+			switch_log = fopen(switch_log_path, "w");
+			if (switch_log == NULL) {
+				perror("Could not open switch log");
+				die(1);
+			}
+			fprintf(switch_log, "# t_usec,mode,age_usec\n");
+		}
+	}
 
-	// The system input.
-	double u = 0;
+	TransmissionTrigger trigger(trigger_policy, trigger_threshold, trigger_max_silence);
 
-	// First cycle starts now.
-	uint64_t t_next_cycle_usec = clock.getElapsedTime().asMicroseconds();
+	plant_snapshot_t snap_initial = {0, pendulum.get_state(), pendulum.get_force()};
+	snapshot.store(snap_initial);
 
-	uint64_t t_next_log_output_usec = t_next_cycle_usec;
+	// Physics and sampling run in their own threads, such that neither
+	// depends on the frame rate of the renderer.
+	if (pthread_create(&physics_thread, NULL, physics_thread_run, &pendulum) ||
+	    pthread_create(&sampler_thread, NULL, sampler_thread_run, &trigger)) {
+		perror("Could not create thread");
+		die(1);
+	}
 
-	while (window.isOpen() && clock.getElapsedTime().asMicroseconds() < PARAM_RUNTIME*1000000.0) {
+	while (window.isOpen() && plant_time_usec() < PARAM_RUNTIME*1000000.0) {
 		sf::Event event;
 		while (window.pollEvent(event)) {
 			switch (event.type) {
@@ -261,58 +906,12 @@ int main(int argc, char *argv[])
 			}
 		}
 
-		sf::Time t_current = clock.getElapsedTime();
-		uint64_t t_current_usec = t_current.asMicroseconds();
-		const std::string msg = std::to_string(t_current.asSeconds());
-		
-		// If next cycle has started, sample plant state and send state to controller.
-		if (t_next_cycle_usec <= t_current_usec) {
-		        pendulum_state_t state = pendulum.get_state();
-			double x = state[0];
-			double v = state[1];
-			double angle = state[2];
-			double omega = state[3];
-			size_t data_len;
-			uint8_t data[MAX_PKT_SIZE];
-			data_len = marshaling_state(data, MAX_PKT_SIZE, t_current_usec, angle, omega, x, v); 
-			if (data_len == -1) {
-				fprintf(stderr, "Could not marshal data.\n");
-			} else if (send(sock, data, data_len, 0) == -1) {
-				perror("Could not send update to controller");
-			} else {
-			        //printf("State sent: time = %" PRIu64 " us  x = %f angle = %f degree\n", t_current_usec, x, angle);
-			}
-			
-			t_next_cycle_usec += cycletime_usec;
-		}
-		
-		// If an update from the controller is available, update system input.
-		// If no update is available, keep the old value of the system input. 
-		// If we can exchange a 1 by a 0, there was a new update ready.
-		// Maybe, we have missed some updates, but we can always read the latest update.
-		int expected_val = 1;
-		int new_val = 0;
-		if (update_ready.compare_exchange_weak(expected_val, new_val)) {
-			update_lock.lock();
-			u = update.u;
-			pendulum.set_force(u);
-			update_lock.unlock();
-			//printf("Update received: u = %f\n", u);
-		}
+		write_switch_events(switch_log);
 
-		// Update the plant.
-		double t_old = pendulum.get_time();
-		double d = 0.000001*t_current_usec - t_old;
-		state_sequence_t states;
-		if (d >= PARAM_DT) {
- 		        pendulum.simulate(d, PARAM_DT, states);		
-		}
-		states.clear(); // don't need intermediate states
-		  
 		// Update SFML drawings
-		pendulum_state_t state = pendulum.get_state();
-		float x = state[0];
-		float angle_deg = to_deg(state[2]);
+		plant_snapshot_t snap = snapshot.load();
+		float x = snap.state[0];
+		float angle_deg = to_deg(snap.state[2]);
 		
                 cart.setPosition(320.0 + 100 * x, 240.0);
                 pole.setPosition(320.0 + 100 * x, 240.0);
@@ -323,16 +922,40 @@ int main(int argc, char *argv[])
                 window.draw(cart);
                 window.draw(pole);
                 window.display();
-
-		if (log_file && t_next_log_output_usec <= t_current_usec) {
-		        if (fprintf(log_file, "%" PRIu64 ",%f,%f\n", t_current_usec, x, angle_deg) < 0)
-				perror("Failed to write log entry");
-			        t_next_log_output_usec += LOG_INTERVAL_USEC;
-		}
 	}
 
-	if (log_file)
-		fclose(log_file);
+	running.store(false);
+	pthread_join(physics_thread, NULL);
+	pthread_join(sampler_thread, NULL);
+
+	uint64_t n_samples = trigger.sent() + trigger.suppressed();
+	printf("Transmissions: %" PRIu64 " of %" PRIu64 " samples sent (%.1f %%)\n", trigger.sent(), n_samples,
+	       n_samples > 0 ? 100.0*trigger.sent()/n_samples : 0.0);
+	printf("Physics: %" PRIu64 " steps, %" PRIu64 " overruns (%" PRIu64 " us skipped)\n",
+	       physics_steps.load(), physics_overruns.load(), physics_skipped_usec.load());
+	if (fallback != NULL) {
+		write_switch_events(switch_log);
+		if (switch_log != NULL)
+			fclose(switch_log);
+		printf("Fallback: %" PRIu64 " switches to local control, %.1f %% of steps local\n",
+		       switches_to_local.load(),
+		       physics_steps.load() > 0 ? 100.0*local_steps.load()/physics_steps.load() : 0.0);
+		delete fallback;
+	}
+	if (updates_dropped.load() > 0)
+		fprintf(stderr, "%" PRIu64 " control updates dropped\n", updates_dropped.load());
+
+	uint64_t n_rtt = rtt_cnt.load();
+	if (n_rtt > 0)
+		printf("RTT: %" PRIu64 " samples, min %" PRIu64 " us, mean %.1f us, max %" PRIu64 " us\n",
+		       n_rtt, rtt_min_usec.load(), (double) rtt_sum_usec.load() / n_rtt, rtt_max_usec.load());
+
+	if (logging) {
+		logger.close();
+		if (logger.dropped() > 0)
+			fprintf(stderr, "Log: %" PRIu64 " entries written, %" PRIu64 " entries dropped\n",
+				logger.written(), logger.dropped());
+	}
 	
 	return 0;
 }
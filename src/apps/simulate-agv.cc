@@ -11,8 +11,11 @@
 #include "../controller/pid.h"
 #include "../events/event.h"
 #include "../events/event_queue.h"
+#include "../events/event_trace.h"
 #include "../events/event_receiver.h"
 #include "../inverted_pendulum/inverted_pendulum.h"
+#include "../netutils/state_feed.h"
+#include "../utils/log.h"
 
 #include <cmath>
 #include <cstring>
@@ -63,29 +66,48 @@
                 -3.162277660168483, -6.105688949485788, 49.16351188321586, 7.204143097154165                           \
         }
 
+// Default simulated time [s]
+#define PARAM_DURATION 60.0
+
 #define MAX_STR_LEN 1024
 
 char pathInputCSVFile[MAX_STR_LEN];
 char pathOutputCSVFile[MAX_STR_LEN];
+char liveFeedName[MAX_STR_LEN];
+
+// Live feed of the state to viewers (option -W).
+StateFeedPublisher liveFeed;
+
+// Binary trace of the events (option -E).
+char pathEventTrace[MAX_STR_LEN];
+EventTrace eventTrace;
 
 int simNumber = 0;
 double d = 1.0;
 double eps = 0.05;
 
+// Simulated time [s]
+double simDuration = PARAM_DURATION;
+
 /**
  * Print usage information for the command line arguments.
  */
 void usage(const char *progname)
 {
         fprintf(stderr,
-                "Usage: %s -i <input.csv> -o <output.csv> -n <sim_number> -d <distance> -e <epsilon>\n"
+                "Usage: %s -i <input.csv> -o <output.csv> -n <sim_number> -d <distance> -e <epsilon> [-W <name>] [-t <duration>] [-E <trace>] [-L <level>]\n"
                 "Options:\n"
                 "  -i <input.csv>     Path to the input CSV file\n"
                 "  -o <output.csv>    Path to the output CSV file\n"
                 "  -n <sim_number>    Simulation number (integer). Select a simulation 1 (PID) or 2 (LQR).\n"
                 "  -d <distance>      Parameter d (floating-point), distance between two AGVs, default: 1.0m\n"
-                "  -e <epsilon>       Initial position error (floating-point), default: 0.05m\n",
-                progname);
+                "  -e <epsilon>       Initial position error (floating-point), default: 0.05m\n"
+                "  -W <name>          Publish the pendulum state to the live feed <name> (see visualization -w)\n"
+                "  -t <duration>      Simulated time in seconds, default: %gs\n"
+                "  -E <trace>         Write a binary trace of the events to <trace> (see event-trace-dump)\n"
+                "  -L <level>         Log level: off, error, warn (default), info, debug, or trace (every event;\n"
+                "                     requires LOG_COMPILE_LEVEL trace)\n",
+                progname, PARAM_DURATION);
 }
 
 /**
@@ -97,9 +119,11 @@ int parse_cmdline_args(int argc, char *argv[])
         int opt;
 
         memset(pathInputCSVFile, 0, MAX_STR_LEN);
+        memset(liveFeedName, 0, MAX_STR_LEN);
+        memset(pathEventTrace, 0, MAX_STR_LEN);
         memset(pathOutputCSVFile, 0, MAX_STR_LEN);
 
-        while ((opt = getopt(argc, argv, "i:o:n:d:e:")) != -1) {
+        while ((opt = getopt(argc, argv, "i:o:n:d:e:W:t:E:L:")) != -1) {
                 switch (opt) {
                 case 'i':
                         strncpy(pathInputCSVFile, optarg, MAX_STR_LEN - 1);
@@ -116,6 +140,19 @@ int parse_cmdline_args(int argc, char *argv[])
                 case 'e':
                         eps = atof(optarg);
                         break;
+                case 'W':
+                        strncpy(liveFeedName, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 't':
+                        simDuration = atof(optarg);
+                        break;
+                case 'E':
+                        strncpy(pathEventTrace, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'L':
+                        if (!log_parse_level(optarg, log_level))
+                                return -1;
+                        break;
                 case ':':
                 case '?':
                 default:
@@ -123,12 +160,21 @@ int parse_cmdline_args(int argc, char *argv[])
                 }
         }
 
-        if (strlen(pathInputCSVFile) == 0 || strlen(pathOutputCSVFile) == 0)
+        if (strlen(pathInputCSVFile) == 0 || strlen(pathOutputCSVFile) == 0 || simDuration <= 0.0)
                 return -1;
 
         return 0;
 }
 
+/**
+ * Publish the newest state to the live feed (if enabled).
+ */
+void publish_state(const state_sequence_t &states)
+{
+        if (liveFeed.is_open() && !states.empty())
+                liveFeed.publish(states.back().first, states.back().second);
+}
+
 void print_states_csv_to_file(const state_sequence_t &states, const std::string &filename)
 {
         std::ofstream out(filename);
@@ -188,18 +234,18 @@ void simulate_pid_position_angle(double untilTime)
         // Maybe, we have missed some updates, but we can always read the latest update.
         pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber](const Event &e) {
                 if (e.type == Event::Type::UPDATE) {
-                        printf("PLANT: update at %f, event %lu, f= %f\n", e.time, e.eventId, pendulum.get_force());
+                        eventTrace.record(EventTrace::PLANT_UPDATE, e, 0, pendulum.get_force());
                         pendulum.simulate(PARAM_DT, states);
+                        publish_state(states);
                 } else if (e.type == Event::Type::RECEIVE) {
-                        printf("PLANT: receive at %f, event %lu, seqNr %lu\n", e.time, e.eventId, e.pktNr);
+                        eventTrace.record(EventTrace::PLANT_RECEIVE, e, e.pktNr, 0.0);
                         if (e.pktNr >= currentRcvSeqNumber) {
                                 pendulum.set_force(u_vec[e.pktNr]);
                                 currentRcvSeqNumber = e.pktNr;
                         }
                 } else if (e.type == Event::Type::SEND) {
                         ++nextSendSeqNumber;
-                        printf("PLANT: send at %f, event %lu. next seqNr: %lu. Force: %f\n", e.time, e.eventId,
-                               nextSendSeqNumber, pendulum.get_force());
+                        eventTrace.record(EventTrace::PLANT_SEND, e, nextSendSeqNumber, pendulum.get_force());
                 }
         };
 
@@ -228,18 +274,16 @@ void simulate_pid_position_angle(double untilTime)
 
                                 double phi = states.back().second[2];
                                 u_vec.push_back(-pid_ctrl_angle.control(phi_setpoint, phi, t));
-                                printf("CONTROLLER: compute next U = %f at %f, event %lu, pctNr: %lu\n", u_vec.back(),
-                                       e.time, e.eventId, e.pktNr);
+                                eventTrace.record(EventTrace::CONTROLLER_UPDATE, e, e.pktNr, u_vec.back());
                         } else if (!states.empty()) {
-                                printf("CONTROLLER: Out-of-order packet, no update at %f, event %lu\n", e.time,
-                                       e.eventId);
+                                eventTrace.record(EventTrace::CONTROLLER_OUT_OF_ORDER, e, e.pktNr, 0.0);
                         }
                 }
         };
 
         // Make sure the order is correct
-        eventQueue.addReceiver(pendulum.action);
-        eventQueue.addReceiver(pid_ctrl_angle.action);
+        eventQueue.addReceiver(pendulum.action, "plant");
+        eventQueue.addReceiver(pid_ctrl_angle.action, "controller");
 
         eventQueue.run(untilTime);
 
@@ -277,17 +321,18 @@ void simulate_lqr_position_angle(double untilTime)
         // Maybe, we have missed some updates, but we can always read the latest update.
         pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber](const Event &e) {
                 if (e.type == Event::Type::UPDATE) {
-                        printf("PLANT: update at %f, event %lu, f= %f\n", e.time, e.eventId, pendulum.get_force());
+                        eventTrace.record(EventTrace::PLANT_UPDATE, e, 0, pendulum.get_force());
                         pendulum.simulate(PARAM_DT, states);
+                        publish_state(states);
                 } else if (e.type == Event::Type::RECEIVE) {
-                        printf("PLANT: receive at %f, event %lu, seqNr %lu\n", e.time, e.eventId, e.pktNr);
+                        eventTrace.record(EventTrace::PLANT_RECEIVE, e, e.pktNr, 0.0);
                         if (e.pktNr >= currentRcvSeqNumber) {
                                 pendulum.set_force(u_vec[e.pktNr]);
                                 currentRcvSeqNumber = e.pktNr;
                         }
                 } else if (e.type == Event::Type::SEND) {
                         ++nextSendSeqNumber;
-                        printf("PLANT: send at %f, event %lu. next seqNr: %lu\n", e.time, e.eventId, nextSendSeqNumber);
+                        eventTrace.record(EventTrace::PLANT_SEND, e, nextSendSeqNumber, pendulum.get_force());
                 }
         };
 
@@ -297,18 +342,16 @@ void simulate_lqr_position_angle(double untilTime)
                                 // with position control
                                 double pos = 10 * std::sin(0.2 * states.back().first) + d / 2;
                                 u_vec.push_back(lqr.control(states.back().second, pos));
-                                printf("CONTROLLER: compute next U = %f at %f, event %lu, pctNr: %lu\n", u_vec.back(),
-                                       e.time, e.eventId, e.pktNr);
+                                eventTrace.record(EventTrace::CONTROLLER_UPDATE, e, e.pktNr, u_vec.back());
                         } else if (!states.empty()) {
-                                printf("CONTROLLER: out-of-order packet, no update at %f, event %lu\n", e.time,
-                                       e.eventId);
+                                eventTrace.record(EventTrace::CONTROLLER_OUT_OF_ORDER, e, e.pktNr, 0.0);
                         }
                 }
         };
 
         // Make sure the order is correct
-        eventQueue.addReceiver(pendulum.action);
-        eventQueue.addReceiver(lqr.action);
+        eventQueue.addReceiver(pendulum.action, "plant");
+        eventQueue.addReceiver(lqr.action, "controller");
 
         eventQueue.run(untilTime);
 
@@ -322,19 +365,34 @@ int main(int argc, char *argv[])
                 exit(1);
         }
 
+        if (strlen(liveFeedName) > 0 && !liveFeed.open(liveFeedName)) {
+                perror("Could not create live feed");
+                exit(1);
+        }
+
+        if (strlen(pathEventTrace) > 0 && !eventTrace.open(pathEventTrace)) {
+                perror("Could not open event trace");
+                exit(1);
+        }
+
         switch (simNumber) {
         case 1:
-                simulate_pid_position_angle(60.0);
+                simulate_pid_position_angle(simDuration);
                 break;
         case 2:
-                simulate_lqr_position_angle(60.0);
+                simulate_lqr_position_angle(simDuration);
                 break;
         default:
                 std::cout << "Select a simulation 1 (PID) or 2 (LQR)." << std::endl;
                 return -1;
         }
 
-        std::cout << "Simulation finished." << std::endl;
+        if (!eventTrace.close()) {
+                perror("Could not write event trace");
+                exit(1);
+        }
+
+        LOG_INFO("Simulation finished.\n");
 
         return 0;
 }
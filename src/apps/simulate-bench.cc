@@ -0,0 +1,541 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+/**
+ * End-to-end throughput benchmark of the event-driven simulators.
+ *
+ * Generates synthetic packet traces of the given lengths and delay
+ * distributions and runs simulate-event_queue (PID and LQR) and simulate-agv
+ * (PID and LQR) on them, each as a separate process like in a parameter
+ * sweep. For every configuration, the simulated time per wall-clock time,
+ * the events dispatched per second, the peak resident set size, and the
+ * bytes written are reported as CSV. With several numbers of processes
+ * running concurrently (option -j), the speedup over one process shows how
+ * the throughput scales with the number of cores.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define MAX_STR_LEN 1024
+
+// Maximum number of concurrent processes and repetitions
+#define MAX_PROCESSES 1024
+#define MAX_REPETITIONS 100
+
+// Period of the UPDATE events of the simulators (PARAM_DT) [s]
+#define SIM_DT 0.0001
+
+struct simulator_t {
+        const char *name;
+        const char *program;
+        const char *sim_number;
+};
+
+static const simulator_t simulators[] = {
+        {"event_queue-pid", "simulate-event_queue", "1"},
+        {"event_queue-lqr", "simulate-event_queue", "2"},
+        {"agv-pid", "simulate-agv", "1"},
+        {"agv-lqr", "simulate-agv", "2"},
+};
+
+/**
+ * Distribution of the packet delays [ms]:
+ *
+ *   constant:D           always D
+ *   uniform:MIN,MAX      uniform between MIN and MAX
+ *   lognormal:MEDIAN,S   log-normal with median MEDIAN and shape S
+ */
+struct delay_dist_t {
+        enum class Kind { CONSTANT, UNIFORM, LOGNORMAL } kind;
+        double a;
+        double b;
+        char spec[MAX_STR_LEN];
+};
+
+/**
+ * Synthetic packet trace of one length and delay distribution.
+ */
+struct packet_trace_t {
+        char path[MAX_STR_LEN];
+        double duration;
+        const delay_dist_t *delay;
+        // Events dispatched by the event queue of the simulators within the
+        // duration (send, receive, and update events).
+        unsigned long events;
+};
+
+/**
+ * Measurement of one configuration.
+ */
+struct run_result_t {
+        double wall;
+        long peak_rss_kb;
+        off_t output_bytes;
+        off_t stdout_bytes;
+};
+
+// Global configuration parameters.
+char build_dir[MAX_STR_LEN];
+char output_path[MAX_STR_LEN];
+std::vector<const simulator_t *> selected_simulators;
+std::vector<double> durations;
+std::vector<delay_dist_t> delay_dists;
+std::vector<unsigned int> process_counts;
+double cycle = 1.0;
+double loss = 0.0;
+unsigned int repetitions = 1;
+unsigned long seed = 1;
+
+// Directory of the traces and outputs of the simulators
+char tmp_dir[MAX_STR_LEN];
+
+/**
+ * Print usage information.
+ */
+void usage(const char *prog)
+{
+        fprintf(stderr,
+                "Usage: %s \n"
+                "-s SIMULATORS : comma-separated list of simulators (default: all): \n"
+                "                event_queue-pid, event_queue-lqr, agv-pid, agv-lqr \n"
+                "-t DURATIONS : comma-separated list of simulated times in seconds (default: 10) \n"
+                "-D DELAY : delay distribution of the packets in ms; may be given several times \n"
+                "           (constant:D, uniform:MIN,MAX, or lognormal:MEDIAN,SHAPE; default: constant:2) \n"
+                "-c CYCLE : time between two packets in ms (default: 1) \n"
+                "-l LOSS : probability of losing a packet (default: 0) \n"
+                "-j PROCESSES : comma-separated list of numbers of concurrent simulations (1 to %d, default: 1) \n"
+                "-r REPETITIONS : runs per configuration; the median is reported (1 to %d, default: 1) \n"
+                "-S SEED : seed of the random delays (default: 1) \n"
+                "-B DIR : directory of the simulators (default: directory of this program) \n"
+                "-o FILENAME : write results to this CSV file instead of stdout \n"
+                "\n",
+                prog, MAX_PROCESSES, MAX_REPETITIONS);
+}
+
+/**
+ * Parse a delay distribution.
+ *
+ * @return true on success; false if the specification is invalid.
+ */
+static bool parse_delay_dist(const char *spec, delay_dist_t &dist)
+{
+        strncpy(dist.spec, spec, MAX_STR_LEN - 1);
+        dist.spec[MAX_STR_LEN - 1] = '\0';
+
+        if (sscanf(spec, "constant:%lf", &dist.a) == 1) {
+                dist.kind = delay_dist_t::Kind::CONSTANT;
+                dist.b = dist.a;
+                return (dist.a >= 0.0);
+        } else if (sscanf(spec, "uniform:%lf,%lf", &dist.a, &dist.b) == 2) {
+                dist.kind = delay_dist_t::Kind::UNIFORM;
+                return (dist.a >= 0.0 && dist.b >= dist.a);
+        } else if (sscanf(spec, "lognormal:%lf,%lf", &dist.a, &dist.b) == 2) {
+                dist.kind = delay_dist_t::Kind::LOGNORMAL;
+                return (dist.a > 0.0 && dist.b >= 0.0);
+        }
+
+        return false;
+}
+
+/**
+ * Parse a comma-separated list of numbers.
+ *
+ * @return true on success; false if the list is empty or a number is
+ * invalid.
+ */
+template <typename T> static bool parse_list(const char *arg, std::vector<T> &list)
+{
+        list.clear();
+        std::string s(arg);
+        size_t start = 0;
+        while (start <= s.size()) {
+                size_t end = s.find(',', start);
+                if (end == std::string::npos)
+                        end = s.size();
+                std::string item = s.substr(start, end - start);
+                char *rest;
+                double value = strtod(item.c_str(), &rest);
+                if (item.empty() || *rest != '\0' || value <= 0.0)
+                        return false;
+                list.push_back((T)value);
+                start = end + 1;
+        }
+
+        return !list.empty();
+}
+
+static bool parse_simulators(const char *arg)
+{
+        selected_simulators.clear();
+        std::string s(arg);
+        size_t start = 0;
+        while (start <= s.size()) {
+                size_t end = s.find(',', start);
+                if (end == std::string::npos)
+                        end = s.size();
+                std::string name = s.substr(start, end - start);
+                auto it = std::find_if(std::begin(simulators), std::end(simulators),
+                                       [&name](const simulator_t &sim) { return name == sim.name; });
+                if (it == std::end(simulators))
+                        return false;
+                selected_simulators.push_back(&*it);
+                start = end + 1;
+        }
+
+        return true;
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+        memset(build_dir, 0, MAX_STR_LEN);
+        memset(output_path, 0, MAX_STR_LEN);
+
+        while ((opt = getopt(argc, argv, "s:t:D:c:l:j:r:S:B:o:")) != -1) {
+                switch (opt) {
+                case 's':
+                        if (!parse_simulators(optarg))
+                                return -1;
+                        break;
+                case 't':
+                        if (!parse_list(optarg, durations))
+                                return -1;
+                        break;
+                case 'D': {
+                        delay_dist_t dist;
+                        if (!parse_delay_dist(optarg, dist))
+                                return -1;
+                        delay_dists.push_back(dist);
+                        break;
+                }
+                case 'c':
+                        cycle = atof(optarg);
+                        break;
+                case 'l':
+                        loss = atof(optarg);
+                        break;
+                case 'j':
+                        if (!parse_list(optarg, process_counts))
+                                return -1;
+                        break;
+                case 'r':
+                        repetitions = strtoul(optarg, NULL, 10);
+                        break;
+                case 'S':
+                        seed = strtoul(optarg, NULL, 10);
+                        break;
+                case 'B':
+                        strncpy(build_dir, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'o':
+                        strncpy(output_path, optarg, MAX_STR_LEN - 1);
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        if (selected_simulators.empty()) {
+                for (const simulator_t &sim : simulators)
+                        selected_simulators.push_back(&sim);
+        }
+        if (durations.empty())
+                durations.push_back(10.0);
+        if (delay_dists.empty()) {
+                delay_dist_t dist;
+                parse_delay_dist("constant:2", dist);
+                delay_dists.push_back(dist);
+        }
+        if (process_counts.empty())
+                process_counts.push_back(1);
+
+        if (cycle <= 0.0 || loss < 0.0 || loss >= 1.0)
+                return -1;
+
+        if (repetitions < 1 || repetitions > MAX_REPETITIONS)
+                return -1;
+
+        for (unsigned int n : process_counts) {
+                if (n > MAX_PROCESSES)
+                        return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * Monotonic time [s].
+ */
+static double now()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static off_t file_size(const char *path)
+{
+        struct stat st;
+        if (stat(path, &st) == -1)
+                return 0;
+        return st.st_size;
+}
+
+/**
+ * Write a synthetic packet trace: one packet per cycle during the
+ * duration, received after a random delay unless lost.
+ *
+ * @return true on success; false on error (errno is set).
+ */
+static bool write_packet_trace(packet_trace_t &trace, std::mt19937_64 &rng)
+{
+        FILE *f = fopen(trace.path, "w");
+        if (f == NULL)
+                return false;
+
+        std::uniform_real_distribution<double> uniform(trace.delay->a, trace.delay->b);
+        std::lognormal_distribution<double> lognormal(std::log(trace.delay->a), trace.delay->b);
+        std::bernoulli_distribution lost(loss);
+
+        fprintf(f, "pctNumber,rcvdTime,sendTime\n");
+        unsigned long packets = (unsigned long)std::ceil(trace.duration / (1e-3 * cycle));
+        unsigned long received = 0;
+        for (unsigned long i = 0; i < packets; i++) {
+                double sent = i * 1e-3 * cycle;
+                double delay;
+                switch (trace.delay->kind) {
+                case delay_dist_t::Kind::UNIFORM:
+                        delay = uniform(rng);
+                        break;
+                case delay_dist_t::Kind::LOGNORMAL:
+                        delay = lognormal(rng);
+                        break;
+                default:
+                        delay = trace.delay->a;
+                        break;
+                }
+                if (loss > 0.0 && lost(rng)) {
+                        fprintf(f, "%lu,,%.7f\n", i, sent);
+                } else {
+                        double rcvd = sent + 1e-3 * delay;
+                        fprintf(f, "%lu,%.7f,%.7f\n", i, rcvd, sent);
+                        if (rcvd <= trace.duration)
+                                received++;
+                }
+        }
+
+        trace.events = packets + received + (unsigned long)(trace.duration / SIM_DT) + 1;
+
+        return (fclose(f) == 0);
+}
+
+/**
+ * Run processes of a simulator concurrently on a trace.
+ *
+ * @return true on success; false if a simulation could not be started or
+ * failed.
+ */
+static bool run_simulations(const simulator_t &sim, const packet_trace_t &trace, unsigned int n_processes,
+                            run_result_t &result)
+{
+        char program[MAX_STR_LEN];
+        char duration[64];
+        if (snprintf(program, sizeof(program), "%s/%s", build_dir, sim.program) >= (int)sizeof(program)) {
+                fprintf(stderr, "Path of simulator too long: %s/%s\n", build_dir, sim.program);
+                return false;
+        }
+        snprintf(duration, sizeof(duration), "%.9g", trace.duration);
+
+        std::vector<std::string> output_paths(n_processes);
+        std::vector<std::string> stdout_paths(n_processes);
+        std::vector<pid_t> pids;
+        bool ok = true;
+
+        double start = now();
+        for (unsigned int k = 0; k < n_processes; k++) {
+                output_paths[k] = std::string(tmp_dir) + "/states-" + std::to_string(k) + ".csv";
+                stdout_paths[k] = std::string(tmp_dir) + "/stdout-" + std::to_string(k) + ".txt";
+
+                pid_t pid = fork();
+                if (pid == -1) {
+                        perror("Could not start simulation");
+                        ok = false;
+                        break;
+                }
+                if (pid == 0) {
+                        int fd = open(stdout_paths[k].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                        if (fd == -1 || dup2(fd, STDOUT_FILENO) == -1)
+                                _exit(127);
+                        close(fd);
+                        const char *args[] = {program, "-i", trace.path, "-o", output_paths[k].c_str(),
+                                              "-n", sim.sim_number, "-t", duration, NULL};
+                        execv(program, (char *const *)args);
+                        perror(program);
+                        _exit(127);
+                }
+                pids.push_back(pid);
+        }
+
+        result.peak_rss_kb = 0;
+        for (pid_t pid : pids) {
+                int status;
+                struct rusage usage;
+                if (wait4(pid, &status, 0, &usage) == -1) {
+                        perror("Could not wait for simulation");
+                        ok = false;
+                        continue;
+                }
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                        fprintf(stderr, "%s failed (status %d)\n", sim.program, status);
+                        ok = false;
+                }
+                result.peak_rss_kb = std::max(result.peak_rss_kb, usage.ru_maxrss);
+        }
+        result.wall = now() - start;
+
+        // Every process writes the same amount; report one of them.
+        result.output_bytes = file_size(output_paths[0].c_str());
+        result.stdout_bytes = file_size(stdout_paths[0].c_str());
+        for (unsigned int k = 0; k < n_processes; k++) {
+                unlink(output_paths[k].c_str());
+                unlink(stdout_paths[k].c_str());
+        }
+
+        return ok;
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                exit(1);
+        }
+
+        if (strlen(build_dir) == 0) {
+                char exe[MAX_STR_LEN] = {0};
+                if (readlink("/proc/self/exe", exe, MAX_STR_LEN - 1) == -1) {
+                        perror("Could not determine directory of the simulators");
+                        exit(1);
+                }
+                strncpy(build_dir, dirname(exe), MAX_STR_LEN - 1);
+        }
+
+        FILE *out = stdout;
+        if (strlen(output_path) > 0) {
+                out = fopen(output_path, "w");
+                if (out == NULL) {
+                        perror("Could not open output file");
+                        exit(1);
+                }
+        }
+
+        const char *tmpdir = getenv("TMPDIR");
+        if (snprintf(tmp_dir, MAX_STR_LEN, "%s/simulate-bench-XXXXXX", tmpdir ? tmpdir : "/tmp") >= MAX_STR_LEN) {
+                fprintf(stderr, "Path of temporary directory too long: %s\n", tmpdir);
+                exit(1);
+        }
+        if (mkdtemp(tmp_dir) == NULL) {
+                perror("Could not create temporary directory");
+                exit(1);
+        }
+
+        std::mt19937_64 rng(seed);
+        std::vector<packet_trace_t> traces;
+        for (double duration : durations) {
+                for (const delay_dist_t &dist : delay_dists) {
+                        packet_trace_t trace;
+                        if (snprintf(trace.path, MAX_STR_LEN, "%s/trace-%zu.csv", tmp_dir, traces.size()) >=
+                            MAX_STR_LEN) {
+                                fprintf(stderr, "Path of packet trace too long: %s/trace-%zu.csv\n", tmp_dir,
+                                        traces.size());
+                                for (const packet_trace_t &t : traces)
+                                        unlink(t.path);
+                                rmdir(tmp_dir);
+                                exit(1);
+                        }
+                        trace.duration = duration;
+                        trace.delay = &dist;
+                        if (!write_packet_trace(trace, rng)) {
+                                perror("Could not write packet trace");
+                                exit(1);
+                        }
+                        traces.push_back(trace);
+                }
+        }
+
+        fprintf(out, "# simulator,duration_s,delay_ms,loss,processes,wall_s,sim_s_per_wall_s,events_per_s,"
+                     "speedup,peak_rss_kb,output_bytes,stdout_bytes\n");
+        fflush(out);
+
+        int exit_status = 0;
+        for (const simulator_t *sim : selected_simulators) {
+                for (const packet_trace_t &trace : traces) {
+                        // Throughput of one process for the speedup
+                        double single_rate = 0.0;
+                        for (unsigned int n : process_counts) {
+                                std::vector<run_result_t> runs;
+                                bool ok = true;
+                                for (unsigned int r = 0; r < repetitions && ok; r++) {
+                                        run_result_t result;
+                                        ok = run_simulations(*sim, trace, n, result);
+                                        runs.push_back(result);
+                                }
+                                if (!ok) {
+                                        exit_status = 1;
+                                        continue;
+                                }
+                                std::sort(runs.begin(), runs.end(),
+                                          [](const run_result_t &a, const run_result_t &b) { return a.wall < b.wall; });
+                                const run_result_t &median = runs[runs.size() / 2];
+
+                                // Throughput of all processes together.
+                                double rate = n * trace.duration / median.wall;
+                                double events_rate = n * trace.events / median.wall;
+                                if (n == 1)
+                                        single_rate = rate;
+
+                                fprintf(out, "%s,%g,\"%s\",%g,%u,%.3f,%.2f,%.0f,", sim->name, trace.duration,
+                                        trace.delay->spec, loss, n, median.wall, rate, events_rate);
+                                if (single_rate > 0.0)
+                                        fprintf(out, "%.2f", rate / single_rate);
+                                fprintf(out, ",%ld,%lld,%lld\n", median.peak_rss_kb, (long long)median.output_bytes,
+                                        (long long)median.stdout_bytes);
+                                fflush(out);
+                        }
+                }
+        }
+
+        for (const packet_trace_t &trace : traces)
+                unlink(trace.path);
+        rmdir(tmp_dir);
+        if (out != stdout)
+                fclose(out);
+
+        return exit_status;
+}
@@ -7,17 +7,28 @@
  * SPDX-FileContributor: Elena Mostovaya (st169601@stud.uni-stuttgart.de)
  */
  
+#include "../controller/explicit_mpc.h"
+#include "../controller/gain_scheduled_lqr.h"
+#include "../controller/kalman_filter.h"
 #include "../controller/lqr.h"
+#include "../controller/packet_control.h"
 #include "../controller/pid.h"
+#include "../controller/state_predictor.h"
+#include "../controller/trigger.h"
 #include "../events/event.h"
 #include "../events/event_queue.h"
+#include "../events/event_trace.h"
 #include "../events/event_receiver.h"
 #include "../inverted_pendulum/inverted_pendulum.h"
+#include "../netutils/state_feed.h"
+#include "../utils/log.h"
 
 #include <cmath>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <unistd.h>
 
 // Mass of pendulum [kg]
@@ -50,25 +61,115 @@
                 -1.0000000000001679, -2.7126628569811633, 42.94618303488281, 5.411763498735041                         \
         }
 
+// Default parameters of event-triggered transmission
+#define PARAM_TRIGGER_THRESHOLD 0.01
+#define PARAM_TRIGGER_MAX_SILENCE 0.1
+
+// Default duration of one step of a control horizon [s]
+#define PARAM_HORIZON_STEP 0.001
+
+// Longest round-trip delay covered by the linear state predictor [s]
+#define PARAM_PREDICTOR_MAX_DELAY 0.1
+
+// Default noise model of the state estimator: sampling period [s],
+// process noise variances per period, and standard deviations of the
+// measured position [m] and angle [rad]
+#define PARAM_KALMAN_TS 0.001
+#define PARAM_KALMAN_Q {1e-10, 1e-6, 1e-10, 1e-5}
+#define PARAM_KALMAN_SIGMA_X 0.001
+#define PARAM_KALMAN_SIGMA_PHI 0.001
+
+// Seed of the measurement noise
+#define PARAM_NOISE_SEED 1
+
+// Gain of the exponentially weighted moving average of the round-trip
+// time measured by the plant
+#define RTT_EWMA_GAIN 0.125
+
+// Default simulated time [s]
+#define PARAM_DURATION 60.0
+
 #define MAX_STR_LEN 1024
 
 char pathInputCSVFile[MAX_STR_LEN];
 char pathOutputCSVFile[MAX_STR_LEN];
+char liveFeedName[MAX_STR_LEN];
+
+// Live feed of the state to viewers (option -W).
+StateFeedPublisher liveFeed;
+
+// Binary trace of the events (option -E).
+char pathEventTrace[MAX_STR_LEN];
+EventTrace eventTrace;
+char pathMPCTable[MAX_STR_LEN];
+char pathGainTable[MAX_STR_LEN];
 
 int simNumber = 0;
 
+// Simulated time [s]
+double simDuration = PARAM_DURATION;
+
+TransmissionTrigger::Policy triggerPolicy = TransmissionTrigger::Policy::PERIODIC;
+double triggerThreshold = PARAM_TRIGGER_THRESHOLD;
+double triggerMaxSilence = PARAM_TRIGGER_MAX_SILENCE;
+
+unsigned int horizonLen = 0;
+double horizonStep = PARAM_HORIZON_STEP;
+
+bool delayCompensation = false;
+
+// Force limit of the actuator (0: unlimited) [N]
+double forceLimit = 0.0;
+
+// Initial angle of pendulum [rad]
+double initialAngle = PARAM_angle;
+
+// State estimation from measured position and angle.
+enum class Estimator { NONE, LINEAR, EXTENDED };
+Estimator estimator = Estimator::NONE;
+bool measurementNoise = false;
+double sigmaX = PARAM_KALMAN_SIGMA_X;
+double sigmaPhi = PARAM_KALMAN_SIGMA_PHI;
+
 /**
  * Print usage information for the command line arguments.
  */
 void usage(const char *progname)
 {
         fprintf(stderr,
-                "Usage: %s -i <input.csv> -o <output.csv> -n <sim_number>\n"
+                "Usage: %s -i <input.csv> -o <output.csv> -n <sim_number> [-T <policy>] [-e <threshold>] [-m "
+                "<max_silence>] [-H <horizon> [-h <step>]] [-D] [-M <table>] [-G <table>] [-U <limit>] [-a <angle>] [-K <estimator>] [-N "
+                "<sigma_x>,<sigma_phi>] [-W <name>] [-t <duration>] [-E <trace>] [-L <level>]\n"
                 "Options:\n"
                 "  -i <input.csv>     Path to the input CSV file.\n"
                 "  -o <output.csv>    Path to the output CSV file.\n"
-                "  -n <sim_number>    Simulation number (integer). Select a simulation 1 (PID) or 2 (LQR).\n",
-                progname);
+                "  -n <sim_number>    Simulation number (integer). Select a simulation 1 (PID), 2 (LQR), or 3 (explicit\n"
+                "                     MPC).\n"
+                "  -T <policy>        Transmission policy of the plant: periodic (default), delta, lyapunov, or "
+                "self.\n"
+                "  -e <threshold>     Threshold of the transmission policy (default: %g).\n"
+                "  -m <max_silence>   Maximum time between two transmissions in seconds (default: %g).\n"
+                "  -H <horizon>       LQR only: controller sends horizon of <horizon> predicted control values, plant\n"
+                "                     applies the value matching the current time.\n"
+                "  -h <step>          Duration of one horizon step in seconds (default: %g).\n"
+                "  -D                 LQR only: controller predicts the state over the round-trip time measured by\n"
+                "                     the plant before computing the update.\n"
+                "  -M <table>         Region table of the explicit MPC (written by mpc-generate).\n"
+                "  -G <table>         LQR only: gain table of the gain-scheduled LQR (written by lqr-generate).\n"
+                "  -U <limit>         Force limit of the actuator in N (default: unlimited; MPC: limit of table).\n"
+                "  -a <angle>         Initial angle of the pendulum in rad (default: %g).\n"
+                "  -K <estimator>     LQR only: controller estimates the state from position and angle with a\n"
+                "                     Kalman filter: linear or extended.\n"
+                "  -N <sx>,<sphi>     Add Gaussian noise with standard deviations <sx> (m) and <sphi> (rad) to the\n"
+                "                     position and angle seen by the controller (also noise model of -K; default: "
+                "%g,%g).\n"
+                "  -W <name>          Publish the pendulum state to the live feed <name> (see visualization -w).\n"
+                "  -t <duration>      Simulated time in seconds (default: %g).\n"
+                "  -E <trace>         Write a binary trace of the events to <trace> (see event-trace-dump).\n"
+                "  -L <level>         Log level: off, error, warn (default), info, debug, or trace (every event;\n"
+                "                     requires LOG_COMPILE_LEVEL trace).\n",
+                progname, PARAM_TRIGGER_THRESHOLD, PARAM_TRIGGER_MAX_SILENCE, PARAM_HORIZON_STEP, PARAM_angle,
+                PARAM_KALMAN_SIGMA_X, PARAM_KALMAN_SIGMA_PHI, PARAM_DURATION);
 }
 
 /**
@@ -80,8 +181,12 @@ int parse_cmdline_args(int argc, char *argv[])
         int opt;
 
         memset(pathInputCSVFile, 0, MAX_STR_LEN);
+        memset(liveFeedName, 0, MAX_STR_LEN);
+        memset(pathEventTrace, 0, MAX_STR_LEN);
+        memset(pathMPCTable, 0, MAX_STR_LEN);
+        memset(pathGainTable, 0, MAX_STR_LEN);
 
-        while ((opt = getopt(argc, argv, "i:o:n:")) != -1) {
+        while ((opt = getopt(argc, argv, "i:o:n:T:e:m:H:h:DM:G:U:a:K:N:W:t:E:L:")) != -1) {
                 switch (opt) {
                 case 'i':
                         strncpy(pathInputCSVFile, optarg, MAX_STR_LEN - 1);
@@ -92,6 +197,63 @@ int parse_cmdline_args(int argc, char *argv[])
                 case 'n':
                         simNumber = atoi(optarg);
                         break;
+                case 'T':
+                        if (!TransmissionTrigger::parse_policy(optarg, triggerPolicy))
+                                return -1;
+                        break;
+                case 'e':
+                        triggerThreshold = atof(optarg);
+                        break;
+                case 'm':
+                        triggerMaxSilence = atof(optarg);
+                        break;
+                case 'H':
+                        horizonLen = atoi(optarg);
+                        break;
+                case 'h':
+                        horizonStep = atof(optarg);
+                        break;
+                case 'D':
+                        delayCompensation = true;
+                        break;
+                case 'M':
+                        strncpy(pathMPCTable, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'G':
+                        strncpy(pathGainTable, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'U':
+                        forceLimit = atof(optarg);
+                        break;
+                case 'a':
+                        initialAngle = atof(optarg);
+                        break;
+                case 'K':
+                        if (strcmp(optarg, "linear") == 0)
+                                estimator = Estimator::LINEAR;
+                        else if (strcmp(optarg, "extended") == 0)
+                                estimator = Estimator::EXTENDED;
+                        else
+                                return -1;
+                        break;
+                case 'N':
+                        if (sscanf(optarg, "%lf,%lf", &sigmaX, &sigmaPhi) != 2 || sigmaX < 0.0 || sigmaPhi < 0.0)
+                                return -1;
+                        measurementNoise = true;
+                        break;
+                case 'W':
+                        strncpy(liveFeedName, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 't':
+                        simDuration = atof(optarg);
+                        break;
+                case 'E':
+                        strncpy(pathEventTrace, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'L':
+                        if (!log_parse_level(optarg, log_level))
+                                return -1;
+                        break;
                 case ':':
                 case '?':
                 default:
@@ -99,12 +261,38 @@ int parse_cmdline_args(int argc, char *argv[])
                 }
         }
 
-        if (strlen(pathInputCSVFile) == 0 || strlen(pathOutputCSVFile) == 0)
+        if (strlen(pathInputCSVFile) == 0 || strlen(pathOutputCSVFile) == 0 || simDuration <= 0.0)
+                return -1;
+
+        if (horizonLen > HORIZON_MAX_LEN || horizonStep <= 0.0)
+                return -1;
+
+        // Horizons are relative to the sampling time.
+        if (delayCompensation && horizonLen > 0)
+                return -1;
+
+        if (simNumber == 3 && strlen(pathMPCTable) == 0)
+                return -1;
+
+        // Horizons are predicted with the fixed gain.
+        if (strlen(pathGainTable) > 0 && horizonLen > 0)
+                return -1;
+
+        if (forceLimit < 0.0)
                 return -1;
 
         return 0;
 }
 
+/**
+ * Publish the newest state to the live feed (if enabled).
+ */
+void publish_state(const state_sequence_t &states)
+{
+        if (liveFeed.is_open() && !states.empty())
+                liveFeed.publish(states.back().first, states.back().second);
+}
+
 void print_states_csv_to_file(const state_sequence_t &states, const std::string &filename)
 {
         std::ofstream out(filename);
@@ -130,6 +318,37 @@ void print_states_csv(const state_sequence_t &states)
         }
 }
 
+/**
+ * Print messages sent against quality of control (integral of squared
+ * angle and position error up to the end of the packet trace).
+ */
+void print_qoc(const state_sequence_t &states, const TransmissionTrigger &trigger, double untilTime)
+{
+        double ise_phi = 0.0;
+        double ise_x = 0.0;
+        for (size_t i = 1; i < states.size() && states[i].first <= untilTime; i++) {
+                double dt = states[i].first - states[i - 1].first;
+                ise_phi += states[i].second[2] * states[i].second[2] * dt;
+                ise_x += states[i].second[0] * states[i].second[0] * dt;
+        }
+
+        uint64_t total = trigger.sent() + trigger.suppressed();
+        printf("QoC: messages sent %lu of %lu (%.1f %%), ISE(phi) = %g rad^2*s, ISE(x) = %g m^2*s\n",
+               (unsigned long)trigger.sent(), (unsigned long)total, total > 0 ? 100.0 * trigger.sent() / total : 0.0,
+               ise_phi, ise_x);
+}
+
+/**
+ * Limit a control output to the force limit of the actuator.
+ */
+double saturate(double u)
+{
+        if (forceLimit > 0.0)
+                u = std::fmax(-forceLimit, std::fmin(forceLimit, u));
+
+        return u;
+}
+
 void simulate_pid(double untilTime)
 {
         /*
@@ -140,7 +359,7 @@ void simulate_pid(double untilTime)
          * [ phi ]
          * [omega]
          */
-        pendulum_state_t state_initial = {PARAM_x, PARAM_v, PARAM_angle, 0.0};
+        pendulum_state_t state_initial = {PARAM_x, PARAM_v, initialAngle, 0.0};
         InvertedPendulum pendulum = InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial);
         state_sequence_t states;
 
@@ -159,45 +378,57 @@ void simulate_pid(double untilTime)
         // If an update from the controller is available, update system input.
         // If no update is available, keep the old value of the system input.
         // Maybe, we have missed some updates, but we can always read the latest update.
-        pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber](const Event &e) {
+        TransmissionTrigger trigger(triggerPolicy, triggerThreshold, triggerMaxSilence);
+        bool transmit = false;
+
+        double tLastPacket = 0.0;
+
+        pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber, &trigger, &transmit,
+                           &tLastPacket](const Event &e) {
                 if (e.type == Event::Type::UPDATE) {
-                        printf("PLANT: update at %f, event %lu, f= %f\n", e.time, e.eventId, pendulum.get_force());
+                        eventTrace.record(EventTrace::PLANT_UPDATE, e, 0, pendulum.get_force());
                         pendulum.simulate(PARAM_DT, states);
+                        publish_state(states);
                 } else if (e.type == Event::Type::RECEIVE) {
-                        printf("PLANT: receive at %f, event %lu, SeqNr %lu\n", e.time, e.eventId, e.pktNr);
-                        if (e.pktNr >= currentRcvSeqNumber) {
-                                pendulum.set_force(u_vec[e.pktNr]);
+                        eventTrace.record(EventTrace::PLANT_RECEIVE, e, e.pktNr, 0.0);
+                        tLastPacket = e.time;
+                        // Suppressed transmissions have no update (NaN).
+                        if (e.pktNr >= currentRcvSeqNumber && e.pktNr < u_vec.size() && !std::isnan(u_vec[e.pktNr])) {
+                                pendulum.set_force(saturate(u_vec[e.pktNr]));
                                 currentRcvSeqNumber = e.pktNr;
                         }
                 } else if (e.type == Event::Type::SEND) {
                         ++nextSendSeqNumber;
-                        printf("PLANT: send at %f, event %lu. next seqNr: %lu\n", e.time, e.eventId, nextSendSeqNumber);
+                        transmit = !states.empty() && trigger.should_send(e.time, states.back().second);
+                        eventTrace.record(EventTrace::PLANT_SEND, e, nextSendSeqNumber, pendulum.get_force(),
+                                         transmit ? 0 : EventTrace::SUPPRESSED);
                 }
         };
 
-        pidCtrl.action = [&pendulum, &pidCtrl, &nextSendSeqNumber, &states, &u_vec](const Event &e) {
+        pidCtrl.action = [&pendulum, &pidCtrl, &nextSendSeqNumber, &states, &u_vec, &transmit](const Event &e) {
                 if (e.type == Event::Type::SEND) {
                         // Get pendulum angle, call controller, and set force to cart.
-                        if (!states.empty() && e.pktNr == nextSendSeqNumber - 1) {
+                        if (!states.empty() && e.pktNr == nextSendSeqNumber - 1 && !transmit) {
+                                u_vec.push_back(NAN);
+                        } else if (!states.empty() && e.pktNr == nextSendSeqNumber - 1) {
                                 double phi = states.back().second[2];
                                 double t = states.back().first;
                                 u_vec.push_back(-pidCtrl.control(PARAM_SETPOINT, phi, t));
-                                printf("CONTROLLER: compute next U = %f at %f, event %lu, pctNr: %lu\n", u_vec.back(),
-                                       e.time, e.eventId, e.pktNr);
+                                eventTrace.record(EventTrace::CONTROLLER_UPDATE, e, e.pktNr, u_vec.back());
                         } else if (!states.empty()) {
-                                printf("CONTROLLER: out-of-order packet, no update at %f, event %lu\n", e.time,
-                                       e.eventId);
+                                eventTrace.record(EventTrace::CONTROLLER_OUT_OF_ORDER, e, e.pktNr, 0.0);
                         }
                 }
         };
 
         // Make sure the order is correct
-        eventQueue.addReceiver(pendulum.action);
-        eventQueue.addReceiver(pidCtrl.action);
+        eventQueue.addReceiver(pendulum.action, "plant");
+        eventQueue.addReceiver(pidCtrl.action, "controller");
 
         eventQueue.run(untilTime);
 
         print_states_csv_to_file(states, pathOutputCSVFile);
+        print_qoc(states, trigger, tLastPacket);
 }
 
 void simulate_lqr(double untilTime)
@@ -210,11 +441,35 @@ void simulate_lqr(double untilTime)
          * [ phi ]
          * [omega]
          */
-        pendulum_state_t state_initial = {PARAM_x, PARAM_v, PARAM_angle, 0.0};
+        pendulum_state_t state_initial = {PARAM_x, PARAM_v, initialAngle, 0.0};
         InvertedPendulum pendulum = InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial);
         state_sequence_t states;
 
         LQRegulator lqr(LQR_K_ANGLE);
+        GainScheduledLQR scheduledLqr;
+        bool gainScheduling = (strlen(pathGainTable) > 0);
+        if (gainScheduling && !scheduledLqr.load(pathGainTable)) {
+                perror("Could not load gain table");
+                exit(1);
+        }
+        HorizonPredictor predictor(PARAM_m, PARAM_M, PARAM_I, PARAM_l, LQR_K_ANGLE, horizonStep);
+
+        // The noise model of the estimator needs non-zero measurement
+        // noise.
+        std::unique_ptr<KalmanFilter> kalman;
+        if (estimator != Estimator::NONE) {
+                KalmanSettings settings = {PARAM_KALMAN_TS, PARAM_KALMAN_Q, std::fmax(sigmaX * sigmaX, 1e-12),
+                                           std::fmax(sigmaPhi * sigmaPhi, 1e-12)};
+                kalman.reset(new KalmanFilter(PARAM_m, PARAM_M, PARAM_I, PARAM_l, settings,
+                                              estimator == Estimator::EXTENDED));
+                if (!kalman->valid()) {
+                        fprintf(stderr, "Kalman filter has no steady-state gain.\n");
+                        exit(1);
+                }
+        }
+        std::mt19937 noiseRng(PARAM_NOISE_SEED);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        StatePredictor statePredictor(PARAM_m, PARAM_M, PARAM_I, PARAM_l, LQR_K_ANGLE, PARAM_PREDICTOR_MAX_DELAY);
 
         // Initialize the queue with events from a CSV file.
         // Schedule periodic update events.
@@ -223,49 +478,215 @@ void simulate_lqr(double untilTime)
         vector<double> u_vec = {};
         u_vec.push_back(0.0);
 
+        // Packet-based control: horizon per packet (same indices as u_vec)
+        // and the plant's buffer of the newest received horizon.
+        vector<vector<double>> horizons = {{}};
+        vector<double> horizonSampleTimes = {0.0};
+        HorizonBuffer horizonBuffer;
+
+        // Smoothed round-trip time measured by the plant (send time of a
+        // packet until reception of its update), reported with the state.
+        vector<double> sendTimes;
+        double srtt = NAN;
+
         unsigned long nextSendSeqNumber = 0;
         unsigned long currentRcvSeqNumber = 0;
 
         // If an update from the controller is available, update system input.
         // If no update is available, keep the old value of the system input.
         // Maybe, we have missed some updates, but we can always read the latest update.
-        pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber](const Event &e) {
+        TransmissionTrigger trigger(triggerPolicy, triggerThreshold, triggerMaxSilence);
+        bool transmit = false;
+
+        double tLastPacket = 0.0;
+
+        pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber, &trigger, &transmit,
+                           &tLastPacket, &horizons, &horizonSampleTimes, &horizonBuffer, &sendTimes,
+                           &srtt](const Event &e) {
                 if (e.type == Event::Type::UPDATE) {
-                        printf("PLANT: update at %f, event %lu, f= %f\n", e.time, e.eventId, pendulum.get_force());
+                        // Apply the buffered control value matching the current time.
+                        if (horizonBuffer.valid())
+                                pendulum.set_force(saturate(horizonBuffer.value(e.time)));
+                        eventTrace.record(EventTrace::PLANT_UPDATE, e, 0, pendulum.get_force());
                         pendulum.simulate(PARAM_DT, states);
+                        publish_state(states);
                 } else if (e.type == Event::Type::RECEIVE) {
-                        printf("PLANT: receive at %f, event %lu, seqNr %lu\n", e.time, e.eventId, e.pktNr);
-                        if (e.pktNr >= currentRcvSeqNumber) {
-                                pendulum.set_force(u_vec[e.pktNr]);
+                        eventTrace.record(EventTrace::PLANT_RECEIVE, e, e.pktNr, 0.0);
+                        tLastPacket = e.time;
+                        if (e.pktNr < sendTimes.size() && !std::isnan(sendTimes[e.pktNr])) {
+                                double rtt = e.time - sendTimes[e.pktNr];
+                                srtt = std::isnan(srtt) ? rtt : srtt + RTT_EWMA_GAIN * (rtt - srtt);
+                        }
+                        // Suppressed transmissions have no update (NaN).
+                        if (horizonLen > 0) {
+                                // The buffer ignores horizons older than the buffered one.
+                                if (e.pktNr < horizons.size() && !horizons[e.pktNr].empty()) {
+                                        horizonBuffer.received(horizonSampleTimes[e.pktNr], horizonStep,
+                                                               horizons[e.pktNr].data(), horizons[e.pktNr].size());
+                                        pendulum.set_force(saturate(horizonBuffer.value(e.time)));
+                                }
+                        } else if (e.pktNr >= currentRcvSeqNumber && e.pktNr < u_vec.size() &&
+                                   !std::isnan(u_vec[e.pktNr])) {
+                                pendulum.set_force(saturate(u_vec[e.pktNr]));
                                 currentRcvSeqNumber = e.pktNr;
                         }
                 } else if (e.type == Event::Type::SEND) {
                         ++nextSendSeqNumber;
-                        printf("PLANT: send at %f, event %lu. next seqNr: %lu\n", e.time, e.eventId, nextSendSeqNumber);
+                        if (e.pktNr >= sendTimes.size())
+                                sendTimes.resize(e.pktNr + 1, NAN);
+                        sendTimes[e.pktNr] = e.time;
+                        transmit = !states.empty() && trigger.should_send(e.time, states.back().second);
+                        eventTrace.record(EventTrace::PLANT_SEND, e, nextSendSeqNumber, pendulum.get_force(),
+                                         transmit ? 0 : EventTrace::SUPPRESSED);
                 }
         };
 
-        lqr.action = [&pendulum, &lqr, &nextSendSeqNumber, &states, &u_vec](const Event &e) {
+        lqr.action = [&pendulum, &lqr, &scheduledLqr, gainScheduling, &nextSendSeqNumber, &states, &u_vec, &transmit,
+                      &predictor, &horizons, &horizonSampleTimes, &statePredictor, &srtt, &kalman, &noiseRng,
+                      &noise](const Event &e) {
                 if (e.type == Event::Type::SEND) {
                         // Get pendulum angle, call controller, and set force to cart.
-                        if (!states.empty() && e.pktNr == nextSendSeqNumber - 1) {
-                                u_vec.push_back(lqr.control(states.back().second));
-                                printf("CONTROLLER: compute next U = %f at %f, event %lu, pctNr: %lu\n", u_vec.back(),
-                                       e.time, e.eventId, e.pktNr);
+                        if (!states.empty() && e.pktNr == nextSendSeqNumber - 1 && !transmit) {
+                                u_vec.push_back(NAN);
+                                horizons.push_back({});
+                                horizonSampleTimes.push_back(NAN);
+                        } else if (!states.empty() && e.pktNr == nextSendSeqNumber - 1) {
+                                // Measured state, or estimate from the measured position and angle.
+                                pendulum_state_t state = states.back().second;
+                                if (measurementNoise) {
+                                        state[0] += sigmaX * noise(noiseRng);
+                                        state[2] += sigmaPhi * noise(noiseRng);
+                                }
+                                if (kalman)
+                                        state = kalman->update(states.back().first, state[0], state[2]);
+                                if (horizonLen > 0) {
+                                        // Predict with the plant model and send a horizon.
+                                        vector<double> h(horizonLen);
+                                        predictor.predict(state, h.data(), horizonLen);
+                                        horizons.push_back(h);
+                                        horizonSampleTimes.push_back(states.back().first);
+                                        u_vec.push_back(h[0]);
+                                } else {
+                                        horizons.push_back({});
+                                        horizonSampleTimes.push_back(NAN);
+                                        // Predict the state at the arrival time of the update.
+                                        if (delayCompensation && !std::isnan(srtt))
+                                                state = statePredictor.predict(state, srtt);
+                                        u_vec.push_back(gainScheduling ? scheduledLqr.control(state)
+                                                                       : lqr.control(state));
+                                }
+                                if (kalman)
+                                        kalman->input(u_vec.back());
+                                eventTrace.record(EventTrace::CONTROLLER_UPDATE, e, e.pktNr, u_vec.back());
                         } else if (!states.empty()) {
-                                printf("CONTROLLER: out-of-order packet, no update at %f, event %lu\n", e.time,
-                                       e.eventId);
+                                eventTrace.record(EventTrace::CONTROLLER_OUT_OF_ORDER, e, e.pktNr, 0.0);
                         }
                 }
         };
 
         // Make sure the order is correct
-        eventQueue.addReceiver(pendulum.action);
-        eventQueue.addReceiver(lqr.action);
+        eventQueue.addReceiver(pendulum.action, "plant");
+        eventQueue.addReceiver(lqr.action, "controller");
 
         eventQueue.run(untilTime);
 
         print_states_csv_to_file(states, pathOutputCSVFile);
+        print_qoc(states, trigger, tLastPacket);
+        if (kalman)
+                printf("Estimator: %lu out-of-sequence measurements, %lu dropped\n",
+                       (unsigned long)kalman->reordered(), (unsigned long)kalman->dropped());
+        if (gainScheduling)
+                printf("Gain scheduling: %zu grid points, %lu lookups outside the grid\n",
+                       scheduledLqr.grid_points(), (unsigned long)scheduledLqr.clamped());
+}
+
+void simulate_mpc(double untilTime)
+{
+        /*
+         * Initial pendulum state vector:
+         *
+         * [  x  ]
+         * [  v  ]
+         * [ phi ]
+         * [omega]
+         */
+        pendulum_state_t state_initial = {PARAM_x, PARAM_v, initialAngle, 0.0};
+        InvertedPendulum pendulum = InvertedPendulum(PARAM_m, PARAM_M, PARAM_I, PARAM_l, 0.0, state_initial);
+        state_sequence_t states;
+
+        ExplicitMPC mpc;
+        if (!mpc.load(pathMPCTable)) {
+                perror("Could not load MPC region table");
+                exit(1);
+        }
+        // The actuator has (at least) the limit the MPC was designed for.
+        if (forceLimit == 0.0)
+                forceLimit = mpc.force_limit();
+
+        // Initialize the queue with events from a CSV file.
+        // Schedule periodic update events.
+        EventQueue eventQueue = EventQueue(pathInputCSVFile, PARAM_DT);
+
+        vector<double> u_vec = {};
+        u_vec.push_back(0.0);
+
+        unsigned long nextSendSeqNumber = 0;
+        unsigned long currentRcvSeqNumber = 0;
+
+        // If an update from the controller is available, update system input.
+        // If no update is available, keep the old value of the system input.
+        // Maybe, we have missed some updates, but we can always read the latest update.
+        TransmissionTrigger trigger(triggerPolicy, triggerThreshold, triggerMaxSilence);
+        bool transmit = false;
+
+        double tLastPacket = 0.0;
+
+        pendulum.action = [&pendulum, &u_vec, &states, &nextSendSeqNumber, &currentRcvSeqNumber, &trigger, &transmit,
+                           &tLastPacket](const Event &e) {
+                if (e.type == Event::Type::UPDATE) {
+                        eventTrace.record(EventTrace::PLANT_UPDATE, e, 0, pendulum.get_force());
+                        pendulum.simulate(PARAM_DT, states);
+                        publish_state(states);
+                } else if (e.type == Event::Type::RECEIVE) {
+                        eventTrace.record(EventTrace::PLANT_RECEIVE, e, e.pktNr, 0.0);
+                        tLastPacket = e.time;
+                        // Suppressed transmissions have no update (NaN).
+                        if (e.pktNr >= currentRcvSeqNumber && e.pktNr < u_vec.size() && !std::isnan(u_vec[e.pktNr])) {
+                                pendulum.set_force(saturate(u_vec[e.pktNr]));
+                                currentRcvSeqNumber = e.pktNr;
+                        }
+                } else if (e.type == Event::Type::SEND) {
+                        ++nextSendSeqNumber;
+                        transmit = !states.empty() && trigger.should_send(e.time, states.back().second);
+                        eventTrace.record(EventTrace::PLANT_SEND, e, nextSendSeqNumber, pendulum.get_force(),
+                                         transmit ? 0 : EventTrace::SUPPRESSED);
+                }
+        };
+
+        mpc.action = [&mpc, &nextSendSeqNumber, &states, &u_vec, &transmit](const Event &e) {
+                if (e.type == Event::Type::SEND) {
+                        // Get pendulum state, evaluate control law, and set force to cart.
+                        if (!states.empty() && e.pktNr == nextSendSeqNumber - 1 && !transmit) {
+                                u_vec.push_back(NAN);
+                        } else if (!states.empty() && e.pktNr == nextSendSeqNumber - 1) {
+                                u_vec.push_back(mpc.control(states.back().second));
+                                eventTrace.record(EventTrace::CONTROLLER_UPDATE, e, e.pktNr, u_vec.back());
+                        } else if (!states.empty()) {
+                                eventTrace.record(EventTrace::CONTROLLER_OUT_OF_ORDER, e, e.pktNr, 0.0);
+                        }
+                }
+        };
+
+        // Make sure the order is correct
+        eventQueue.addReceiver(pendulum.action, "plant");
+        eventQueue.addReceiver(mpc.action, "controller");
+
+        eventQueue.run(untilTime);
+
+        print_states_csv_to_file(states, pathOutputCSVFile);
+        print_qoc(states, trigger, tLastPacket);
+        printf("MPC: %zu regions, %lu lookups outside tree candidates, %lu outside all regions\n", mpc.regions(),
+               (unsigned long)mpc.tree_misses(), (unsigned long)mpc.region_misses());
 }
 
 int main(int argc, char *argv[])
@@ -275,19 +696,37 @@ int main(int argc, char *argv[])
                 exit(1);
         }
 
+        if (strlen(liveFeedName) > 0 && !liveFeed.open(liveFeedName)) {
+                perror("Could not create live feed");
+                exit(1);
+        }
+
+        if (strlen(pathEventTrace) > 0 && !eventTrace.open(pathEventTrace)) {
+                perror("Could not open event trace");
+                exit(1);
+        }
+
         switch (simNumber) {
         case 1:
-                simulate_pid(60.0);
+                simulate_pid(simDuration);
                 break;
         case 2:
-                simulate_lqr(60.0);
+                simulate_lqr(simDuration);
+                break;
+        case 3:
+                simulate_mpc(simDuration);
                 break;
         default:
-                std::cout << "Select a simulation 1 (PID) or 2 (LQR)." << std::endl;
+                std::cout << "Select a simulation 1 (PID), 2 (LQR), or 3 (MPC)." << std::endl;
                 return -1;
         }
 
-        std::cout << "Simulation finished." << std::endl;
+        if (!eventTrace.close()) {
+                perror("Could not write event trace");
+                exit(1);
+        }
+
+        LOG_INFO("Simulation finished.\n");
 
         return 0;
 }
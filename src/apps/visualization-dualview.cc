@@ -33,15 +33,18 @@
  */
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <array>
-#include <boost/tokenizer.hpp>
 #include <cmath>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <unistd.h>
 #include <vector>
 
 #include "../inverted_pendulum/inverted_pendulum.h"
+#include "../visualization/live_follow.h"
+#include "../visualization/playback_control.h"
+#include "../visualization/state_trace.h"
 
 #define FRAME_RATE 30
 
@@ -49,6 +52,8 @@
 
 char pathCSVFile1[MAX_STR_LEN];
 char pathCSVFile2[MAX_STR_LEN];
+char liveFeedName1[MAX_STR_LEN];
+char liveFeedName2[MAX_STR_LEN];
 
 const float visoffset = 350;
 
@@ -62,8 +67,10 @@ int parse_cmdline_args(int argc, char *argv[])
 
         memset(pathCSVFile1, 0, MAX_STR_LEN);
         memset(pathCSVFile2, 0, MAX_STR_LEN);
+        memset(liveFeedName1, 0, MAX_STR_LEN);
+        memset(liveFeedName2, 0, MAX_STR_LEN);
 
-        while ((opt = getopt(argc, argv, "f:F:")) != -1) {
+        while ((opt = getopt(argc, argv, "f:F:w:W:")) != -1) {
                 switch (opt) {
                 case 'f':
                         strncpy(pathCSVFile1, optarg, MAX_STR_LEN - 1);
@@ -71,6 +78,12 @@ int parse_cmdline_args(int argc, char *argv[])
                 case 'F':
                         strncpy(pathCSVFile2, optarg, MAX_STR_LEN - 1);
                         break;
+                case 'w':
+                        strncpy(liveFeedName1, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'W':
+                        strncpy(liveFeedName2, optarg, MAX_STR_LEN - 1);
+                        break;
                 case ':':
                 case '?':
                 default:
@@ -78,70 +91,15 @@ int parse_cmdline_args(int argc, char *argv[])
                 }
         }
 
-        if (strlen(pathCSVFile1) == 0 || strlen(pathCSVFile2) == 0)
+        // Either two trace files or two live feeds.
+        int files = (strlen(pathCSVFile1) > 0) + (strlen(pathCSVFile2) > 0);
+        int feeds = (strlen(liveFeedName1) > 0) + (strlen(liveFeedName2) > 0);
+        if (!((files == 2 && feeds == 0) || (files == 0 && feeds == 2)))
                 return -1;
 
         return 0;
 }
 
-bool read_states(const char *path, state_sequence_t &states_vis)
-{
-        std::ifstream infile(path);
-
-        if (!infile.is_open()) {
-                perror("Could not open states file");
-                return -1;
-        }
-
-        std::string line;
-        while (std::getline(infile, line)) {
-                // Ignore empty lines with no characters
-                if (line.empty())
-                        continue;
-                // Ignore lines starting with #
-                if (line.rfind("#", 0) == 0)
-                        continue;
-                boost::char_separator<char> sep(",");
-                boost::tokenizer<boost::char_separator<char>> tokens(line, sep);
-                unsigned int token_cnt = 0;
-                time_state_t time_state;
-                for (const auto &token : tokens) {
-                        double d = strtod(token.c_str(), NULL);
-                        if (token_cnt == 0) {
-                                time_state.first = d;
-                        } else {
-                                time_state.second[token_cnt - 1] = d;
-                        }
-                        token_cnt++;
-                        if (token_cnt > 5) {
-                                std::cerr << "Too many tokens in line: " << line << std::endl;
-                                return false;
-                        }
-                }
-                if (token_cnt < 5) {
-                        std::cerr << "Too few tokens" << std::endl;
-                        return false;
-                }
-                assert(token_cnt == 5);
-                states_vis.push_back(time_state);
-        }
-
-        return true;
-}
-
-void prepare_states_vis(const state_sequence_t &states, state_sequence_t &states_vis)
-{
-        double period = 1.0 / FRAME_RATE;
-        double t = 0.0;
-
-        for (time_state_t time_state : states) {
-                if (time_state.first > t) {
-                        states_vis.push_back(time_state);
-                        t += period;
-                }
-        }
-}
-
 double to_deg(float rad)
 {
         return rad * (180.0 / M_PI);
@@ -154,21 +112,25 @@ int main(int argc, char *argv[])
                 exit(1);
         }
 
-        state_sequence_t states1;
-        state_sequence_t states2;
-        state_sequence_t states_vis1;
-        state_sequence_t states_vis2;
-
-        if (!read_states(pathCSVFile1, states1)) {
-                exit(1);
-        }
-        prepare_states_vis(states1, states_vis1);
-        if (!read_states(pathCSVFile2, states2)) {
+        // Frames are decoded from the mapped traces on demand, or taken
+        // from the live feeds of two running simulations.
+        bool live = (strlen(liveFeedName1) > 0);
+        StateTrace trace1;
+        StateTrace trace2;
+        LiveFollow feed1;
+        LiveFollow feed2;
+        if (live) {
+                if (!feed1.open(liveFeedName1) || !feed2.open(liveFeedName2)) {
+                        perror("Could not open live feed");
+                        exit(1);
+                }
+        } else if (!trace1.open(pathCSVFile1) || !trace2.open(pathCSVFile2)) {
+                perror("Could not open states file");
                 exit(1);
         }
-        prepare_states_vis(states2, states_vis2);
 
         sf::RenderWindow window(sf::VideoMode(1024, 480), "Inverted Pendulum");
+        window.setFramerateLimit(FRAME_RATE);
 
         // Load font
         sf::Font font;
@@ -225,47 +187,39 @@ int main(int argc, char *argv[])
         pole2.setOrigin(10.0F, 200.0F);
         pole2.setFillColor(brown);
 
-        // Create a clock to run the simulation
-        sf::Clock clock;
-
-        state_sequence_t::iterator it1 = states_vis1.begin();
-        state_sequence_t::iterator it2 = states_vis2.begin();
+        // Playback position, controlled with keyboard and mouse (not
+        // used when following live feeds).
+        PlaybackControl playback(std::min(trace1.start_time(), trace2.start_time()),
+                                 std::max(trace1.end_time(), trace2.end_time()), FRAME_RATE);
+        time_state_t time_state1(0.0, pendulum_state_t{0.0, 0.0, 0.0, 0.0});
+        time_state_t time_state2(0.0, pendulum_state_t{0.0, 0.0, 0.0, 0.0});
 
-        while (window.isOpen() && it1 != states_vis1.end() && it2 != states_vis2.end()) {
+        while (window.isOpen()) {
                 sf::Event event;
                 while (window.pollEvent(event)) {
                         switch (event.type) {
                         case sf::Event::Closed:
                                 window.close();
                                 break;
+                        default:
+                                if (!live)
+                                        playback.handle_event(event, window.getSize());
+                                break;
                         }
                 }
 
-                time_state_t time_state1 = *it1;
-                time_state_t time_state2 = *it2;
-                double tnext;
-                if (time_state1.first == time_state2.first) {
-                        it1++;
-                        it2++;
-                        tnext = time_state1.first;
-                } else if (time_state1.first < time_state2.first) {
-                        it1++;
-                        tnext = time_state1.first;
+                // States of both traces at the playback position, or
+                // newest states of the live feeds (the window limits the
+                // frame rate).
+                if (live) {
+                        feed1.update(time_state1);
+                        feed2.update(time_state2);
                 } else {
-                        it2++;
-                        tnext = time_state2.first;
+                        double t = playback.update();
+                        trace1.interpolate(t, time_state1);
+                        trace2.interpolate(t, time_state2);
                 }
 
-                // Wait until next frame is due.
-                sf::Time time;
-                uint64_t time_us;
-                uint64_t frame_time_us;
-                do {
-                        time = clock.getElapsedTime();
-                        time_us = time.asMicroseconds();
-                        frame_time_us = (uint64_t)(1000000.0 * tnext);
-                } while (time_us < frame_time_us);
-
                 // Update the simulation
 
                 float cart_x1 = time_state1.second[0];
@@ -292,6 +246,12 @@ int main(int argc, char *argv[])
                 window.draw(pole2);
                 window.draw(text1);
                 window.draw(text2);
+                if (live) {
+                        feed1.draw(window, font, 1);
+                        feed2.draw(window, font, 0);
+                } else {
+                        playback.draw(window, font);
+                }
                 window.display();
         }
 
@@ -0,0 +1,247 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "../visualization/pendulum_batch.h"
+#include "../visualization/playback_control.h"
+#include "../visualization/state_trace.h"
+
+#define FRAME_RATE 60
+
+#define WINDOW_WIDTH 1280
+#define WINDOW_HEIGHT 960
+
+// Space below the scenes for the progress bar and status line [px]
+#define CONTROL_HEIGHT 60
+
+// Alpha of the pendulums in the overlay view
+#define OVERLAY_ALPHA 0x60
+
+unsigned int columns = 0;
+bool overlay = false;
+std::vector<const char *> paths;
+
+/**
+ * Print usage information for the command line arguments.
+ */
+void usage(const char *progname)
+{
+        fprintf(stderr,
+                "Usage: %s [-c <columns>] [-o] <trace.csv>...\n"
+                "Options:\n"
+                "  -c <columns>       Number of columns of the grid (default: square grid)\n"
+                "  -o                 Overlay all pendulums in one scene instead of a grid\n"
+                "Traces are shown row by row in the order given.\n",
+                progname);
+}
+
+/**
+ * Parse command line arguments as passed to main() and store them in
+ * global variables.
+ */
+int parse_cmdline_args(int argc, char *argv[])
+{
+        int opt;
+
+        while ((opt = getopt(argc, argv, "c:o")) != -1) {
+                switch (opt) {
+                case 'c':
+                        columns = atoi(optarg);
+                        if (columns == 0)
+                                return -1;
+                        break;
+                case 'o':
+                        overlay = true;
+                        break;
+                case ':':
+                case '?':
+                default:
+                        return -1;
+                }
+        }
+
+        for (int i = optind; i < argc; i++)
+                paths.push_back(argv[i]);
+
+        if (paths.empty())
+                return -1;
+
+        return 0;
+}
+
+/**
+ * Open the traces in parallel threads (building the index of a trace
+ * reads scattered pages of the file).
+ *
+ * @return index of the first trace that could not be opened (errno is
+ * set); -1 on success.
+ */
+int open_traces(std::vector<StateTrace> &traces)
+{
+        std::vector<int> errors(traces.size(), 0);
+        std::atomic<size_t> next(0);
+        auto worker = [&traces, &errors, &next]() {
+                size_t i;
+                while ((i = next.fetch_add(1)) < traces.size()) {
+                        if (!traces[i].open(paths[i]))
+                                errors[i] = errno;
+                }
+        };
+
+        size_t n_threads = std::max(1U, std::thread::hardware_concurrency());
+        n_threads = std::min(n_threads, traces.size());
+        std::vector<std::thread> threads;
+        for (size_t k = 1; k < n_threads; k++)
+                threads.emplace_back(worker);
+        worker();
+        for (std::thread &thread : threads)
+                thread.join();
+
+        for (size_t i = 0; i < traces.size(); i++) {
+                if (errors[i] != 0) {
+                        errno = errors[i];
+                        return i;
+                }
+        }
+
+        return -1;
+}
+
+/**
+ * Distinct color of trace i of n for the overlay view.
+ */
+sf::Color trace_color(size_t i, size_t n, sf::Uint8 alpha)
+{
+        // Hue in [0, 300) degrees (red to magenta), full saturation.
+        double h = 5.0 * i / n;
+        int sector = (int)h;
+        double f = h - sector;
+        sf::Uint8 up = (sf::Uint8)(0xCC * f);
+        sf::Uint8 down = (sf::Uint8)(0xCC * (1.0 - f));
+        switch (sector) {
+        case 0:
+                return sf::Color(0xCC, up, 0, alpha);
+        case 1:
+                return sf::Color(down, 0xCC, 0, alpha);
+        case 2:
+                return sf::Color(0, 0xCC, up, alpha);
+        case 3:
+                return sf::Color(0, down, 0xCC, alpha);
+        default:
+                return sf::Color(up, 0, 0xCC, alpha);
+        }
+}
+
+int main(int argc, char *argv[])
+{
+        if (parse_cmdline_args(argc, argv) == -1) {
+                usage(argv[0]);
+                exit(1);
+        }
+
+        std::vector<StateTrace> traces(paths.size());
+        int failed = open_traces(traces);
+        if (failed != -1) {
+                fprintf(stderr, "%s: ", paths[failed]);
+                perror("Could not open states file");
+                exit(1);
+        }
+
+        double start = traces[0].start_time();
+        double end = traces[0].end_time();
+        for (const StateTrace &trace : traces) {
+                start = std::min(start, trace.start_time());
+                end = std::max(end, trace.end_time());
+        }
+
+        // Scenes of the pendulums (all the same in the overlay view).
+        size_t n = traces.size();
+        if (overlay)
+                columns = 1;
+        else if (columns == 0)
+                columns = std::ceil(std::sqrt((double)n));
+        size_t rows = overlay ? 1 : (n + columns - 1) / columns;
+        float cell_width = (float)WINDOW_WIDTH / columns;
+        float cell_height = (float)(WINDOW_HEIGHT - CONTROL_HEIGHT) / rows;
+        std::vector<scene_cell_t> cells(n);
+        for (size_t i = 0; i < n; i++) {
+                size_t k = overlay ? 0 : i;
+                cells[i] = {(k % columns) * cell_width, (k / columns) * cell_height, cell_width, cell_height};
+        }
+
+        const sf::Color light_grey = sf::Color(0xAA, 0xAA, 0xAA);
+        const sf::Color brown = sf::Color(0xCC, 0x99, 0x66);
+        std::vector<sf::Color> cart_colors(n, sf::Color::Black);
+        std::vector<sf::Color> pole_colors(n, brown);
+        if (overlay) {
+                for (size_t i = 0; i < n; i++) {
+                        cart_colors[i] = trace_color(i, n, OVERLAY_ALPHA);
+                        pole_colors[i] = cart_colors[i];
+                }
+        }
+
+        sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Inverted Pendulum");
+        window.setFramerateLimit(FRAME_RATE);
+
+        // Load font
+        sf::Font font;
+        if (!font.loadFromFile("/usr/share/fonts/truetype/freefont/FreeSansBold.ttf")) {
+                std::cerr << "Failed to load font!\n";
+        }
+
+        // Playback position, controlled with keyboard and mouse.
+        PlaybackControl playback(start, end, FRAME_RATE);
+
+        // Tracks, carts, and poles of all scenes, drawn with one call.
+        PendulumBatch batch;
+        std::vector<time_state_t> time_states(n, time_state_t(0.0, pendulum_state_t{0.0, 0.0, 0.0, 0.0}));
+
+        while (window.isOpen()) {
+                sf::Event event;
+                while (window.pollEvent(event)) {
+                        switch (event.type) {
+                        case sf::Event::Closed:
+                                window.close();
+                                break;
+                        default:
+                                playback.handle_event(event, window.getSize());
+                                break;
+                        }
+                }
+
+                // States of all traces at the playback position (the
+                // window limits the frame rate).
+                double t = playback.update();
+                batch.clear();
+                for (size_t i = 0; i < (overlay ? 1 : n); i++)
+                        batch.add_track(cells[i], light_grey);
+                for (size_t i = 0; i < n; i++) {
+                        traces[i].interpolate(t, time_states[i]);
+                        batch.add_pendulum(cells[i], time_states[i].second, cart_colors[i], pole_colors[i]);
+                }
+
+                window.clear(sf::Color::White);
+                batch.draw(window);
+                playback.draw(window, font);
+                window.display();
+        }
+
+        return 0;
+}
@@ -33,21 +33,95 @@
  */
 
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <array>
-#include <boost/tokenizer.hpp>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <cmath>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
 #include "../inverted_pendulum/inverted_pendulum.h"
+#include "../visualization/live_follow.h"
+#include "../visualization/pendulum_batch.h"
+#include "../visualization/playback_control.h"
+#include "../visualization/software_rasterizer.h"
+#include "../visualization/strip_charts.h"
+#include "../visualization/state_trace.h"
 
 #define FRAME_RATE 30
 
 #define MAX_STR_LEN 1024
 
+// Size of the window and of rendered frames [px]
+#define SCENE_WIDTH 1024
+#define SCENE_HEIGHT 480
+
+// Position of the strip charts (below the cart, above the progress bar)
+// [px] and time shown initially [s]
+#define CHARTS_TOP 400
+#define CHARTS_SPAN 10.0
+
+// Consecutive frames rendered by one thread (short forward steps in the
+// trace) and frames per thread buffered when streaming.
+#define RENDER_CHUNK 16
+
 char pathCSVFile[MAX_STR_LEN];
+char liveFeedName[MAX_STR_LEN];
+char renderPattern[MAX_STR_LEN];
+unsigned int renderRate = FRAME_RATE;
+unsigned int renderThreads = 0;
+bool showCharts = false;
+
+/**
+ * Print usage information for the command line arguments.
+ */
+void usage(const char *progname)
+{
+        fprintf(stderr,
+                "Usage: %s (-f <trace.csv> [-C] | -w <name>) [-R <pattern> [-r <rate>] [-j <threads>]]\n"
+                "Options:\n"
+                "  -f <trace.csv>     Play back a state trace\n"
+                "  -C                 Show strip charts of phi, x, and force (angular velocity if the\n"
+                "                     trace has no force; +/-: zoom)\n"
+                "  -w <name>          Follow the live feed <name> of a running simulation\n"
+                "  -R <pattern>       Render the frames of the trace without a window to image files\n"
+                "                     <pattern> with one %%d for the frame number (e.g., frame%%05d.png;\n"
+                "                     PNG, BMP, TGA, or JPG, or raw RGBA with extension .rgba), or as a\n"
+                "                     raw RGBA stream (%dx%d) to stdout with pattern -\n"
+                "  -r <rate>          Frames per second of the trace time rendered (default: %d)\n"
+                "  -j <threads>       Number of threads rendering frames (default: number of CPUs)\n",
+                progname, SCENE_WIDTH, SCENE_HEIGHT, FRAME_RATE);
+}
+
+/**
+ * Check that a file name pattern contains exactly one integer conversion
+ * (%d with optional flags and width) and no other conversions.
+ */
+bool valid_pattern(const char *pattern)
+{
+        int conversions = 0;
+        for (const char *p = pattern; *p != '\0'; p++) {
+                if (*p != '%')
+                        continue;
+                p++;
+                if (*p == '%')
+                        continue;
+                while (*p == '0' || *p == '-' || isdigit(*p))
+                        p++;
+                if (*p != 'd')
+                        return false;
+                conversions++;
+        }
+
+        return (conversions == 1);
+}
 
 /**
  * Parse command line arguments as passed to main() and store them in
@@ -58,12 +132,33 @@ int parse_cmdline_args(int argc, char *argv[])
         int opt;
 
         memset(pathCSVFile, 0, MAX_STR_LEN);
+        memset(liveFeedName, 0, MAX_STR_LEN);
+        memset(renderPattern, 0, MAX_STR_LEN);
 
-        while ((opt = getopt(argc, argv, "f:")) != -1) {
+        while ((opt = getopt(argc, argv, "f:w:R:r:j:C")) != -1) {
                 switch (opt) {
                 case 'f':
                         strncpy(pathCSVFile, optarg, MAX_STR_LEN - 1);
                         break;
+                case 'w':
+                        strncpy(liveFeedName, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'C':
+                        showCharts = true;
+                        break;
+                case 'R':
+                        strncpy(renderPattern, optarg, MAX_STR_LEN - 1);
+                        break;
+                case 'r':
+                        renderRate = atoi(optarg);
+                        if (renderRate == 0)
+                                return -1;
+                        break;
+                case 'j':
+                        renderThreads = atoi(optarg);
+                        if (renderThreads == 0)
+                                return -1;
+                        break;
                 case ':':
                 case '?':
                 default:
@@ -71,92 +166,185 @@ int parse_cmdline_args(int argc, char *argv[])
                 }
         }
 
-        if (strlen(pathCSVFile) == 0)
+        // Either a trace file or a live feed.
+        if ((strlen(pathCSVFile) == 0) == (strlen(liveFeedName) == 0))
                 return -1;
 
+        // Only recorded traces have charts and can be rendered.
+        if (showCharts && strlen(pathCSVFile) == 0)
+                return -1;
+        if (strlen(renderPattern) > 0) {
+                if (strlen(pathCSVFile) == 0)
+                        return -1;
+                if (strcmp(renderPattern, "-") != 0 && !valid_pattern(renderPattern))
+                        return -1;
+        }
+
         return 0;
 }
 
-bool read_states(const char *path, state_sequence_t &states_vis)
+double to_deg(float rad)
 {
-        std::ifstream infile(path);
+        return rad * (180.0 / M_PI);
+}
 
-        if (!infile.is_open()) {
-                perror("Could not open states file");
-                return -1;
+/**
+ * State of a thread rendering frames.
+ */
+struct render_worker_t {
+        // Each thread has its own position in the trace.
+        StateTrace trace;
+        PendulumBatch batch;
+        std::unique_ptr<SoftwareRasterizer> raster;
+};
+
+/**
+ * Render the frames of the trace without a window (option -R), in
+ * parallel threads. The scene is the one of the window, rasterized in
+ * software, so no OpenGL context and no display server are needed.
+ *
+ * @return exit status
+ */
+int render_frames()
+{
+        bool stream = (strcmp(renderPattern, "-") == 0);
+        size_t len = strlen(renderPattern);
+        bool raw = stream || (len > 5 && strcmp(renderPattern + len - 5, ".rgba") == 0);
+
+        unsigned int n_threads = renderThreads;
+        if (n_threads == 0)
+                n_threads = std::max(1U, std::thread::hardware_concurrency());
+        std::vector<std::unique_ptr<render_worker_t>> workers;
+        for (unsigned int k = 0; k < n_threads; k++) {
+                workers.emplace_back(new render_worker_t);
+                if (!workers.back()->trace.open(pathCSVFile)) {
+                        perror("Could not open states file");
+                        return 1;
+                }
+                workers.back()->raster.reset(new SoftwareRasterizer(SCENE_WIDTH, SCENE_HEIGHT));
         }
+        double start = workers[0]->trace.start_time();
+        double end = workers[0]->trace.end_time();
+        size_t n_frames = (size_t)std::floor((end - start) * renderRate) + 1;
 
-        std::string line;
-        while (std::getline(infile, line)) {
-                // Ignore empty lines with no characters
-                if (line.empty())
-                        continue;
-                // Ignore lines starting with #
-                if (line.rfind("#", 0) == 0)
-                        continue;
-                boost::char_separator<char> sep(",");
-                boost::tokenizer<boost::char_separator<char>> tokens(line, sep);
-                unsigned int token_cnt = 0;
-                time_state_t time_state;
-                for (const auto &token : tokens) {
-                        double d = strtod(token.c_str(), NULL);
-                        if (token_cnt == 0) {
-                                time_state.first = d;
-                        } else {
-                                time_state.second[token_cnt - 1] = d;
+        const scene_cell_t cell = {0.0F, 0.0F, (float)SCENE_WIDTH, (float)SCENE_HEIGHT};
+        const sf::Color light_grey = sf::Color(0xAA, 0xAA, 0xAA);
+        const sf::Color brown = sf::Color(0xCC, 0x99, 0x66);
+        const size_t frame_bytes = (size_t)SCENE_WIDTH * SCENE_HEIGHT * 4;
+
+        // Files are written by the threads; a stream is written in order
+        // by this thread after each batch of frames.
+        size_t batch_frames = stream ? (size_t)n_threads * RENDER_CHUNK : n_frames;
+        std::vector<std::vector<sf::Uint8>> buffers(stream ? batch_frames : 0,
+                                                    std::vector<sf::Uint8>(frame_bytes));
+        std::atomic<bool> failed(false);
+        int error = 0;
+        char error_path[MAX_STR_LEN] = "";
+
+        auto clock_start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < n_frames && !failed; first += batch_frames) {
+                size_t last = std::min(n_frames, first + batch_frames);
+                std::atomic<size_t> next(first);
+                auto render = [&](render_worker_t *w) {
+                        size_t chunk;
+                        while (!failed && (chunk = next.fetch_add(RENDER_CHUNK)) < last) {
+                                for (size_t f = chunk; f < std::min(last, chunk + RENDER_CHUNK); f++) {
+                                        time_state_t time_state(0.0, pendulum_state_t{0.0, 0.0, 0.0, 0.0});
+                                        w->trace.interpolate(start + (double)f / renderRate, time_state);
+                                        w->batch.clear();
+                                        w->batch.add_track(cell, light_grey);
+                                        w->batch.add_pendulum(cell, time_state.second, sf::Color::Black, brown);
+                                        w->raster->clear(sf::Color::White);
+                                        w->raster->draw(w->batch.triangles());
+                                        if (stream) {
+                                                memcpy(buffers[f - first].data(), w->raster->pixels(), frame_bytes);
+                                                continue;
+                                        }
+
+                                        char path[MAX_STR_LEN];
+                                        snprintf(path, sizeof(path), renderPattern, (int)f);
+                                        bool ok;
+                                        if (raw) {
+                                                FILE *file = fopen(path, "wb");
+                                                ok = (file != NULL);
+                                                if (ok) {
+                                                        ok = (fwrite(w->raster->pixels(), frame_bytes, 1, file) == 1);
+                                                        ok = (fclose(file) == 0) && ok;
+                                                }
+                                        } else {
+                                                sf::Image image;
+                                                image.create(SCENE_WIDTH, SCENE_HEIGHT, w->raster->pixels());
+                                                errno = 0;
+                                                ok = image.saveToFile(path);
+                                                if (!ok && errno == 0)
+                                                        errno = EIO;
+                                        }
+                                        bool expected = false;
+                                        if (!ok && failed.compare_exchange_strong(expected, true)) {
+                                                error = errno;
+                                                strcpy(error_path, path);
+                                        }
+                                }
                         }
-                        token_cnt++;
-                        if (token_cnt > 5) {
-                                std::cerr << "Too many tokens in line: " << line << std::endl;
-                                return false;
+                };
+
+                std::vector<std::thread> threads;
+                for (unsigned int k = 1; k < n_threads; k++)
+                        threads.emplace_back(render, workers[k].get());
+                render(workers[0].get());
+                for (std::thread &thread : threads)
+                        thread.join();
+
+                for (size_t f = first; stream && f < last; f++) {
+                        if (fwrite(buffers[f - first].data(), frame_bytes, 1, stdout) != 1) {
+                                perror("Could not write frame");
+                                return 1;
                         }
                 }
-                if (token_cnt < 5) {
-                        std::cerr << "Too few tokens" << std::endl;
-                        return false;
-                }
-                assert(token_cnt == 5);
-                states_vis.push_back(time_state);
         }
-
-        return true;
-}
-
-void prepare_states_vis(const state_sequence_t &states, state_sequence_t &states_vis)
-{
-        double period = 1.0 / FRAME_RATE;
-        double t = 0.0;
-
-        for (time_state_t time_state : states) {
-                if (time_state.first > t) {
-                        states_vis.push_back(time_state);
-                        t += period;
-                }
+        if (failed) {
+                errno = error;
+                fprintf(stderr, "%s: ", error_path);
+                perror("Could not write frame");
+                return 1;
         }
-}
 
-double to_deg(float rad)
-{
-        return rad * (180.0 / M_PI);
+        double seconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - clock_start).count();
+        fprintf(stderr, "Rendered %zu frames (%dx%d) in %.2f s with %u threads\n", n_frames, SCENE_WIDTH,
+                SCENE_HEIGHT, seconds, n_threads);
+
+        return 0;
 }
 
 int main(int argc, char *argv[])
 {
         if (parse_cmdline_args(argc, argv) == -1) {
-                // usage(argv[0]);
+                usage(argv[0]);
                 exit(1);
         }
 
-        state_sequence_t states;
-        state_sequence_t states_vis;
-
-        if (!read_states(pathCSVFile, states)) {
+        if (strlen(renderPattern) > 0)
+                return render_frames();
+
+        // Frames are decoded from the mapped trace on demand, or taken
+        // from the live feed of a running simulation.
+        bool live = (strlen(liveFeedName) > 0);
+        StateTrace trace;
+        LiveFollow feed;
+        if (live) {
+                if (!feed.open(liveFeedName)) {
+                        perror("Could not open live feed");
+                        exit(1);
+                }
+        } else if (!trace.open(pathCSVFile)) {
+                perror("Could not open states file");
                 exit(1);
         }
 
-        prepare_states_vis(states, states_vis);
-
-        sf::RenderWindow window(sf::VideoMode(1024, 480), "Inverted Pendulum");
+        unsigned int height = showCharts ? SCENE_HEIGHT + CHART_COUNT * CHART_HEIGHT : SCENE_HEIGHT;
+        sf::RenderWindow window(sf::VideoMode(SCENE_WIDTH, height), "Inverted Pendulum");
+        window.setFramerateLimit(FRAME_RATE);
 
         // Load font
         sf::Font font;
@@ -183,37 +371,41 @@ int main(int argc, char *argv[])
         const sf::Color brown = sf::Color(0xCC, 0x99, 0x66);
         pole.setFillColor(brown);
 
-        // Create a clock to run the simulation
-        sf::Clock clock;
+        // Playback position, controlled with keyboard and mouse (not
+        // used when following a live feed).
+        PlaybackControl playback(trace.start_time(), trace.end_time(), FRAME_RATE);
+        time_state_t time_state(0.0, pendulum_state_t{0.0, 0.0, 0.0, 0.0});
 
-        state_sequence_t::iterator it = states_vis.begin();
+        // Strip charts around the playback position.
+        StripCharts charts(CHARTS_TOP, CHARTS_SPAN);
+        if (showCharts)
+                charts.open(pathCSVFile);
 
-        while (window.isOpen() && it != states_vis.end()) {
+        while (window.isOpen()) {
                 sf::Event event;
                 while (window.pollEvent(event)) {
                         switch (event.type) {
                         case sf::Event::Closed:
                                 window.close();
                                 break;
+                        default:
+                                if (showCharts && charts.handle_event(event))
+                                        break;
+                                if (!live)
+                                        playback.handle_event(event, window.getSize());
+                                break;
                         }
                 }
 
-                time_state_t time_state = *it;
-                it++;
-
-                // Wait until next frame is due.
-                sf::Time time;
-                uint64_t time_us;
-                uint64_t frame_time_us;
-                do {
-                        time = clock.getElapsedTime();
-                        time_us = time.asMicroseconds();
-                        frame_time_us = (uint64_t)(1000000.0 * time_state.first);
-                } while (time_us < frame_time_us);
-
-                // Update the simulation
-                float time_sec = time.asSeconds();
-                std::string msg = std::to_string(time_sec);
+                // State of the trace at the playback position, or newest
+                // state of the live feed (the window limits the frame
+                // rate).
+                if (live) {
+                        feed.update(time_state);
+                } else {
+                        double t = playback.update();
+                        trace.interpolate(t, time_state);
+                }
 
                 float cart_x = time_state.second[0];
                 float pole_angle_deg = to_deg(time_state.second[2]);
@@ -227,6 +419,12 @@ int main(int argc, char *argv[])
                 window.draw(track);
                 window.draw(cart);
                 window.draw(pole);
+                if (showCharts)
+                        charts.draw(window, font, playback.time());
+                if (live)
+                        feed.draw(window, font);
+                else
+                        playback.draw(window, font);
                 window.display();
         }
 
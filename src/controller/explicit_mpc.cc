@@ -0,0 +1,194 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "explicit_mpc.h"
+
+#include <cmath>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Tolerance of the region test (states on a common facet belong to both
+// regions, which have the same control value there).
+#define REGION_TOLERANCE 1e-9
+
+// Maximum length of a keyword of the table file.
+#define MAX_KEYWORD_LEN 32
+
+ExplicitMPC::ExplicitMPC() : umax(0.0), K_lqr({0.0, 0.0, 0.0, 0.0}), n_tree_misses(0), n_region_misses(0)
+{
+}
+
+/**
+ * Read a keyword followed by a count from the table file.
+ */
+static bool read_section(FILE *f, const char *keyword, unsigned long &count)
+{
+        char word[MAX_KEYWORD_LEN + 1];
+
+        if (fscanf(f, "%32s %lu", word, &count) != 2)
+                return false;
+
+        return (strcmp(word, keyword) == 0);
+}
+
+bool ExplicitMPC::load(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        if (f == NULL)
+                return false;
+
+        // Skip comment lines.
+        int c;
+        while ((c = fgetc(f)) == '#') {
+                while ((c = fgetc(f)) != EOF && c != '\n')
+                        ;
+        }
+        if (c != EOF)
+                ungetc(c, f);
+
+        bool ok = true;
+        unsigned long horizon;
+        double Ts;
+        ok = ok && read_section(f, "mpc", horizon);
+        ok = ok && fscanf(f, "%lf %lf", &Ts, &umax) == 2;
+        char word[MAX_KEYWORD_LEN + 1];
+        ok = ok && fscanf(f, "%32s", word) == 1 && strcmp(word, "lqr") == 0;
+        for (int i = 0; ok && i < 4; i++)
+                ok = fscanf(f, "%lf", &K_lqr[i]) == 1;
+
+        unsigned long n_regions = 0;
+        ok = ok && read_section(f, "regions", n_regions);
+        region_table.clear();
+        rows.clear();
+        for (unsigned long r = 0; ok && r < n_regions; r++) {
+                Region region;
+                unsigned long n_rows;
+                ok = read_section(f, "region", n_rows);
+                for (int i = 0; ok && i < 4; i++)
+                        ok = fscanf(f, "%lf", &region.gain[i]) == 1;
+                ok = ok && fscanf(f, "%lf", &region.offset) == 1;
+                region.first_row = rows.size();
+                region.n_rows = n_rows;
+                for (unsigned long k = 0; ok && k < n_rows; k++) {
+                        halfspace_t row;
+                        for (int i = 0; ok && i < 5; i++)
+                                ok = fscanf(f, "%lf", &row[i]) == 1;
+                        rows.push_back(row);
+                }
+                region_table.push_back(region);
+        }
+
+        unsigned long n_nodes = 0;
+        ok = ok && read_section(f, "nodes", n_nodes);
+        nodes.clear();
+        for (unsigned long k = 0; ok && k < n_nodes; k++) {
+                Node node;
+                ok = fscanf(f, "%d %lf %u %u %u %u", &node.dim, &node.split, &node.left, &node.right, &node.first,
+                            &node.count) == 6;
+                nodes.push_back(node);
+        }
+
+        unsigned long n_candidates = 0;
+        ok = ok && read_section(f, "candidates", n_candidates);
+        candidates.clear();
+        for (unsigned long k = 0; ok && k < n_candidates; k++) {
+                uint32_t id;
+                ok = fscanf(f, "%u", &id) == 1 && id < region_table.size();
+                candidates.push_back(id);
+        }
+
+        // Check references of the tree. Children follow their parent (pre-order
+        // as written by mpc-generate), so a corrupt table cannot make control()
+        // loop forever.
+        for (size_t k = 0; ok && k < nodes.size(); k++) {
+                const Node &node = nodes[k];
+                if (node.dim >= 4 ||
+                    (node.dim >= 0 && (node.left <= k || node.right <= k || node.left >= nodes.size() ||
+                                       node.right >= nodes.size())) ||
+                    (node.dim < 0 && (size_t)node.first + node.count > candidates.size()))
+                        ok = false;
+        }
+        ok = ok && !nodes.empty() && !region_table.empty();
+
+        fclose(f);
+        if (!ok) {
+                region_table.clear();
+                nodes.clear();
+                errno = EINVAL;
+        }
+
+        return ok;
+}
+
+bool ExplicitMPC::contains(const Region &region, const pendulum_state_t &x) const
+{
+        const halfspace_t *row = &rows[region.first_row];
+        for (uint32_t k = 0; k < region.n_rows; k++, row++) {
+                const halfspace_t &h = *row;
+                if (h[0] * x[0] + h[1] * x[1] + h[2] * x[2] + h[3] * x[3] > h[4] + REGION_TOLERANCE)
+                        return false;
+        }
+
+        return true;
+}
+
+double ExplicitMPC::evaluate(const Region &region, const pendulum_state_t &x) const
+{
+        const pendulum_state_t &g = region.gain;
+        double u = g[0] * x[0] + g[1] * x[1] + g[2] * x[2] + g[3] * x[3] + region.offset;
+
+        // Only rounding can exceed the limit.
+        return std::fmax(-umax, std::fmin(umax, u));
+}
+
+double ExplicitMPC::control(const pendulum_state_t state)
+{
+        if (nodes.empty())
+                return 0.0;
+
+        const Node *node = &nodes[0];
+        while (node->dim >= 0)
+                node = &nodes[state[node->dim] < node->split ? node->left : node->right];
+        for (uint32_t k = 0; k < node->count; k++) {
+                const Region &region = region_table[candidates[node->first + k]];
+                if (contains(region, state))
+                        return evaluate(region, state);
+        }
+
+        n_tree_misses++;
+        for (const Region &region : region_table) {
+                if (contains(region, state))
+                        return evaluate(region, state);
+        }
+
+        n_region_misses++;
+        double u = -(K_lqr[0] * state[0] + K_lqr[1] * state[1] + K_lqr[2] * state[2] + K_lqr[3] * state[3]);
+
+        return std::fmax(-umax, std::fmin(umax, u));
+}
+
+double ExplicitMPC::force_limit() const
+{
+        return umax;
+}
+
+size_t ExplicitMPC::regions() const
+{
+        return region_table.size();
+}
+
+uint64_t ExplicitMPC::tree_misses() const
+{
+        return n_tree_misses;
+}
+
+uint64_t ExplicitMPC::region_misses() const
+{
+        return n_region_misses;
+}
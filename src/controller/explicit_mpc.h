@@ -0,0 +1,111 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef EXPLICIT_MPC_H
+#define EXPLICIT_MPC_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Explicit model predictive controller with force limit.
+ *
+ * The MPC problem (linearized pendulum, quadratic cost, |u| <= umax) is
+ * solved offline for all states by mpc-generate. The solution is a
+ * piecewise-affine control law: the state space is partitioned into
+ * polyhedral regions {x | A*x <= b}, each with an affine law u = g*x + h.
+ * At runtime, the region containing the state is located with a kd-tree
+ * whose leaves list the candidate regions of their cell, so evaluation
+ * costs a few comparisons and dot products.
+ *
+ * If no candidate of the leaf contains the state (e.g., the state lies
+ * outside the box explored offline), all regions are searched. If none
+ * contains the state, the saturated LQR law of the same cost is applied.
+ */
+class ExplicitMPC : public EventReceiver
+{
+      public:
+        ExplicitMPC();
+
+        /**
+         * Load a region table written by mpc-generate.
+         *
+         * @param path path of table file
+         * @return true on success; false on error (errno is set; EINVAL
+         * for malformed files).
+         */
+        bool load(const char *path);
+
+        /**
+         * Get control output.
+         *
+         * @param state state
+         * @return controller output u (|u| <= umax)
+         */
+        double control(const pendulum_state_t state);
+
+        /**
+         * Force limit of the table [N].
+         */
+        double force_limit() const;
+
+        /**
+         * Number of regions of the control law.
+         */
+        size_t regions() const;
+
+        /**
+         * Number of lookups that had to search all regions.
+         */
+        uint64_t tree_misses() const;
+
+        /**
+         * Number of lookups that found no region (saturated LQR applied).
+         */
+        uint64_t region_misses() const;
+
+      private:
+        // Row of the inequalities of a region: a*x <= b.
+        typedef std::array<double, 5> halfspace_t;
+
+        struct Region {
+                uint32_t first_row;
+                uint32_t n_rows;
+                pendulum_state_t gain;
+                double offset;
+        };
+
+        // Inner node (dim >= 0): left child for x[dim] < split, else right.
+        // Leaf (dim < 0): candidates[first..first+count-1].
+        struct Node {
+                int32_t dim;
+                double split;
+                uint32_t left;
+                uint32_t right;
+                uint32_t first;
+                uint32_t count;
+        };
+
+        bool contains(const Region &region, const pendulum_state_t &x) const;
+        double evaluate(const Region &region, const pendulum_state_t &x) const;
+
+        double umax;
+        pendulum_state_t K_lqr;
+        std::vector<Region> region_table;
+        std::vector<halfspace_t> rows;
+        std::vector<Node> nodes;
+        std::vector<uint32_t> candidates;
+
+        uint64_t n_tree_misses;
+        uint64_t n_region_misses;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "fallback_controller.h"
+
+FallbackController::FallbackController(const pendulum_state_t &K, Mode mode, uint64_t deadline_usec,
+                                       uint64_t max_extrapolation_usec)
+        : lqr(K), mode(mode), deadline_usec(deadline_usec), max_extrapolation_usec(max_extrapolation_usec),
+          local(false), n_updates(0), u_last(0.0), u_prev(0.0), t_sample_last_usec(0), t_sample_prev_usec(0),
+          t_arrival_last_usec(0)
+{
+}
+
+FallbackController::Switch FallbackController::received(uint64_t t_now_usec, uint64_t t_sample_usec, double u)
+{
+        // Ignore updates overtaken by updates of newer states.
+        if (n_updates > 0 && t_sample_usec <= t_sample_last_usec)
+                return Switch::NONE;
+
+        u_prev = u_last;
+        t_sample_prev_usec = t_sample_last_usec;
+        u_last = u;
+        t_sample_last_usec = t_sample_usec;
+        t_arrival_last_usec = t_now_usec;
+        if (n_updates < 2)
+                n_updates++;
+
+        if (local && age(t_now_usec) <= deadline_usec) {
+                local = false;
+                return Switch::TO_REMOTE;
+        }
+
+        return Switch::NONE;
+}
+
+double FallbackController::control(uint64_t t_now_usec, const pendulum_state_t &state, Switch &sw)
+{
+        sw = Switch::NONE;
+        if (!local && age(t_now_usec) > deadline_usec) {
+                local = true;
+                sw = Switch::TO_LOCAL;
+        }
+
+        if (!local)
+                return u_last;
+
+        if (mode == Mode::LQR || n_updates < 2)
+                return lqr.control(state);
+
+        return extrapolate(t_now_usec);
+}
+
+bool FallbackController::is_local() const
+{
+        return local;
+}
+
+uint64_t FallbackController::age(uint64_t t_now_usec) const
+{
+        // Before the first update, the plant is as old as the update.
+        return (t_now_usec > t_sample_last_usec) ? t_now_usec - t_sample_last_usec : 0;
+}
+
+double FallbackController::extrapolate(uint64_t t_now_usec) const
+{
+        if (t_sample_last_usec == t_sample_prev_usec)
+                return u_last;
+
+        double slope = (u_last - u_prev) / (double)(t_sample_last_usec - t_sample_prev_usec);
+        uint64_t dt_usec = t_now_usec - t_arrival_last_usec;
+        if (dt_usec > max_extrapolation_usec)
+                dt_usec = max_extrapolation_usec;
+
+        return u_last + slope * dt_usec;
+}
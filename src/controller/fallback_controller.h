@@ -0,0 +1,104 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef FALLBACK_CONTROLLER_H
+#define FALLBACK_CONTROLLER_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "lqr.h"
+
+#include <stdint.h>
+
+/**
+ * Plant-side guard against stale control updates.
+ *
+ * An update received from the remote controller is fresh as long as the
+ * state it was computed from (identified by the sampling time echoed by
+ * the controller) is not older than the staleness deadline. Without a
+ * fresh update, the plant switches to a local fallback, and switches back
+ * to the remote controller with the next fresh update.
+ *
+ * All times are plant clock times [us].
+ */
+class FallbackController
+{
+      public:
+        enum class Mode {
+                // Local LQR on the latest local state.
+                LQR,
+                // Linear extrapolation of the last two remote updates.
+                EXTRAPOLATE
+        };
+
+        enum class Switch {
+                NONE,
+                TO_LOCAL,
+                TO_REMOTE
+        };
+
+        /**
+         * @param K gain matrix of local LQR
+         * @param mode fallback mode
+         * @param deadline_usec staleness deadline [us]
+         * @param max_extrapolation_usec maximum time to extrapolate
+         * beyond the last update [us]; the extrapolated value is held
+         * afterwards.
+         */
+        FallbackController(const pendulum_state_t &K, Mode mode, uint64_t deadline_usec,
+                           uint64_t max_extrapolation_usec);
+
+        /**
+         * Process an update of the remote controller.
+         *
+         * @param t_now_usec arrival time
+         * @param t_sample_usec sampling time of the state the update was
+         * computed from
+         * @param u remote controller output
+         * @return switch caused by the update
+         */
+        Switch received(uint64_t t_now_usec, uint64_t t_sample_usec, double u);
+
+        /**
+         * Get the system input to apply now. Switches to the fallback if
+         * the last remote update became stale.
+         *
+         * @param t_now_usec current time
+         * @param state current local state
+         * @param sw receives the switch caused by this call
+         * @return system input
+         */
+        double control(uint64_t t_now_usec, const pendulum_state_t &state, Switch &sw);
+
+        /**
+         * Check whether the local fallback is active.
+         */
+        bool is_local() const;
+
+        /**
+         * Age of the last remote update at the given time [us].
+         */
+        uint64_t age(uint64_t t_now_usec) const;
+
+      private:
+        double extrapolate(uint64_t t_now_usec) const;
+
+        LQRegulator lqr;
+        const Mode mode;
+        const uint64_t deadline_usec;
+        const uint64_t max_extrapolation_usec;
+
+        bool local;
+        // Number of remote updates received (0, 1, or 2 = at least 2).
+        unsigned int n_updates;
+        // Last two remote updates.
+        double u_last, u_prev;
+        uint64_t t_sample_last_usec, t_sample_prev_usec;
+        uint64_t t_arrival_last_usec;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "gain_scheduled_lqr.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// Maximum length of a keyword of the table file.
+#define MAX_KEYWORD_LEN 32
+
+GainScheduledLQR::GainScheduledLQR()
+    : n_phi(0), n_omega(0), phi_max(0.0), omega_max(0.0), phi_scale(0.0), omega_scale(0.0), n_clamped(0)
+{
+}
+
+bool GainScheduledLQR::load(const char *path)
+{
+        FILE *f = fopen(path, "r");
+        if (f == NULL)
+                return false;
+
+        // Skip comment lines.
+        int c;
+        while ((c = fgetc(f)) == '#') {
+                while ((c = fgetc(f)) != EOF && c != '\n')
+                        ;
+        }
+        if (c != EOF)
+                ungetc(c, f);
+
+        char word[MAX_KEYWORD_LEN + 1];
+        bool ok = fscanf(f, "%32s %lu %lf %lu %lf", word, &n_phi, &phi_max, &n_omega, &omega_max) == 5 &&
+                  strcmp(word, "gains") == 0;
+        ok = ok && n_phi >= 2 && n_omega >= 2 && phi_max > 0.0 && omega_max > 0.0;
+
+        gains.clear();
+        if (ok)
+                gains.resize(n_phi * n_omega);
+        for (size_t k = 0; ok && k < gains.size(); k++) {
+                for (int i = 0; ok && i < 4; i++)
+                        ok = fscanf(f, "%lf", &gains[k][i]) == 1;
+        }
+
+        fclose(f);
+        if (!ok) {
+                gains.clear();
+                errno = EINVAL;
+                return false;
+        }
+
+        phi_scale = (n_phi - 1) / (2.0 * phi_max);
+        omega_scale = (n_omega - 1) / (2.0 * omega_max);
+
+        return true;
+}
+
+pendulum_state_t GainScheduledLQR::gain(double phi, double omega)
+{
+        // Continuous grid coordinates, clamped to the grid.
+        double fi = (phi + phi_max) * phi_scale;
+        double fj = (omega + omega_max) * omega_scale;
+        const double fi_max = n_phi - 1;
+        const double fj_max = n_omega - 1;
+        if (!(fi >= 0.0 && fi <= fi_max && fj >= 0.0 && fj <= fj_max)) {
+                n_clamped++;
+                fi = (fi > 0.0) ? (fi < fi_max ? fi : fi_max) : 0.0;
+                fj = (fj > 0.0) ? (fj < fj_max ? fj : fj_max) : 0.0;
+        }
+
+        // Lower corner of the cell (the last cell includes the border).
+        unsigned long i = (unsigned long)fi;
+        unsigned long j = (unsigned long)fj;
+        if (i > n_phi - 2)
+                i = n_phi - 2;
+        if (j > n_omega - 2)
+                j = n_omega - 2;
+        const double s = fi - i;
+        const double t = fj - j;
+
+        const pendulum_state_t *k0 = &gains[i * n_omega + j];
+        const pendulum_state_t *k1 = k0 + n_omega;
+        pendulum_state_t K;
+        for (int d = 0; d < 4; d++) {
+                double lo = k0[0][d] + t * (k0[1][d] - k0[0][d]);
+                double hi = k1[0][d] + t * (k1[1][d] - k1[0][d]);
+                K[d] = lo + s * (hi - lo);
+        }
+
+        return K;
+}
+
+double GainScheduledLQR::control(const pendulum_state_t state)
+{
+        if (gains.empty())
+                return 0.0;
+
+        const pendulum_state_t K = gain(state[2], state[3]);
+        double u = -(K[0] * state[0] + K[1] * state[1] + K[2] * state[2] + K[3] * state[3]);
+
+        return u;
+}
+
+size_t GainScheduledLQR::grid_points() const
+{
+        return gains.size();
+}
+
+uint64_t GainScheduledLQR::clamped() const
+{
+        return n_clamped;
+}
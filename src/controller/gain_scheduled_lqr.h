@@ -0,0 +1,88 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef GAIN_SCHEDULED_LQR_H
+#define GAIN_SCHEDULED_LQR_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Gain-scheduled LQR for large angles.
+ *
+ * The gain of LQRegulator is designed for the pendulum linearized at the
+ * upright position and loses stability margin as the angle grows. Here,
+ * the gain depends on the angle and angular velocity: lqr-generate solves
+ * the Riccati equation for the state-dependent coefficient model of the
+ * pendulum (see sdc_pendulum()) at each point of a regular grid of angles
+ * and angular velocities. At runtime, the gain is interpolated bilinearly
+ * between the four surrounding grid points and applied as u = -K(phi,
+ * omega)*x. The grid is stored as one contiguous array of gains (angle
+ * major), so a lookup costs two index computations and reads from two
+ * pairs of adjacent entries, independent of the size of the table.
+ *
+ * Outside the grid, the gain of the nearest border point is used.
+ */
+class GainScheduledLQR : public EventReceiver
+{
+      public:
+        GainScheduledLQR();
+
+        /**
+         * Load a gain table written by lqr-generate.
+         *
+         * @param path path of table file
+         * @return true on success; false on error (errno is set; EINVAL
+         * for malformed files).
+         */
+        bool load(const char *path);
+
+        /**
+         * Get control output.
+         *
+         * @param state state
+         * @return controller output u
+         */
+        double control(const pendulum_state_t state);
+
+        /**
+         * Interpolated gain.
+         *
+         * @param phi angle [rad]
+         * @param omega angular velocity [rad/s]
+         * @return gain K (u = -K*x)
+         */
+        pendulum_state_t gain(double phi, double omega);
+
+        /**
+         * Number of grid points of the table.
+         */
+        size_t grid_points() const;
+
+        /**
+         * Number of lookups outside the grid.
+         */
+        uint64_t clamped() const;
+
+      private:
+        unsigned long n_phi;
+        unsigned long n_omega;
+        double phi_max;
+        double omega_max;
+        // Inverse grid spacing [1/rad], [s/rad].
+        double phi_scale;
+        double omega_scale;
+        // Gain of grid point (i, j) at index i*n_omega + j.
+        std::vector<pendulum_state_t> gains;
+
+        uint64_t n_clamped;
+};
+
+#endif
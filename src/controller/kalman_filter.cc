@@ -0,0 +1,233 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "kalman_filter.h"
+#include "linear_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Intervals within this fraction of a multiple of the nominal period
+// count as that multiple.
+#define KALMAN_PERIOD_TOLERANCE 0.01
+
+KalmanFilter::KalmanFilter(double m, double M, double I, double l, const KalmanSettings &settings, bool extended)
+        : m(m), M(M), I(I), l(l), Ts(settings.Ts), extended(extended), has_gain(false), empty_estimate({}),
+          n_reordered(0), n_dropped(0)
+{
+        LinearModel continuous = linearize_pendulum(m, M, I, l);
+        LinearModel discrete = discretize(continuous, Ts);
+        for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) {
+                        K.Ad[i][j] = discrete.A(i, j);
+                        Ac[i][j] = continuous.A(i, j);
+                }
+                K.Bd[i] = discrete.B(i, 0);
+                Bc[i] = continuous.B(i, 0);
+                K.L[i] = {0.0, 0.0};
+        }
+
+        // Measurement of position and angle.
+        Matrix C(2, 4);
+        C(0, 0) = 1.0;
+        C(1, 2) = 1.0;
+        Matrix Qn(4, 4);
+        for (int i = 0; i < 4; i++)
+                Qn(i, i) = settings.q[i];
+        Matrix Rn(2, 2);
+        Rn(0, 0) = settings.r_x;
+        Rn(1, 1) = settings.r_phi;
+
+        // The a priori error covariance P solves the Riccati equation of
+        // the dual control problem (A', C'). L = P*C' * (C*P*C' + R)^-1.
+        LinearModel dual = {discrete.A.transpose(), C.transpose()};
+        Matrix P, K_dual, X;
+        if (!solve_dare(dual, Qn, Rn, P, K_dual) || !(C * P * C.transpose() + Rn).solve(C * P, X))
+                return;
+        for (int i = 0; i < 4; i++)
+                K.L[i] = {X(0, i), X(1, i)};
+        has_gain = true;
+
+        history.reserve(2 * KALMAN_HISTORY_LEN + 1);
+}
+
+bool KalmanFilter::valid() const
+{
+        return has_gain;
+}
+
+pendulum_state_t KalmanFilter::predict(const pendulum_state_t &x, double u, double dt) const
+{
+        if (dt <= 0.0)
+                return x;
+
+        if (extended) {
+                InvertedPendulum model(m, M, I, l, u, x);
+                int steps = (int)std::ceil(dt / Ts - KALMAN_PERIOD_TOLERANCE);
+                if (steps < 1)
+                        steps = 1;
+                for (int k = 0; k < steps; k++)
+                        model.step(dt / steps);
+                return model.get_state();
+        }
+
+        // Whole periods with the discrete model, a remainder beyond the
+        // tolerance with an Euler step.
+        long n = (long)(dt / Ts + KALMAN_PERIOD_TOLERANCE);
+        pendulum_state_t pred = x;
+        for (long k = 0; k < n; k++) {
+                pendulum_state_t next;
+                for (int i = 0; i < 4; i++)
+                        next[i] = K.Ad[i][0] * pred[0] + K.Ad[i][1] * pred[1] + K.Ad[i][2] * pred[2] +
+                                  K.Ad[i][3] * pred[3] + K.Bd[i] * u;
+                pred = next;
+        }
+        double rest = dt - n * Ts;
+        if (std::fabs(rest) > KALMAN_PERIOD_TOLERANCE * Ts) {
+                pendulum_state_t dx;
+                for (int i = 0; i < 4; i++)
+                        dx[i] = Ac[i][0] * pred[0] + Ac[i][1] * pred[1] + Ac[i][2] * pred[2] + Ac[i][3] * pred[3] +
+                                Bc[i] * u;
+                for (int i = 0; i < 4; i++)
+                        pred[i] += rest * dx[i];
+        }
+
+        return pred;
+}
+
+void KalmanFilter::correct(pendulum_state_t &x, const double y[2]) const
+{
+        double e_x = y[0] - x[0];
+        double e_phi = y[1] - x[2];
+        for (int i = 0; i < 4; i++)
+                x[i] += K.L[i][0] * e_x + K.L[i][1] * e_phi;
+}
+
+const pendulum_state_t &KalmanFilter::update(double t, double x, double phi)
+{
+        Entry entry = {t, {x, phi}, 0.0, {x, 0.0, phi, 0.0}};
+
+        if (history.empty()) {
+                history.push_back(entry);
+                return history.back().x;
+        }
+
+        // Common case: newest measurement.
+        if (t > history.back().t) {
+                const Entry &last = history.back();
+                entry.u = last.u;
+                entry.x = predict(last.x, last.u, t - last.t);
+                correct(entry.x, entry.y);
+                history.push_back(entry);
+                trim_history();
+                return history.back().x;
+        }
+
+        // Out of sequence: insert after the newest older measurement and
+        // roll the estimate forward from there.
+        auto pos = std::upper_bound(history.begin(), history.end(), t,
+                                    [](double time, const Entry &e) { return time < e.t; });
+        if (pos == history.begin() || (pos - 1)->t == t) {
+                n_dropped++;
+                return history.back().x;
+        }
+        n_reordered++;
+        entry.u = (pos - 1)->u;
+        size_t k = pos - history.begin();
+        history.insert(pos, entry);
+        for (; k < history.size(); k++) {
+                const Entry &prev = history[k - 1];
+                Entry &e = history[k];
+                e.x = predict(prev.x, prev.u, e.t - prev.t);
+                correct(e.x, e.y);
+        }
+        trim_history();
+
+        return history.back().x;
+}
+
+void KalmanFilter::trim_history()
+{
+        // Drop old entries in batches to amortize the move of the others.
+        if (history.size() > 2 * KALMAN_HISTORY_LEN)
+                history.erase(history.begin(), history.end() - KALMAN_HISTORY_LEN);
+}
+
+void KalmanFilter::input(double u)
+{
+        if (!history.empty())
+                history.back().u = u;
+}
+
+const pendulum_state_t &KalmanFilter::estimate() const
+{
+        return history.empty() ? empty_estimate : history.back().x;
+}
+
+const KalmanGains &KalmanFilter::gains() const
+{
+        return K;
+}
+
+uint64_t KalmanFilter::reordered() const
+{
+        return n_reordered;
+}
+
+uint64_t KalmanFilter::dropped() const
+{
+        return n_dropped;
+}
+
+KalmanFilterBank::KalmanFilterBank(const KalmanFilter &filter, size_t n) : K(filter.gains()), n(n)
+{
+        for (std::vector<double> &x : xs)
+                x.assign(n, 0.0);
+}
+
+void KalmanFilterBank::reset(size_t i, double x, double phi)
+{
+        xs[0][i] = x;
+        xs[1][i] = 0.0;
+        xs[2][i] = phi;
+        xs[3][i] = 0.0;
+}
+
+void KalmanFilterBank::update(const double *u, const double *x, const double *phi)
+{
+        double *__restrict x0 = xs[0].data();
+        double *__restrict x1 = xs[1].data();
+        double *__restrict x2 = xs[2].data();
+        double *__restrict x3 = xs[3].data();
+        const auto &A = K.Ad;
+        const auto &B = K.Bd;
+        const auto &L = K.L;
+
+        for (size_t i = 0; i < n; i++) {
+                double p0 = A[0][0] * x0[i] + A[0][1] * x1[i] + A[0][2] * x2[i] + A[0][3] * x3[i] + B[0] * u[i];
+                double p1 = A[1][0] * x0[i] + A[1][1] * x1[i] + A[1][2] * x2[i] + A[1][3] * x3[i] + B[1] * u[i];
+                double p2 = A[2][0] * x0[i] + A[2][1] * x1[i] + A[2][2] * x2[i] + A[2][3] * x3[i] + B[2] * u[i];
+                double p3 = A[3][0] * x0[i] + A[3][1] * x1[i] + A[3][2] * x2[i] + A[3][3] * x3[i] + B[3] * u[i];
+                double e_x = x[i] - p0;
+                double e_phi = phi[i] - p2;
+                x0[i] = p0 + L[0][0] * e_x + L[0][1] * e_phi;
+                x1[i] = p1 + L[1][0] * e_x + L[1][1] * e_phi;
+                x2[i] = p2 + L[2][0] * e_x + L[2][1] * e_phi;
+                x3[i] = p3 + L[3][0] * e_x + L[3][1] * e_phi;
+        }
+}
+
+pendulum_state_t KalmanFilterBank::estimate(size_t i) const
+{
+        return {xs[0][i], xs[1][i], xs[2][i], xs[3][i]};
+}
+
+size_t KalmanFilterBank::size() const
+{
+        return n;
+}
@@ -0,0 +1,190 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef KALMAN_FILTER_H
+#define KALMAN_FILTER_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+// Minimum number of past measurements kept for out-of-sequence updates.
+#define KALMAN_HISTORY_LEN 64
+
+/**
+ * Noise model of the estimator. The plant measures position and angle.
+ */
+struct KalmanSettings {
+        // Nominal sampling period [s]
+        double Ts;
+        // Variances of the process noise per period (x, v, phi, omega)
+        pendulum_state_t q;
+        // Variances of the measurement noise of position [m^2] and angle
+        // [rad^2]
+        double r_x;
+        double r_phi;
+};
+
+/**
+ * Steady-state gains of the estimator for the nominal sampling period:
+ * prediction x' = Ad*x + Bd*u, correction x += L*(y - (x[0], x[2])).
+ */
+struct KalmanGains {
+        std::array<pendulum_state_t, 4> Ad;
+        pendulum_state_t Bd;
+        std::array<std::array<double, 2>, 4> L;
+};
+
+/**
+ * State estimator for plants that only measure position and angle.
+ *
+ * The gain is the steady-state Kalman gain of the pendulum linearized at
+ * the upright position and sampled with the nominal period. It is
+ * computed once from the Riccati equation of the dual problem, so an
+ * update costs one prediction and a 4x2 correction (about 30 FMAs for
+ * the linear filter). The extended filter predicts the mean with the
+ * nonlinear model (RK4) instead, but keeps the steady-state gain.
+ *
+ * Measurements carry the sampling time of the plant. A measurement older
+ * than the newest one (e.g., after a delayed packet) is inserted into the
+ * history of (at least) the last KALMAN_HISTORY_LEN measurements, and the
+ * estimate is recomputed from the posterior before it. Older measurements
+ * and duplicates are dropped.
+ *
+ * The control input applied after a measurement is reported with
+ * input() and held until the next measurement.
+ */
+class KalmanFilter
+{
+      public:
+        /**
+         * @param m mass of pendulum [kg]
+         * @param M mass of cart [kg]
+         * @param I moment of inertia [kg*m^2]
+         * @param l length of pendulum to center of mass [m]
+         * @param settings noise model
+         * @param extended predict with the nonlinear model
+         */
+        KalmanFilter(double m, double M, double I, double l, const KalmanSettings &settings, bool extended);
+
+        /**
+         * @return true if a steady-state gain exists (false for invalid
+         * noise models).
+         */
+        bool valid() const;
+
+        /**
+         * Process a measurement. The first measurement initializes the
+         * estimate (zero velocities).
+         *
+         * @param t sampling time [s]
+         * @param x position [m]
+         * @param phi angle [rad]
+         * @return estimate at the time of the newest measurement
+         */
+        const pendulum_state_t &update(double t, double x, double phi);
+
+        /**
+         * Set the control input applied from the newest measurement on.
+         *
+         * @param u force [N]
+         */
+        void input(double u);
+
+        /**
+         * Estimate at the time of the newest measurement.
+         */
+        const pendulum_state_t &estimate() const;
+
+        const KalmanGains &gains() const;
+
+        /**
+         * Number of out-of-sequence measurements that required a
+         * rollback.
+         */
+        uint64_t reordered() const;
+
+        /**
+         * Number of measurements dropped (duplicates or older than the
+         * history).
+         */
+        uint64_t dropped() const;
+
+      private:
+        // Posterior after a measurement and the input applied after it.
+        struct Entry {
+                double t;
+                double y[2];
+                double u;
+                pendulum_state_t x;
+        };
+
+        pendulum_state_t predict(const pendulum_state_t &x, double u, double dt) const;
+        void correct(pendulum_state_t &x, const double y[2]) const;
+        void trim_history();
+
+        const double m, M, I, l;
+        const double Ts;
+        const bool extended;
+
+        KalmanGains K;
+        // Continuous-time model for intervals that are no multiple of Ts.
+        std::array<pendulum_state_t, 4> Ac;
+        pendulum_state_t Bc;
+        bool has_gain;
+
+        std::vector<Entry> history;
+        pendulum_state_t empty_estimate;
+
+        uint64_t n_reordered;
+        uint64_t n_dropped;
+};
+
+/**
+ * Batch of linear filters for a controller of many identical plants that
+ * sample synchronously with the nominal period. The estimates are stored
+ * as structure of arrays, so one update of all plants is a loop of
+ * independent FMAs over contiguous arrays.
+ */
+class KalmanFilterBank
+{
+      public:
+        /**
+         * @param filter filter providing the gains
+         * @param n number of plants
+         */
+        KalmanFilterBank(const KalmanFilter &filter, size_t n);
+
+        /**
+         * Initialize the estimate of a plant from a measurement.
+         */
+        void reset(size_t i, double x, double phi);
+
+        /**
+         * Predict one period and correct all plants.
+         *
+         * @param u inputs applied during the last period (n values)
+         * @param x measured positions (n values)
+         * @param phi measured angles (n values)
+         */
+        void update(const double *u, const double *x, const double *phi);
+
+        pendulum_state_t estimate(size_t i) const;
+
+        size_t size() const;
+
+      private:
+        const KalmanGains K;
+        const size_t n;
+        // Estimates (x, v, phi, omega) of all plants.
+        std::array<std::vector<double>, 4> xs;
+};
+
+#endif
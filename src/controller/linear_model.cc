@@ -0,0 +1,149 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "linear_model.h"
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <cmath>
+
+// Step of the central differences of the Jacobian.
+#define JACOBIAN_STEP 1e-6
+
+// Below this angle, the state-dependent coefficients are evaluated at this
+// angle [rad].
+#define SDC_MIN_ANGLE 1e-6
+
+// Convergence of the Riccati iteration (doubling steps).
+#define DARE_MAX_ITERATIONS 64
+#define DARE_TOLERANCE 1e-10
+
+LinearModel linearize_pendulum(double m, double M, double I, double l, double phi, double omega, double F)
+{
+        const pendulum_state_t x0 = {0.0, 0.0, phi, omega};
+        LinearModel model = {Matrix(4, 4), Matrix(4, 1)};
+
+        // Central differences of the same equations the plant integrates.
+        for (int j = 0; j < 5; j++) {
+                pendulum_state_t x_plus = x0;
+                pendulum_state_t x_minus = x0;
+                double F_plus = F;
+                double F_minus = F;
+                if (j < 4) {
+                        x_plus[j] += JACOBIAN_STEP;
+                        x_minus[j] -= JACOBIAN_STEP;
+                } else {
+                        F_plus += JACOBIAN_STEP;
+                        F_minus -= JACOBIAN_STEP;
+                }
+                InvertedPendulum plus(m, M, I, l, F_plus, x_plus);
+                InvertedPendulum minus(m, M, I, l, F_minus, x_minus);
+                pendulum_state_t dx_plus, dx_minus;
+                plus(x_plus, dx_plus, 0.0);
+                minus(x_minus, dx_minus, 0.0);
+                for (int i = 0; i < 4; i++) {
+                        double d = (dx_plus[i] - dx_minus[i]) / (2.0 * JACOBIAN_STEP);
+                        if (j < 4)
+                                model.A(i, j) = d;
+                        else
+                                model.B(i, 0) = d;
+                }
+        }
+
+        return model;
+}
+
+LinearModel sdc_pendulum(double m, double M, double I, double l, double phi, double omega)
+{
+        // The angle column is f/phi, which tends to the Jacobian at phi = 0.
+        if (std::fabs(phi) < SDC_MIN_ANGLE)
+                phi = (phi < 0.0) ? -SDC_MIN_ANGLE : SDC_MIN_ANGLE;
+
+        // The force enters affinely, so B is the difference of F = 1 and
+        // F = 0.
+        const pendulum_state_t x = {0.0, 0.0, phi, omega};
+        InvertedPendulum unforced(m, M, I, l, 0.0, x);
+        InvertedPendulum forced(m, M, I, l, 1.0, x);
+        pendulum_state_t f0, f1;
+        unforced(x, f0, 0.0);
+        forced(x, f1, 0.0);
+
+        LinearModel model = {Matrix(4, 4), Matrix(4, 1)};
+        model.A(0, 1) = 1.0;
+        model.A(2, 3) = 1.0;
+        model.A(1, 2) = f0[1] / phi;
+        model.A(3, 2) = f0[3] / phi;
+        for (int i = 0; i < 4; i++)
+                model.B(i, 0) = f1[i] - f0[i];
+
+        return model;
+}
+
+LinearModel discretize(const LinearModel &model, double Ts)
+{
+        // exp([A B; 0 0]*Ts) = [Ad Bd; 0 I]
+        size_t n = model.A.rows();
+        size_t p = model.B.cols();
+        Matrix aug(n + p, n + p);
+        for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < n; j++)
+                        aug(i, j) = model.A(i, j) * Ts;
+                for (size_t j = 0; j < p; j++)
+                        aug(i, n + j) = model.B(i, j) * Ts;
+        }
+        Matrix e = aug.exp();
+
+        LinearModel discrete = {Matrix(n, n), Matrix(n, p)};
+        for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < n; j++)
+                        discrete.A(i, j) = e(i, j);
+                for (size_t j = 0; j < p; j++)
+                        discrete.B(i, j) = e(i, n + j);
+        }
+
+        return discrete;
+}
+
+bool solve_dare(const LinearModel &model, const Matrix &Q, const Matrix &R, Matrix &P, Matrix &K)
+{
+        const Matrix &A = model.A;
+        const Matrix &B = model.B;
+        const size_t n = A.rows();
+        const Matrix In = Matrix::identity(n);
+
+        // Structure-preserving doubling: after k steps, H is the solution of
+        // the Riccati recursion over 2^k steps, so the number of steps grows
+        // with the logarithm of the settling time of the closed loop (the
+        // fixed-point iteration needs thousands of steps for short periods).
+        Matrix Rinv;
+        if (!R.inverse(Rinv))
+                return false;
+        Matrix Ak = A;
+        Matrix G = B * Rinv * B.transpose();
+        Matrix H = Q;
+        bool converged = false;
+        for (int it = 0; it < DARE_MAX_ITERATIONS && !converged; it++) {
+                // W = (I + G*H)^-1
+                Matrix W;
+                if (!(In + G * H).inverse(W))
+                        return false;
+                Matrix AW = Ak * W;
+                Matrix H_next = H + Ak.transpose() * H * W * Ak;
+                G = G + AW * G * Ak.transpose();
+                Ak = AW * Ak;
+                double delta = (H_next - H).max_abs();
+                H = H_next;
+                converged = (delta <= DARE_TOLERANCE * std::fmax(1.0, H.max_abs()));
+        }
+        if (!converged)
+                return false;
+
+        // K = (R + B'PB)^-1 B'PA
+        P = H;
+        Matrix Bt = B.transpose();
+        return (R + Bt * P * B).solve(Bt * P * A, K);
+}
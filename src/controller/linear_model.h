@@ -0,0 +1,80 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef LINEAR_MODEL_H
+#define LINEAR_MODEL_H
+
+#include "../utils/matrix.h"
+
+/**
+ * Linear model dx/dt = A*x + B*F (continuous) or x' = A*x + B*F
+ * (discrete) of the pendulum, state ordered like pendulum_state_t.
+ */
+struct LinearModel {
+        Matrix A;
+        Matrix B;
+};
+
+/**
+ * Linearize the equations of motion of InvertedPendulum at the given point
+ * (Jacobian; position and velocity of the cart do not matter). The default
+ * point is the upright equilibrium.
+ *
+ * @param m mass of pendulum [kg]
+ * @param M mass of cart [kg]
+ * @param I moment of inertia [kg*m^2]
+ * @param l length of pendulum to center of mass [m]
+ * @param phi angle [rad]
+ * @param omega angular velocity [rad/s]
+ * @param F force [N]
+ * @return continuous-time model
+ */
+LinearModel linearize_pendulum(double m, double M, double I, double l, double phi = 0.0, double omega = 0.0,
+                               double F = 0.0);
+
+/**
+ * State-dependent coefficient form of the equations of motion of
+ * InvertedPendulum: dx/dt = A(x)*x + B(x)*F holds exactly for the given
+ * angle and angular velocity (the nonlinear terms are factored into the
+ * column of the angle). At the upright position, this is the
+ * linearization.
+ *
+ * @param m mass of pendulum [kg]
+ * @param M mass of cart [kg]
+ * @param I moment of inertia [kg*m^2]
+ * @param l length of pendulum to center of mass [m]
+ * @param phi angle [rad]
+ * @param omega angular velocity [rad/s]
+ * @return continuous-time model
+ */
+LinearModel sdc_pendulum(double m, double M, double I, double l, double phi, double omega);
+
+/**
+ * Discretize a continuous-time model for zero-order hold of the input.
+ *
+ * @param model continuous-time model
+ * @param Ts sampling period [s]
+ * @return discrete-time model
+ */
+LinearModel discretize(const LinearModel &model, double Ts);
+
+/**
+ * Solve the discrete algebraic Riccati equation
+ * P = A'PA - A'PB (R + B'PB)^-1 B'PA + Q with the structure-preserving
+ * doubling algorithm.
+ *
+ * @param model discrete-time model
+ * @param Q state weight
+ * @param R input weight
+ * @param P receives the solution
+ * @param K receives the gain of the optimal control law u = -K*x
+ * @return true on convergence; false otherwise.
+ */
+bool solve_dare(const LinearModel &model, const Matrix &Q, const Matrix &R, Matrix &P, Matrix &K);
+
+#endif
@@ -0,0 +1,463 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "mpc_generator.h"
+#include "linear_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdio.h>
+
+// Maximum number of iterations of the active-set QP solver.
+#define QP_MAX_ITERATIONS 1000
+
+// Tolerance of the QP solver (multipliers and steps).
+#define QP_TOLERANCE 1e-12
+
+// Tolerance of the region test (distance from facet, rows are normalized).
+#define REGION_TOLERANCE 1e-9
+
+// A cell of the kd-tree is not split further if its samples lie in at
+// most this many regions, if it contains at most this many samples, or if
+// it has this depth.
+#define TREE_LEAF_REGIONS 4
+#define TREE_MIN_SAMPLES 16
+#define TREE_MAX_DEPTH 40
+
+MPCGenerator::MPCGenerator(double m, double M, double I, double l, const MPCSettings &settings)
+        : m(m), M(M), I(I), l(l), settings(settings), n_failed(0)
+{
+}
+
+bool MPCGenerator::generate(size_t n_samples, unsigned int seed)
+{
+        const unsigned int N = settings.N;
+        LinearModel model = discretize(linearize_pendulum(m, M, I, l), settings.Ts);
+
+        Matrix Q(4, 4);
+        for (int i = 0; i < 4; i++)
+                Q(i, i) = settings.q[i];
+        Matrix R(1, 1);
+        R(0, 0) = settings.r;
+        Matrix P;
+        if (!solve_dare(model, Q, R, P, K_lqr))
+                return false;
+
+        // Predicted states x_1..x_N = Sx*x_0 + Su*U.
+        Matrix Sx(4 * N, 4);
+        Matrix Su(4 * N, N);
+        Matrix Ak = Matrix::identity(4);
+        for (unsigned int k = 0; k < N; k++) {
+                // Column block j of row block k is A^(k-j)*B.
+                Matrix AkB = Ak * model.B;
+                for (unsigned int j = 0; k + j < N; j++)
+                        for (int i = 0; i < 4; i++)
+                                Su(4 * (k + j) + i, j) = AkB(i, 0);
+                Ak = model.A * Ak;
+                for (int i = 0; i < 4; i++)
+                        for (int c = 0; c < 4; c++)
+                                Sx(4 * k + i, c) = Ak(i, c);
+        }
+
+        // Weights of x_1..x_N (terminal weight P).
+        Matrix Qbar(4 * N, 4 * N);
+        for (unsigned int k = 0; k < N; k++) {
+                const Matrix &W = (k + 1 < N) ? Q : P;
+                for (int i = 0; i < 4; i++)
+                        for (int c = 0; c < 4; c++)
+                                Qbar(4 * k + i, 4 * k + c) = W(i, c);
+        }
+        Matrix SuT = Su.transpose();
+        H = (SuT * Qbar * Su + Matrix::identity(N) * settings.r) * 2.0;
+        F = SuT * Qbar * Sx * 2.0;
+
+        // Explore the box.
+        std::mt19937 rng(seed);
+        samples.clear();
+        sample_regions.clear();
+        n_failed = 0;
+        for (size_t s = 0; s < n_samples; s++) {
+                pendulum_state_t x;
+                int id;
+                if (!sample(rng, x, id))
+                        continue;
+                samples.push_back(x);
+                sample_regions.push_back(id);
+        }
+
+        tree.clear();
+        leaf_candidates.clear();
+        std::vector<size_t> idx(samples.size());
+        for (size_t i = 0; i < idx.size(); i++)
+                idx[i] = i;
+        pendulum_state_t lo, hi;
+        for (int i = 0; i < 4; i++) {
+                lo[i] = -settings.box[i];
+                hi[i] = settings.box[i];
+        }
+        build_tree(idx, 0, idx.size(), lo, hi, 0);
+
+        // Complete the candidates of the leaves with new samples.
+        for (size_t s = 0; s < n_samples; s++) {
+                pendulum_state_t x;
+                int id;
+                if (!sample(rng, x, id))
+                        continue;
+                std::vector<uint32_t> &cand = leaf_candidates[tree[find_leaf(x)].first];
+                if (std::find(cand.begin(), cand.end(), (uint32_t)id) == cand.end())
+                        cand.push_back(id);
+        }
+
+        return true;
+}
+
+bool MPCGenerator::sample(std::mt19937 &rng, pendulum_state_t &x, int &id)
+{
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+        for (int i = 0; i < 4; i++)
+                x[i] = settings.box[i] * uniform(rng);
+
+        pattern_t pattern;
+        if (!solve_qp(x, pattern)) {
+                n_failed++;
+                return false;
+        }
+        id = region_of(pattern);
+        if (id < 0 || !contains(region_table[id], x)) {
+                n_failed++;
+                return false;
+        }
+
+        return true;
+}
+
+uint32_t MPCGenerator::find_leaf(const pendulum_state_t &x) const
+{
+        uint32_t node = 0;
+        while (tree[node].dim >= 0)
+                node = (x[tree[node].dim] < tree[node].split) ? tree[node].left : tree[node].right;
+
+        return node;
+}
+
+bool MPCGenerator::solve_pattern(const pattern_t &pattern, Matrix &G, Matrix &g) const
+{
+        const size_t N = settings.N;
+        std::vector<size_t> free_idx, active_idx;
+        for (size_t i = 0; i < N; i++) {
+                if (pattern[i] == 0)
+                        free_idx.push_back(i);
+                else
+                        active_idx.push_back(i);
+        }
+
+        G = Matrix(N, 4);
+        g = Matrix(N, 1);
+        for (size_t i : active_idx)
+                g(i, 0) = pattern[i] * settings.umax;
+        if (free_idx.empty())
+                return true;
+
+        // H_ff*U_f = -F_f*x - H_fa*U_a
+        Matrix rhs(free_idx.size(), 5);
+        for (size_t r = 0; r < free_idx.size(); r++) {
+                size_t i = free_idx[r];
+                for (int c = 0; c < 4; c++)
+                        rhs(r, c) = -F(i, c);
+                for (size_t j : active_idx)
+                        rhs(r, 4) -= H(i, j) * g(j, 0);
+        }
+        Matrix sol;
+        if (!H.select(free_idx, free_idx).solve(rhs, sol))
+                return false;
+        for (size_t r = 0; r < free_idx.size(); r++) {
+                for (int c = 0; c < 4; c++)
+                        G(free_idx[r], c) = sol(r, c);
+                g(free_idx[r], 0) = sol(r, 4);
+        }
+
+        return true;
+}
+
+bool MPCGenerator::solve_qp(const pendulum_state_t &x, pattern_t &pattern) const
+{
+        // Primal active-set method starting from the clipped unconstrained
+        // optimizer.
+        const size_t N = settings.N;
+        const double umax = settings.umax;
+        Matrix G, g;
+
+        pattern.assign(N, 0);
+        if (!solve_pattern(pattern, G, g))
+                return false;
+        std::vector<double> U(N);
+        for (size_t i = 0; i < N; i++) {
+                double u = g(i, 0);
+                for (int c = 0; c < 4; c++)
+                        u += G(i, c) * x[c];
+                if (u >= umax) {
+                        u = umax;
+                        pattern[i] = 1;
+                } else if (u <= -umax) {
+                        u = -umax;
+                        pattern[i] = -1;
+                }
+                U[i] = u;
+        }
+
+        for (int it = 0; it < QP_MAX_ITERATIONS; it++) {
+                if (!solve_pattern(pattern, G, g))
+                        return false;
+                std::vector<double> U_opt(N);
+                double step = 0.0;
+                for (size_t i = 0; i < N; i++) {
+                        U_opt[i] = g(i, 0);
+                        for (int c = 0; c < 4; c++)
+                                U_opt[i] += G(i, c) * x[c];
+                        step = std::fmax(step, std::fabs(U_opt[i] - U[i]));
+                }
+
+                if (step <= QP_TOLERANCE * std::fmax(1.0, umax)) {
+                        // Optimal for this working set: drop the active
+                        // constraint with the most negative multiplier.
+                        size_t worst = N;
+                        double worst_violation = QP_TOLERANCE;
+                        for (size_t i = 0; i < N; i++) {
+                                if (pattern[i] == 0)
+                                        continue;
+                                double grad = 0.0;
+                                for (size_t j = 0; j < N; j++)
+                                        grad += H(i, j) * U_opt[j];
+                                for (int c = 0; c < 4; c++)
+                                        grad += F(i, c) * x[c];
+                                // Multiplier of the upper bound is -grad,
+                                // of the lower bound grad.
+                                double violation = pattern[i] * grad;
+                                if (violation > worst_violation) {
+                                        worst = i;
+                                        worst_violation = violation;
+                                }
+                        }
+                        if (worst == N)
+                                return true;
+                        pattern[worst] = 0;
+                        U = U_opt;
+                        continue;
+                }
+
+                // Move towards the optimizer until a bound blocks.
+                double alpha = 1.0;
+                size_t blocking = N;
+                for (size_t i = 0; i < N; i++) {
+                        if (pattern[i] != 0)
+                                continue;
+                        double p = U_opt[i] - U[i];
+                        if (p > 0.0 && U[i] + alpha * p > umax) {
+                                alpha = (umax - U[i]) / p;
+                                blocking = i;
+                        } else if (p < 0.0 && U[i] + alpha * p < -umax) {
+                                alpha = (-umax - U[i]) / p;
+                                blocking = i;
+                        }
+                }
+                for (size_t i = 0; i < N; i++)
+                        U[i] += alpha * (U_opt[i] - U[i]);
+                if (blocking < N) {
+                        pattern[blocking] = (U[blocking] > 0.0) ? 1 : -1;
+                        U[blocking] = pattern[blocking] * umax;
+                }
+        }
+
+        return false;
+}
+
+int MPCGenerator::region_of(const pattern_t &pattern)
+{
+        auto it = region_ids.find(pattern);
+        if (it != region_ids.end())
+                return it->second;
+
+        Matrix G, g;
+        if (!solve_pattern(pattern, G, g))
+                return -1;
+        // Gradient of the cost: Gr*x + gr.
+        Matrix Gr = H * G + F;
+        Matrix gr = H * g;
+
+        Region region;
+        region.pattern = pattern;
+        for (int c = 0; c < 4; c++)
+                region.gain[c] = G(0, c);
+        region.offset = g(0, 0);
+
+        auto add_row = [&region](const double *a, double sign, double b) {
+                std::array<double, 5> row;
+                double norm = 0.0;
+                for (int c = 0; c < 4; c++) {
+                        row[c] = sign * a[c];
+                        norm += row[c] * row[c];
+                }
+                norm = std::sqrt(norm);
+                row[4] = b;
+                // Rows without state dependency are always satisfied in
+                // regions found by the solver.
+                if (norm < 1e-12)
+                        return;
+                for (int c = 0; c < 5; c++)
+                        row[c] /= norm;
+                region.rows.push_back(row);
+        };
+
+        for (size_t i = 0; i < settings.N; i++) {
+                double a[4];
+                if (pattern[i] == 0) {
+                        // -umax <= G_i*x + g_i <= umax
+                        for (int c = 0; c < 4; c++)
+                                a[c] = G(i, c);
+                        add_row(a, 1.0, settings.umax - g(i, 0));
+                        add_row(a, -1.0, settings.umax + g(i, 0));
+                } else {
+                        // Non-negative multiplier: pattern*gradient <= 0
+                        for (int c = 0; c < 4; c++)
+                                a[c] = Gr(i, c);
+                        add_row(a, pattern[i], -pattern[i] * gr(i, 0));
+                }
+        }
+
+        int id = region_table.size();
+        region_table.push_back(region);
+        region_ids[pattern] = id;
+
+        return id;
+}
+
+bool MPCGenerator::contains(const Region &region, const pendulum_state_t &x) const
+{
+        for (const auto &row : region.rows) {
+                if (row[0] * x[0] + row[1] * x[1] + row[2] * x[2] + row[3] * x[3] > row[4] + REGION_TOLERANCE)
+                        return false;
+        }
+
+        return true;
+}
+
+uint32_t MPCGenerator::build_tree(std::vector<size_t> &idx, size_t begin, size_t end, pendulum_state_t lo,
+                                  pendulum_state_t hi, int depth)
+{
+        uint32_t node_id = tree.size();
+        tree.push_back(Node());
+
+        // Regions of the samples of this cell, most frequent first.
+        std::map<int, size_t> counts;
+        for (size_t k = begin; k < end; k++)
+                counts[sample_regions[idx[k]]]++;
+
+        if (counts.size() <= TREE_LEAF_REGIONS || end - begin <= TREE_MIN_SAMPLES || depth >= TREE_MAX_DEPTH) {
+                std::vector<std::pair<size_t, int>> by_count;
+                for (const auto &c : counts)
+                        by_count.push_back({c.second, c.first});
+                std::sort(by_count.rbegin(), by_count.rend());
+                Node &leaf = tree[node_id];
+                leaf.dim = -1;
+                leaf.split = 0.0;
+                leaf.left = leaf.right = 0;
+                leaf.first = leaf_candidates.size();
+                leaf.count = 0;
+                leaf_candidates.emplace_back();
+                for (const auto &c : by_count)
+                        leaf_candidates.back().push_back(c.second);
+                return node_id;
+        }
+
+        // Split the longest side (relative to the box) in the middle.
+        int dim = 0;
+        for (int i = 1; i < 4; i++) {
+                if ((hi[i] - lo[i]) / settings.box[i] > (hi[dim] - lo[dim]) / settings.box[dim])
+                        dim = i;
+        }
+        double split = 0.5 * (lo[dim] + hi[dim]);
+        size_t mid = std::partition(idx.begin() + begin, idx.begin() + end,
+                                    [this, dim, split](size_t i) { return samples[i][dim] < split; }) -
+                     idx.begin();
+
+        pendulum_state_t hi_left = hi;
+        hi_left[dim] = split;
+        pendulum_state_t lo_right = lo;
+        lo_right[dim] = split;
+        uint32_t left = build_tree(idx, begin, mid, lo, hi_left, depth + 1);
+        uint32_t right = build_tree(idx, mid, end, lo_right, hi, depth + 1);
+
+        Node &node = tree[node_id];
+        node.dim = dim;
+        node.split = split;
+        node.left = left;
+        node.right = right;
+        node.first = node.count = 0;
+
+        return node_id;
+}
+
+bool MPCGenerator::write(const char *path) const
+{
+        FILE *f = fopen(path, "w");
+        if (f == NULL)
+                return false;
+
+        fprintf(f, "# Explicit MPC region table (mpc-generate)\n");
+        fprintf(f, "# mpc N Ts umax / lqr K (fallback) / regions: n_rows gain offset, rows a b (a*x <= b)\n");
+        fprintf(f, "mpc %u %.17g %.17g\n", settings.N, settings.Ts, settings.umax);
+        fprintf(f, "lqr %.17g %.17g %.17g %.17g\n", K_lqr(0, 0), K_lqr(0, 1), K_lqr(0, 2), K_lqr(0, 3));
+        fprintf(f, "regions %zu\n", region_table.size());
+        for (const Region &region : region_table) {
+                fprintf(f, "region %zu %.17g %.17g %.17g %.17g %.17g\n", region.rows.size(), region.gain[0],
+                        region.gain[1], region.gain[2], region.gain[3], region.offset);
+                for (const auto &row : region.rows)
+                        fprintf(f, "%.17g %.17g %.17g %.17g %.17g\n", row[0], row[1], row[2], row[3], row[4]);
+        }
+        // Candidates of all leaves are stored consecutively.
+        std::vector<uint32_t> offsets;
+        size_t n_candidates = 0;
+        for (const auto &cand : leaf_candidates) {
+                offsets.push_back(n_candidates);
+                n_candidates += cand.size();
+        }
+        fprintf(f, "nodes %zu\n", tree.size());
+        for (const Node &node : tree) {
+                if (node.dim >= 0)
+                        fprintf(f, "%d %.17g %u %u 0 0\n", node.dim, node.split, node.left, node.right);
+                else
+                        fprintf(f, "-1 0 0 0 %u %zu\n", offsets[node.first], leaf_candidates[node.first].size());
+        }
+        fprintf(f, "candidates %zu\n", n_candidates);
+        for (const auto &cand : leaf_candidates)
+                for (uint32_t id : cand)
+                        fprintf(f, "%u\n", id);
+
+        if (ferror(f)) {
+                fclose(f);
+                return false;
+        }
+
+        return (fclose(f) == 0);
+}
+
+size_t MPCGenerator::regions() const
+{
+        return region_table.size();
+}
+
+size_t MPCGenerator::nodes() const
+{
+        return tree.size();
+}
+
+size_t MPCGenerator::failed_samples() const
+{
+        return n_failed;
+}
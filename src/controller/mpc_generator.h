@@ -0,0 +1,159 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef MPC_GENERATOR_H
+#define MPC_GENERATOR_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "../utils/matrix.h"
+
+#include <map>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Parameters of the MPC problem
+ *
+ *   min sum_{k=0}^{N-1} (x_k' Q x_k + r u_k^2) + x_N' P x_N
+ *   s.t. x_{k+1} = A x_k + B u_k, |u_k| <= umax
+ *
+ * for the pendulum linearized around the upright position and discretized
+ * with period Ts. P is the solution of the Riccati equation, i.e., without
+ * active constraints, the MPC is the LQR.
+ */
+struct MPCSettings {
+        double Ts;
+        unsigned int N;
+        double umax;
+        pendulum_state_t q;
+        double r;
+        // Half widths of the box of states explored for regions.
+        pendulum_state_t box;
+};
+
+/**
+ * Offline computation of the explicit MPC law (see ExplicitMPC).
+ *
+ * With input constraints only, the MPC problem is a box-constrained QP
+ * in U = (u_0, ..., u_{N-1}) with parameter x:
+ * min 1/2 U'HU + x'F'U s.t. |U| <= umax. For a fixed active set (each
+ * input free, at the upper, or at the lower bound), the optimizer is
+ * affine in x, and the set of states for which this active set is optimal
+ * is a polyhedron given by primal feasibility of the free inputs and
+ * non-negative multipliers of the active ones.
+ *
+ * The active sets occurring in the explored box are found by solving the
+ * QP for sampled states. The samples also serve to build the kd-tree
+ * (cells are split until the samples of a cell lie in a few regions). A
+ * second set of samples adds regions missing from the candidates of the
+ * leaves.
+ */
+class MPCGenerator
+{
+      public:
+        /**
+         * @param m mass of pendulum [kg]
+         * @param M mass of cart [kg]
+         * @param I moment of inertia [kg*m^2]
+         * @param l length of pendulum to center of mass [m]
+         * @param settings MPC problem
+         */
+        MPCGenerator(double m, double M, double I, double l, const MPCSettings &settings);
+
+        /**
+         * Explore the state box and build the region table and kd-tree.
+         *
+         * @param n_samples number of sampled states
+         * @param seed seed of the random number generator
+         * @return true on success; false if the Riccati equation has no
+         * solution.
+         */
+        bool generate(size_t n_samples, unsigned int seed);
+
+        /**
+         * Write the table (format read by ExplicitMPC::load()).
+         *
+         * @return true on success; false on error (errno is set).
+         */
+        bool write(const char *path) const;
+
+        size_t regions() const;
+        size_t nodes() const;
+
+        /**
+         * Number of samples for which the QP solver did not converge.
+         */
+        size_t failed_samples() const;
+
+      private:
+        typedef std::vector<int8_t> pattern_t;
+
+        struct Region {
+                pattern_t pattern;
+                // Rows a0..a3, b of a*x <= b.
+                std::vector<std::array<double, 5>> rows;
+                pendulum_state_t gain;
+                double offset;
+        };
+
+        struct Node {
+                int dim;
+                double split;
+                uint32_t left;
+                uint32_t right;
+                uint32_t first;
+                uint32_t count;
+        };
+
+        /**
+         * Affine optimizer U = G*x + g for an active set.
+         */
+        bool solve_pattern(const pattern_t &pattern, Matrix &G, Matrix &g) const;
+
+        /**
+         * Optimal active set for state x (primal active-set method).
+         */
+        bool solve_qp(const pendulum_state_t &x, pattern_t &pattern) const;
+
+        /**
+         * Sample a state and get its region.
+         *
+         * @return true on success; false if the solver failed.
+         */
+        bool sample(std::mt19937 &rng, pendulum_state_t &x, int &id);
+
+        int region_of(const pattern_t &pattern);
+        bool contains(const Region &region, const pendulum_state_t &x) const;
+
+        uint32_t find_leaf(const pendulum_state_t &x) const;
+
+        uint32_t build_tree(std::vector<size_t> &idx, size_t begin, size_t end, pendulum_state_t lo,
+                            pendulum_state_t hi, int depth);
+
+        const double m, M, I, l;
+        const MPCSettings settings;
+
+        // Condensed QP.
+        Matrix H;
+        Matrix F;
+        Matrix K_lqr;
+
+        std::vector<Region> region_table;
+        std::map<pattern_t, int> region_ids;
+
+        std::vector<pendulum_state_t> samples;
+        std::vector<int> sample_regions;
+        std::vector<Node> tree;
+        // Candidate regions of each leaf (Node::first).
+        std::vector<std::vector<uint32_t>> leaf_candidates;
+
+        size_t n_failed;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "packet_control.h"
+
+#include <cmath>
+
+// Number of integration steps per horizon step of the prediction.
+#define PREDICTION_SUBSTEPS 4
+
+HorizonPredictor::HorizonPredictor(double m, double M, double I, double l, const pendulum_state_t &K, double step)
+        : m(m), M(M), I(I), l(l), lqr(K), step(step)
+{
+}
+
+void HorizonPredictor::predict(const pendulum_state_t &state, double *u, size_t n)
+{
+        InvertedPendulum model(m, M, I, l, 0.0, state);
+
+        if (n > HORIZON_MAX_LEN)
+                n = HORIZON_MAX_LEN;
+        for (size_t k = 0; k < n; k++) {
+                u[k] = lqr.control(model.get_state());
+                model.set_force(u[k]);
+                for (int i = 0; i < PREDICTION_SUBSTEPS; i++)
+                        model.step(step / PREDICTION_SUBSTEPS);
+        }
+}
+
+HorizonBuffer::HorizonBuffer() : t_sample(0.0), step(0.0), n(0)
+{
+}
+
+bool HorizonBuffer::received(double t_sample, double step, const double *u, size_t n)
+{
+        if (n == 0 || (this->n > 0 && t_sample <= this->t_sample))
+                return false;
+
+        if (n > HORIZON_MAX_LEN)
+                n = HORIZON_MAX_LEN;
+        this->t_sample = t_sample;
+        this->step = step;
+        for (size_t k = 0; k < n; k++)
+                this->u[k] = u[k];
+        this->n = n;
+
+        return true;
+}
+
+bool HorizonBuffer::valid() const
+{
+        return (n > 0);
+}
+
+double HorizonBuffer::value(double t) const
+{
+        if (n == 0)
+                return 0.0;
+        if (t <= t_sample)
+                return u[0];
+
+        // Small epsilon such that t = t_sample + k*step selects u[k]
+        // despite rounding.
+        size_t k = (size_t)std::floor((t - t_sample) / step + 1e-9);
+        if (k >= n)
+                k = n - 1;
+
+        return u[k];
+}
+
+bool HorizonBuffer::exhausted(double t) const
+{
+        return (n == 0 || t >= t_sample + n * step);
+}
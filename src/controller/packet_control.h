@@ -0,0 +1,107 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef PACKET_CONTROL_H
+#define PACKET_CONTROL_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "lqr.h"
+
+#include <stddef.h>
+
+// Maximum number of control values of a horizon.
+#define HORIZON_MAX_LEN 64
+
+/**
+ * Controller side of packet-based control: predicts the future with the
+ * plant model and computes a horizon of control values.
+ *
+ * Starting from the received state, the model is rolled out for n steps,
+ * applying the LQR output of the predicted state for one step each.
+ */
+class HorizonPredictor
+{
+      public:
+        /**
+         * @param m mass of pendulum [kg]
+         * @param M mass of cart [kg]
+         * @param I moment of inertia [kg*m^2]
+         * @param l length of pendulum to center of mass [m]
+         * @param K gain matrix of LQR
+         * @param step duration of one horizon step [s]
+         */
+        HorizonPredictor(double m, double M, double I, double l, const pendulum_state_t &K, double step);
+
+        /**
+         * Compute a horizon.
+         *
+         * @param state state at the sampling time
+         * @param u receives n control values; u[k] applies from sampling
+         * time + k*step
+         * @param n length of horizon (at most HORIZON_MAX_LEN)
+         */
+        void predict(const pendulum_state_t &state, double *u, size_t n);
+
+      private:
+        const double m, M, I, l;
+        LQRegulator lqr;
+        const double step;
+};
+
+/**
+ * Plant side of packet-based control: buffers the horizon of the newest
+ * state and yields the control value matching the current time.
+ *
+ * Horizons arriving late or out of order are ignored if a horizon of a
+ * newer state is already buffered. Beyond its end, the last value of the
+ * horizon is held.
+ */
+class HorizonBuffer
+{
+      public:
+        HorizonBuffer();
+
+        /**
+         * Buffer a received horizon.
+         *
+         * @param t_sample sampling time of the state the horizon was
+         * computed from [s]
+         * @param step duration of one horizon step [s]
+         * @param u control values
+         * @param n number of control values (at most HORIZON_MAX_LEN)
+         * @return true if the horizon was buffered; false if a newer one is
+         * already buffered.
+         */
+        bool received(double t_sample, double step, const double *u, size_t n);
+
+        /**
+         * Check whether a horizon has been buffered.
+         */
+        bool valid() const;
+
+        /**
+         * Get the control value for time t.
+         *
+         * @param t time [s]
+         * @return control value (0 if no horizon has been buffered)
+         */
+        double value(double t) const;
+
+        /**
+         * Check whether time t is beyond the end of the buffered horizon.
+         */
+        bool exhausted(double t) const;
+
+      private:
+        double t_sample;
+        double step;
+        double u[HORIZON_MAX_LEN];
+        size_t n;
+};
+
+#endif
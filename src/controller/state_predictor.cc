@@ -0,0 +1,133 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "state_predictor.h"
+
+#include <cmath>
+
+// Gravity [m/s^2] (same as the plant model)
+#define GRAVITY 9.8067
+
+// Number of terms of the Taylor series of the matrix exponential.
+#define EXPM_TERMS 12
+
+StatePredictor::StatePredictor(double m, double M, double I, double l, const pendulum_state_t &K, double max_delay)
+        : m(m), M(M), I(I), l(l), K(K), n_linear(0), n_nonlinear(0)
+{
+        // Equations of motion of InvertedPendulum linearized around the
+        // upright position (sin(phi) = phi, cos(phi) = 1, omega^2 = 0):
+        // dv/dt = a_v*phi + b_v*F, domega/dt = a_o*phi + b_o*F.
+        double l_2 = l * l;
+        double J_t = I + m * l_2;
+        double M_t = M + m;
+        double d_v = M_t - m * (m * l_2 / J_t);
+        double d_o = J_t * (M_t / m) - m * l_2;
+        double a_v = m * GRAVITY * (m * l_2 / J_t) / d_v;
+        double b_v = 1.0 / d_v;
+        double a_o = M_t * GRAVITY * l / d_o;
+        double b_o = l / d_o;
+
+        // Closing the loop with F = -K*x adds -B*K.
+        for (auto &row : Acl)
+                row.fill(0.0);
+        Acl[0][1] = 1.0;
+        Acl[2][3] = 1.0;
+        Acl[1][2] = a_v;
+        Acl[3][2] = a_o;
+        for (int j = 0; j < 4; j++) {
+                Acl[1][j] -= b_v * K[j];
+                Acl[3][j] -= b_o * K[j];
+        }
+
+        // exp(Acl*res) by Taylor series (Acl*res is small).
+        matrix_t step = {};
+        matrix_t term = {};
+        for (int i = 0; i < 4; i++)
+                step[i][i] = term[i][i] = 1.0;
+        for (int k = 1; k <= EXPM_TERMS; k++) {
+                matrix_t next = {};
+                for (int i = 0; i < 4; i++)
+                        for (int j = 0; j < 4; j++)
+                                for (int r = 0; r < 4; r++)
+                                        next[i][j] += term[i][r] * Acl[r][j] * PREDICTOR_TABLE_RES / k;
+                term = next;
+                for (int i = 0; i < 4; i++)
+                        for (int j = 0; j < 4; j++)
+                                step[i][j] += term[i][j];
+        }
+
+        // exp(Acl*k*res) = exp(Acl*res)^k
+        size_t n = (size_t)std::ceil(max_delay / PREDICTOR_TABLE_RES) + 1;
+        table.resize(n);
+        table[0] = {};
+        for (int i = 0; i < 4; i++)
+                table[0][i][i] = 1.0;
+        for (size_t k = 1; k < n; k++) {
+                table[k] = {};
+                for (int i = 0; i < 4; i++)
+                        for (int j = 0; j < 4; j++)
+                                for (int r = 0; r < 4; r++)
+                                        table[k][i][j] += step[i][r] * table[k - 1][r][j];
+        }
+}
+
+pendulum_state_t StatePredictor::predict(const pendulum_state_t &state, double delay)
+{
+        if (delay <= 0.0)
+                return state;
+
+        // Bound of the angle over the interval, assuming constant
+        // angular velocity.
+        double angle_bound = std::fabs(state[2]) + std::fabs(state[3]) * delay;
+        size_t k = (size_t)(delay / PREDICTOR_TABLE_RES);
+        if (k >= table.size() || angle_bound > PREDICTOR_LINEAR_MAX_ANGLE) {
+                n_nonlinear++;
+                return predict_nonlinear(state, delay);
+        }
+        n_linear++;
+
+        const matrix_t &P = table[k];
+        pendulum_state_t pred;
+        for (int i = 0; i < 4; i++)
+                pred[i] = P[i][0] * state[0] + P[i][1] * state[1] + P[i][2] * state[2] + P[i][3] * state[3];
+
+        // Remainder shorter than the table resolution (Euler step).
+        double rest = delay - k * PREDICTOR_TABLE_RES;
+        pendulum_state_t dx;
+        for (int i = 0; i < 4; i++)
+                dx[i] = Acl[i][0] * pred[0] + Acl[i][1] * pred[1] + Acl[i][2] * pred[2] + Acl[i][3] * pred[3];
+        for (int i = 0; i < 4; i++)
+                pred[i] += rest * dx[i];
+
+        return pred;
+}
+
+pendulum_state_t StatePredictor::predict_nonlinear(const pendulum_state_t &state, double delay) const
+{
+        InvertedPendulum model(m, M, I, l, 0.0, state);
+
+        int steps = (int)std::ceil(delay / PREDICTOR_RK4_STEP);
+        double dt = delay / steps;
+        for (int i = 0; i < steps; i++) {
+                const pendulum_state_t &x = model.get_state();
+                model.set_force(-(K[0] * x[0] + K[1] * x[1] + K[2] * x[2] + K[3] * x[3]));
+                model.step(dt);
+        }
+
+        return model.get_state();
+}
+
+uint64_t StatePredictor::linear_predictions() const
+{
+        return n_linear;
+}
+
+uint64_t StatePredictor::nonlinear_predictions() const
+{
+        return n_nonlinear;
+}
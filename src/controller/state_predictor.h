@@ -0,0 +1,93 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef STATE_PREDICTOR_H
+#define STATE_PREDICTOR_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Delay resolution of the table of linear propagators [s]
+#define PREDICTOR_TABLE_RES 0.0001
+
+// Integration step of the nonlinear fallback [s]
+#define PREDICTOR_RK4_STEP 0.001
+
+// The linear propagator is used as long as the angle stays within this
+// bound over the prediction interval [rad].
+#define PREDICTOR_LINEAR_MAX_ANGLE 0.1
+
+/**
+ * Delay compensation: predicts the state at the time an update computed
+ * from it will be applied by the plant, i.e., one round-trip delay after
+ * sampling.
+ *
+ * During the delay, the plant applies updates computed for earlier
+ * states. If these have been delay-compensated as well, the plant is
+ * effectively controlled by the LQR at every point in time, so the
+ * prediction uses the closed loop of model and LQR.
+ *
+ * Close to the upright position, the linearized closed loop is used,
+ * discretized for multiples of PREDICTOR_TABLE_RES up to the maximum
+ * delay (one 4x4 matrix-vector product per prediction). Otherwise, or for
+ * longer delays, the nonlinear model is integrated with RK4.
+ */
+class StatePredictor
+{
+      public:
+        /**
+         * @param m mass of pendulum [kg]
+         * @param M mass of cart [kg]
+         * @param I moment of inertia [kg*m^2]
+         * @param l length of pendulum to center of mass [m]
+         * @param K gain matrix of LQR
+         * @param max_delay longest delay covered by the linear propagator [s]
+         */
+        StatePredictor(double m, double M, double I, double l, const pendulum_state_t &K, double max_delay);
+
+        /**
+         * Predict the state.
+         *
+         * @param state sampled state
+         * @param delay time between sampling and application of the
+         * update [s]
+         * @return predicted state
+         */
+        pendulum_state_t predict(const pendulum_state_t &state, double delay);
+
+        /**
+         * Number of predictions using the linear propagator.
+         */
+        uint64_t linear_predictions() const;
+
+        /**
+         * Number of predictions using the nonlinear model.
+         */
+        uint64_t nonlinear_predictions() const;
+
+      private:
+        typedef std::array<pendulum_state_t, 4> matrix_t;
+
+        pendulum_state_t predict_nonlinear(const pendulum_state_t &state, double delay) const;
+
+        const double m, M, I, l;
+        const pendulum_state_t K;
+
+        // Linearized closed loop dx/dt = Acl*x.
+        matrix_t Acl;
+
+        // Propagators exp(Acl*k*PREDICTOR_TABLE_RES).
+        std::vector<matrix_t> table;
+
+        uint64_t n_linear;
+        uint64_t n_nonlinear;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "trigger.h"
+
+#include <cmath>
+#include <string.h>
+
+// Weights of the state norm: position [m], speed [m/s], angle [rad] and
+// angular velocity [rad/s] are scaled to comparable magnitudes around
+// the equilibrium (1 cm ~ 0.01 rad ~ 0.1 rad/s).
+static const pendulum_state_t TRIGGER_WEIGHTS = {1.0, 0.1, 1.0, 0.01};
+
+// Absolute dead zone of the Lyapunov trigger (squared weighted norm).
+#define TRIGGER_LYAPUNOV_FLOOR 1e-6
+
+TransmissionTrigger::TransmissionTrigger(Policy policy, double threshold, double max_silence)
+        : policy(policy), threshold(threshold), max_silence(max_silence), has_sent(false), t_last_sent(0.0),
+          state_last_sent({0.0, 0.0, 0.0, 0.0}), t_next(0.0), t_last_sample(NAN), period(0.0), n_sent(0),
+          n_suppressed(0)
+{
+}
+
+double TransmissionTrigger::norm2(const pendulum_state_t &x)
+{
+        double sum = 0.0;
+        for (size_t i = 0; i < x.size(); i++)
+                sum += TRIGGER_WEIGHTS[i] * x[i] * x[i];
+        return sum;
+}
+
+void TransmissionTrigger::mark_sent(double t, const pendulum_state_t &state)
+{
+        has_sent = true;
+        t_last_sent = t;
+        state_last_sent = state;
+        n_sent++;
+}
+
+bool TransmissionTrigger::should_send(double t, const pendulum_state_t &state)
+{
+        if (!std::isnan(t_last_sample) && t > t_last_sample)
+                period = t - t_last_sample;
+        t_last_sample = t;
+
+        bool send;
+        if (policy == Policy::PERIODIC || !has_sent || t - t_last_sent >= max_silence) {
+                send = true;
+        } else {
+                pendulum_state_t e;
+                for (size_t i = 0; i < e.size(); i++)
+                        e[i] = state[i] - state_last_sent[i];
+
+                switch (policy) {
+                case Policy::SEND_ON_DELTA:
+                        send = (norm2(e) > threshold * threshold);
+                        break;
+                case Policy::LYAPUNOV:
+                        send = (norm2(e) > threshold * threshold * norm2(state) + TRIGGER_LYAPUNOV_FLOOR);
+                        break;
+                case Policy::SELF_TRIGGERED:
+                        send = (t >= t_next);
+                        break;
+                default:
+                        send = true;
+                }
+        }
+
+        if (!send) {
+                n_suppressed++;
+                return false;
+        }
+
+        mark_sent(t, state);
+        if (policy == Policy::SELF_TRIGGERED) {
+                // Interval grows inversely with the distance from the
+                // equilibrium, from one sampling period up to max_silence.
+                double n = std::sqrt(norm2(state));
+                double interval = (n > 0.0) ? period * threshold / n : max_silence;
+                if (interval < period)
+                        interval = period;
+                if (interval > max_silence)
+                        interval = max_silence;
+                t_next = t + interval;
+        }
+
+        return true;
+}
+
+uint64_t TransmissionTrigger::sent() const
+{
+        return n_sent;
+}
+
+uint64_t TransmissionTrigger::suppressed() const
+{
+        return n_suppressed;
+}
+
+bool TransmissionTrigger::parse_policy(const char *name, Policy &policy)
+{
+        if (strcmp(name, "periodic") == 0)
+                policy = Policy::PERIODIC;
+        else if (strcmp(name, "delta") == 0)
+                policy = Policy::SEND_ON_DELTA;
+        else if (strcmp(name, "lyapunov") == 0)
+                policy = Policy::LYAPUNOV;
+        else if (strcmp(name, "self") == 0)
+                policy = Policy::SELF_TRIGGERED;
+        else
+                return false;
+        return true;
+}
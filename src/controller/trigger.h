@@ -0,0 +1,102 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <stdint.h>
+
+/**
+ * Plant-side transmission policy deciding at every sampling opportunity
+ * whether the state is sent to the controller.
+ *
+ * Deviations are measured in a weighted norm, ||e||^2 = sum_i w_i*e_i^2,
+ * with weights normalizing the state components (see trigger.cc).
+ *
+ * Whatever the policy, a state is sent at least every max_silence seconds
+ * (heartbeat), so the controller can detect a dead plant and the plant
+ * never runs open loop for long.
+ */
+class TransmissionTrigger
+{
+      public:
+        enum class Policy {
+                // Send every sample.
+                PERIODIC,
+                // Send if the state deviates from the last sent state by
+                // more than the threshold.
+                SEND_ON_DELTA,
+                // Send if the deviation from the last sent state exceeds
+                // the fraction threshold of the current state (relative
+                // trigger keeping a quadratic Lyapunov function decreasing),
+                // plus a small absolute dead zone around the equilibrium.
+                LYAPUNOV,
+                // At every transmission, compute the time of the next
+                // transmission from the current state: the closer to the
+                // equilibrium, the longer the interval.
+                SELF_TRIGGERED
+        };
+
+        /**
+         * @param policy transmission policy
+         * @param threshold threshold of the policy (delta: absolute
+         * deviation; Lyapunov: relative deviation; self-triggered: state
+         * norm at which the interval is the sampling period)
+         * @param max_silence maximum time between two transmissions [s]
+         */
+        TransmissionTrigger(Policy policy, double threshold, double max_silence);
+
+        /**
+         * Decide whether to send the state sampled at time t. If so, the
+         * state becomes the last sent state.
+         *
+         * @param t sampling time [s]
+         * @param state sampled state
+         * @return true if the state should be sent.
+         */
+        bool should_send(double t, const pendulum_state_t &state);
+
+        /**
+         * Number of sampling opportunities with and without transmission.
+         */
+        uint64_t sent() const;
+        uint64_t suppressed() const;
+
+        /**
+         * Parse a policy name (periodic, delta, lyapunov, self).
+         *
+         * @param name name of policy
+         * @param policy receives the policy
+         * @return true on success; false if the name is unknown.
+         */
+        static bool parse_policy(const char *name, Policy &policy);
+
+      private:
+        static double norm2(const pendulum_state_t &x);
+        void mark_sent(double t, const pendulum_state_t &state);
+
+        const Policy policy;
+        const double threshold;
+        const double max_silence;
+
+        bool has_sent;
+        double t_last_sent;
+        pendulum_state_t state_last_sent;
+        // Self-triggered: time of next transmission.
+        double t_next;
+        // Sampling period estimated from consecutive calls [s].
+        double t_last_sample;
+        double period;
+
+        uint64_t n_sent;
+        uint64_t n_suppressed;
+};
+
+#endif
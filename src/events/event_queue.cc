@@ -13,12 +13,17 @@ void EventQueue::run(double untilTime)
 {
         scheduleAt(0, step, untilTime); // Schedule the first cyclic UPDATE event
         while (!events.empty() && events.top().time <= untilTime) {
+                EQ_PROFILE(uint64_t t_pop = EventQueueProfile::now());
                 Event next = events.top();
                 events.pop();
+                EQ_PROFILE(uint64_t t_action = EventQueueProfile::now());
+                EQ_PROFILE(profile.pop(next.type, t_action - t_pop));
                 // printf("%d at %f , event %lu \n", next.type, next.time, next.eventId);
                 next.action(next);
+                EQ_PROFILE(profile.action(next.type, EventQueueProfile::now() - t_action));
                 notifyReceivers(next);
         }
+        EQ_PROFILE(profile.print(stderr));
 }
 
 bool EventQueue::empty() const
@@ -31,14 +36,17 @@ double EventQueue::nextTime() const
         return events.top().time;
 }
 
-void EventQueue::addReceiver(std::function<void(const Event &)> cb)
+void EventQueue::addReceiver(std::function<void(const Event &)> cb, [[maybe_unused]] const char *name)
 {
         callbacks.push_back(cb);
+        EQ_PROFILE(profile.add_receiver(name));
 }
 
 void EventQueue::schedule(unsigned long pktNr, double time, Event::Type type, std::function<void(Event &)> action)
 {
+        EQ_PROFILE(uint64_t t_push = EventQueueProfile::now());
         events.push({nextEventId++, pktNr, time, type, action});
+        EQ_PROFILE(profile.push(events.size(), EventQueueProfile::now() - t_push));
 }
 
 void EventQueue::scheduleAt(double startTime, double step, double untilTime)
@@ -54,7 +62,15 @@ void EventQueue::scheduleAt(double startTime, double step, double untilTime)
 
 void EventQueue::notifyReceivers(Event &event)
 {
+#ifdef EVENT_QUEUE_PROFILING
+        for (size_t i = 0; i < callbacks.size(); i++) {
+                uint64_t t_receiver = EventQueueProfile::now();
+                callbacks[i](event);
+                profile.receiver(i, event.type, EventQueueProfile::now() - t_receiver);
+        }
+#else
         for (auto &cb : callbacks) {
                 cb(event);
         }
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #define EVENT_QUEUE_H
 
 #include "event.h"
+#include "event_queue_profile.h"
 #include "event_receiver.h"
 
 #include <functional>
@@ -29,6 +30,9 @@ class EventQueue
         unsigned long nextEventId = 0;
         std::vector<std::function<void(Event &)>> callbacks;
         double step;
+#ifdef EVENT_QUEUE_PROFILING
+        EventQueueProfile profile;
+#endif
 
       public:
         EventQueue()
@@ -59,14 +63,17 @@ class EventQueue
                         std::string recvStr = nextToken(ss);
                         std::string sendStr = nextToken(ss);
 
-                        if (sendStr.empty() || pktStr.empty() || recvStr.empty())
+                        if (sendStr.empty() || pktStr.empty())
                                 continue;
                         double sendTime = std::stod(sendStr);
                         unsigned long pktNr = std::stoul(pktStr);
-                        double rcsvTime = std::stod(recvStr);
                         schedule(pktNr, sendTime, Event::Type::SEND, [this, pktNr, sendTime](Event &event) {
                                 ; // printf("SEND at %f for pkt %lu, event %lu\n", sendTime, pktNr, event.eventId);
                         });
+                        // Lost packet (no receive time): sent, but never received.
+                        if (recvStr.empty())
+                                continue;
+                        double rcsvTime = std::stod(recvStr);
                         schedule(pktNr, rcsvTime, Event::Type::RECEIVE, [this, pktNr, rcsvTime](Event &event) {
                                 ; // printf("RECEIVE at %f for pkt %lu, event %lu\n", rcsvTime, pktNr, event.eventId);
                         });
@@ -78,7 +85,9 @@ class EventQueue
         void run(double untilTime);
         bool empty() const;
         double nextTime() const;
-        void addReceiver(std::function<void(const Event &)> cb);
+        // The name of the receiver is shown in the profile (see
+        // EventQueueProfile).
+        void addReceiver(std::function<void(const Event &)> cb, const char *name = NULL);
         ~EventQueue()
         {
                 ;
@@ -0,0 +1,123 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "event_queue_profile.h"
+
+#include <algorithm>
+#include <time.h>
+
+static const char *type_names[PROFILE_EVENT_TYPES] = {"SEND", "RECEIVE", "UPDATE"};
+
+void EventQueueProfile::Timing::add(uint64_t nsec)
+{
+        n++;
+        total += nsec;
+        max = std::max(max, nsec);
+        int k = 0;
+        while (nsec > 0 && k < PROFILE_HIST_BUCKETS - 1) {
+                nsec >>= 1;
+                k++;
+        }
+        hist[k]++;
+}
+
+uint64_t EventQueueProfile::Timing::percentile(double p) const
+{
+        uint64_t rank = (uint64_t)(p * n);
+        uint64_t count = 0;
+        for (int k = 0; k < PROFILE_HIST_BUCKETS; k++) {
+                count += hist[k];
+                if (count > rank)
+                        return (k == 0) ? 0 : (1ULL << k) - 1;
+        }
+        return max;
+}
+
+EventQueueProfile::EventQueueProfile() : events{0}, high_water_mark(0)
+{
+}
+
+uint64_t EventQueueProfile::now()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void EventQueueProfile::add_receiver(const char *name)
+{
+        if (name != NULL)
+                receiver_names.push_back(name);
+        else
+                receiver_names.push_back("receiver " + std::to_string(receivers.size()));
+        receivers.push_back(std::vector<Timing>(PROFILE_EVENT_TYPES));
+}
+
+void EventQueueProfile::push(size_t queue_size, uint64_t nsec)
+{
+        pushes.add(nsec);
+        high_water_mark = std::max(high_water_mark, queue_size);
+}
+
+void EventQueueProfile::pop(Event::Type type, uint64_t nsec)
+{
+        events[(int)type]++;
+        pops.add(nsec);
+}
+
+void EventQueueProfile::action(Event::Type type, uint64_t nsec)
+{
+        actions[(int)type].add(nsec);
+}
+
+void EventQueueProfile::receiver(size_t receiver, Event::Type type, uint64_t nsec)
+{
+        receivers[receiver][(int)type].add(nsec);
+}
+
+void EventQueueProfile::print_timing(FILE *f, const char *label, const Timing &timing) const
+{
+        if (timing.n == 0)
+                return;
+
+        fprintf(f, "%-28s %10lu %10.3f %9.0f %9lu %9lu %10lu\n", label, (unsigned long)timing.n, 1e-6 * timing.total,
+                (double)timing.total / timing.n, (unsigned long)timing.percentile(0.5),
+                (unsigned long)timing.percentile(0.99), (unsigned long)timing.max);
+
+        // Histogram from the first to the last non-empty bucket, labeled
+        // with the upper bound of the bucket.
+        int first = 0;
+        int last = PROFILE_HIST_BUCKETS - 1;
+        while (timing.hist[first] == 0)
+                first++;
+        while (timing.hist[last] == 0)
+                last--;
+        fprintf(f, "%-28s", "");
+        for (int k = first; k <= last; k++)
+                fprintf(f, " <%llu:%lu", 1ULL << k, (unsigned long)timing.hist[k]);
+        fprintf(f, "\n");
+}
+
+void EventQueueProfile::print(FILE *f) const
+{
+        uint64_t total = events[0] + events[1] + events[2];
+        fprintf(f, "EventQueue profile: %lu events (SEND %lu, RECEIVE %lu, UPDATE %lu), queue high-water mark %zu\n",
+                (unsigned long)total, (unsigned long)events[0], (unsigned long)events[1], (unsigned long)events[2],
+                high_water_mark);
+        fprintf(f, "%-28s %10s %10s %9s %9s %9s %10s\n", "time [ns]", "n", "total [ms]", "mean", "p50 <=", "p99 <=",
+                "max");
+
+        print_timing(f, "push", pushes);
+        print_timing(f, "pop", pops);
+        for (int t = 0; t < PROFILE_EVENT_TYPES; t++)
+                print_timing(f, ("action " + std::string(type_names[t])).c_str(), actions[t]);
+        for (size_t r = 0; r < receivers.size(); r++) {
+                for (int t = 0; t < PROFILE_EVENT_TYPES; t++)
+                        print_timing(f, (receiver_names[r] + " " + type_names[t]).c_str(), receivers[r][t]);
+        }
+}
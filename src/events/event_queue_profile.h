@@ -0,0 +1,114 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef EVENT_QUEUE_PROFILE_H
+#define EVENT_QUEUE_PROFILE_H
+
+#include "event.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Statements of the profiling of the event queue are only compiled in if
+// EVENT_QUEUE_PROFILING is defined (cmake -DEVENT_QUEUE_PROFILING=ON), so
+// the event queue has no overhead otherwise.
+#ifdef EVENT_QUEUE_PROFILING
+#define EQ_PROFILE(statement) statement
+#else
+#define EQ_PROFILE(statement)
+#endif
+
+// Number of buckets of the histograms of the handler times; bucket k
+// counts times in [2^(k-1), 2^k) ns.
+#define PROFILE_HIST_BUCKETS 40
+
+// Number of event types (Event::Type)
+#define PROFILE_EVENT_TYPES 3
+
+/**
+ * Profile of an event queue: number of events per type, time of the heap
+ * operations, time of the actions of the events and of the receivers per
+ * event type (total and histogram), and the high-water mark of the queue.
+ */
+class EventQueueProfile
+{
+      public:
+        EventQueueProfile();
+
+        /**
+         * Monotonic time [ns].
+         */
+        static uint64_t now();
+
+        /**
+         * Add a receiver.
+         *
+         * @param name name of the receiver in the report (NULL: number of
+         * the receiver)
+         */
+        void add_receiver(const char *name);
+
+        /**
+         * Account for an event pushed to the queue.
+         *
+         * @param queue_size size of the queue after the push
+         * @param nsec time of the push [ns]
+         */
+        void push(size_t queue_size, uint64_t nsec);
+
+        /**
+         * Account for an event popped from the queue.
+         *
+         * @param nsec time of the pop (including copying the event) [ns]
+         */
+        void pop(Event::Type type, uint64_t nsec);
+
+        /**
+         * Account for the action of an event (including events scheduled
+         * by the action).
+         */
+        void action(Event::Type type, uint64_t nsec);
+
+        /**
+         * Account for the handling of an event by a receiver.
+         *
+         * @param receiver number of the receiver in the order added
+         */
+        void receiver(size_t receiver, Event::Type type, uint64_t nsec);
+
+        /**
+         * Print the report.
+         */
+        void print(FILE *f) const;
+
+      private:
+        struct Timing {
+                uint64_t n = 0;
+                uint64_t total = 0;
+                uint64_t max = 0;
+                uint64_t hist[PROFILE_HIST_BUCKETS] = {0};
+
+                void add(uint64_t nsec);
+                // Upper bound of the bucket holding percentile p [ns]
+                uint64_t percentile(double p) const;
+        };
+
+        void print_timing(FILE *f, const char *label, const Timing &timing) const;
+
+        uint64_t events[PROFILE_EVENT_TYPES];
+        size_t high_water_mark;
+        Timing pushes;
+        Timing pops;
+        Timing actions[PROFILE_EVENT_TYPES];
+        std::vector<std::string> receiver_names;
+        std::vector<std::vector<Timing>> receivers;
+};
+
+#endif
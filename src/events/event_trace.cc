@@ -0,0 +1,80 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "event_trace.h"
+
+#include <string.h>
+
+// Size of the buffer of the trace file [bytes]
+#define EVENT_TRACE_BUFFER_SIZE (1 << 20)
+
+EventTrace::EventTrace() : file(NULL)
+{
+}
+
+EventTrace::~EventTrace()
+{
+        close();
+}
+
+bool EventTrace::open(const char *path)
+{
+        file = fopen(path, "wb");
+        if (file == NULL)
+                return false;
+        setvbuf(file, NULL, _IOFBF, EVENT_TRACE_BUFFER_SIZE);
+
+        if (fwrite(EVENT_TRACE_MAGIC, strlen(EVENT_TRACE_MAGIC), 1, file) != 1) {
+                fclose(file);
+                file = NULL;
+                return false;
+        }
+
+        return true;
+}
+
+bool EventTrace::close()
+{
+        if (file == NULL)
+                return true;
+
+        int ret = fclose(file);
+        file = NULL;
+
+        return (ret == 0);
+}
+
+void EventTrace::print(const event_record_t &rec, FILE *f)
+{
+        unsigned long id = rec.event_id;
+        unsigned long seq = rec.seq;
+
+        switch (rec.kind) {
+        case PLANT_UPDATE:
+                fprintf(f, "PLANT: update at %f, event %lu, f= %f\n", rec.time, id, rec.value);
+                break;
+        case PLANT_RECEIVE:
+                fprintf(f, "PLANT: receive at %f, event %lu, seqNr %lu\n", rec.time, id, seq);
+                break;
+        case PLANT_SEND:
+                fprintf(f, "PLANT: send at %f, event %lu. next seqNr: %lu. Force: %f%s\n", rec.time, id, seq,
+                        rec.value, (rec.flags & SUPPRESSED) ? " (suppressed)" : "");
+                break;
+        case CONTROLLER_UPDATE:
+                fprintf(f, "CONTROLLER: compute next U = %f at %f, event %lu, pctNr: %lu\n", rec.value, rec.time, id,
+                        seq);
+                break;
+        case CONTROLLER_OUT_OF_ORDER:
+                fprintf(f, "CONTROLLER: out-of-order packet, no update at %f, event %lu, pctNr: %lu\n", rec.time, id,
+                        seq);
+                break;
+        default:
+                fprintf(f, "unknown event record %u at %f, event %lu\n", rec.kind, rec.time, id);
+                break;
+        }
+}
@@ -0,0 +1,113 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include "../utils/log.h"
+#include "event.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// First bytes of an event trace file
+#define EVENT_TRACE_MAGIC "EVTRACE1"
+
+/**
+ * Fixed-size binary record of an event handled by the plant or the
+ * controller of a simulation.
+ */
+struct event_record_t {
+        // Simulated time [s]
+        double time;
+        uint64_t event_id;
+        // Packet sequence number (see EventTrace::Kind)
+        uint64_t seq;
+        // Force or control value [N]
+        double value;
+        uint32_t kind;
+        uint32_t flags;
+};
+
+/**
+ * Trace of the events of a simulation.
+ *
+ * Records are written unformatted to a binary file (see event-trace-dump
+ * for reading them), so tracing costs a copy into the buffer of the file
+ * per event and nothing if no file is open. With the log level trace
+ * (compiled in with LOG_COMPILE_LEVEL trace), every record is also printed
+ * to stderr.
+ */
+class EventTrace
+{
+      public:
+        enum Kind : uint32_t {
+                // Plant simulates one step; value: force
+                PLANT_UPDATE,
+                // Plant receives an update; seq: packet
+                PLANT_RECEIVE,
+                // Plant sends its state; seq: next packet, value: force
+                PLANT_SEND,
+                // Controller computes an update; seq: packet, value: update
+                CONTROLLER_UPDATE,
+                // Controller ignores an out-of-order packet; seq: packet
+                CONTROLLER_OUT_OF_ORDER
+        };
+
+        // Flag of PLANT_SEND: the transmission policy suppressed the packet.
+        static const uint32_t SUPPRESSED = 1;
+
+        EventTrace();
+        ~EventTrace();
+
+        /**
+         * Open the trace file.
+         *
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *path);
+
+        /**
+         * Flush and close the trace file.
+         *
+         * @return true on success; false on error (errno is set).
+         */
+        bool close();
+
+        /**
+         * Record an event.
+         */
+        void record(Kind kind, const Event &e, uint64_t seq, double value, uint32_t flags = 0)
+        {
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_TRACE
+                if (file == NULL && log_level < LOG_LEVEL_TRACE)
+                        return;
+#else
+                if (file == NULL)
+                        return;
+#endif
+                event_record_t rec = {e.time, e.eventId, seq, value, kind, flags};
+                if (file != NULL)
+                        fwrite(&rec, sizeof(rec), 1, file);
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_TRACE
+                if (log_level >= LOG_LEVEL_TRACE)
+                        print(rec, stderr);
+#endif
+        }
+
+        /**
+         * Print a record as text.
+         */
+        static void print(const event_record_t &rec, FILE *f);
+
+      private:
+        FILE *file;
+};
+
+#endif
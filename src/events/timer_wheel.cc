@@ -0,0 +1,97 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "timer_wheel.h"
+
+static uint32_t round_up_pow2(uint32_t n)
+{
+        uint32_t p = 64;
+        while (p < n)
+                p <<= 1;
+        return p;
+}
+
+TimerWheel::TimerWheel(uint32_t n_slots, uint32_t max_timers, uint64_t now)
+        : n_slots(round_up_pow2(n_slots)), mask(round_up_pow2(n_slots) - 1), slots(round_up_pow2(n_slots), NIL),
+          occupied(round_up_pow2(n_slots) / 64, 0), entries(max_timers), free_list(NIL), n_scheduled(0), current(now)
+{
+        for (uint32_t i = 0; i < max_timers; i++) {
+                entries[i].next = free_list;
+                free_list = i;
+        }
+}
+
+bool TimerWheel::schedule(uint64_t expiry, uint32_t id)
+{
+        if (free_list == NIL)
+                return false;
+
+        uint32_t idx = free_list;
+        Entry &e = entries[idx];
+        free_list = e.next;
+
+        // Timers in the past are put into the current slot to fire with
+        // the next advance.
+        uint32_t slot = (expiry < current ? current : expiry) & mask;
+        e.expiry = expiry;
+        e.id = id;
+        e.next = slots[slot];
+        slots[slot] = idx;
+        set_occupied(slot);
+        n_scheduled++;
+
+        return true;
+}
+
+bool TimerWheel::next_expiry(uint64_t &next) const
+{
+        if (n_scheduled == 0)
+                return false;
+
+        uint32_t start = current & mask;
+        uint32_t slot;
+        if (!find_occupied(start, slot))
+                return false;
+        next = current + ((slot - start) & mask);
+
+        return true;
+}
+
+uint32_t TimerWheel::size() const
+{
+        return n_scheduled;
+}
+
+void TimerWheel::set_occupied(uint32_t slot)
+{
+        occupied[slot >> 6] |= (1ull << (slot & 63));
+}
+
+void TimerWheel::clear_occupied(uint32_t slot)
+{
+        occupied[slot >> 6] &= ~(1ull << (slot & 63));
+}
+
+bool TimerWheel::find_occupied(uint32_t from, uint32_t &slot) const
+{
+        const uint32_t n_words = occupied.size();
+        uint32_t word = from >> 6;
+
+        // First word: ignore bits before from.
+        uint64_t bits = occupied[word] & (~0ull << (from & 63));
+        for (uint32_t i = 0; i <= n_words; i++) {
+                if (bits) {
+                        slot = (word << 6) + __builtin_ctzll(bits);
+                        return true;
+                }
+                word = (word + 1) % n_words;
+                bits = occupied[word];
+        }
+
+        return false;
+}
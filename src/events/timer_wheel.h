@@ -0,0 +1,155 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Hashed timing wheel with a resolution of one tick.
+ *
+ * Timers are identified by a user-defined id (e.g., an index into a pool of
+ * objects). Scheduling and cancellation-free expiry are O(1); timers further
+ * in the future than one revolution of the wheel stay in their slot until
+ * their round has come. A bitmap of non-empty slots allows for finding the
+ * next occupied slot without scanning empty slots one by one.
+ *
+ * All entries are pre-allocated, so no memory is allocated after
+ * construction.
+ */
+class TimerWheel
+{
+      public:
+        /**
+         * @param n_slots number of slots (rounded up to a power of 2)
+         * @param max_timers maximum number of concurrently scheduled timers
+         * @param now current time [ticks]
+         */
+        TimerWheel(uint32_t n_slots, uint32_t max_timers, uint64_t now);
+
+        /**
+         * Schedule a timer.
+         *
+         * Timers scheduled in the past expire with the next call of advance().
+         *
+         * @param expiry expiry time [ticks]
+         * @param id user-defined id passed back on expiry
+         * @return true on success; false if max_timers timers are already scheduled.
+         */
+        bool schedule(uint64_t expiry, uint32_t id);
+
+        /**
+         * Advance the wheel to the given time and fire all timers that
+         * expired until then (inclusive).
+         *
+         * @param now current time [ticks]
+         * @param fire callable fire(uint32_t id, uint64_t expiry) called for every expired timer
+         */
+        template <typename F>
+        void advance(uint64_t now, F fire);
+
+        /**
+         * Lower bound of the expiry time of the next timer.
+         *
+         * @param next receives the time of the next non-empty slot [ticks]
+         * @return false if no timer is scheduled.
+         */
+        bool next_expiry(uint64_t &next) const;
+
+        /**
+         * Number of scheduled timers.
+         */
+        uint32_t size() const;
+
+      private:
+        static constexpr uint32_t NIL = UINT32_MAX;
+
+        struct Entry {
+                uint64_t expiry;
+                uint32_t id;
+                uint32_t next;
+        };
+
+        void set_occupied(uint32_t slot);
+        void clear_occupied(uint32_t slot);
+        bool find_occupied(uint32_t from, uint32_t &slot) const;
+        template <typename F>
+        void fire_slot(uint32_t slot, uint64_t now, F &fire);
+
+        const uint32_t n_slots;
+        const uint32_t mask;
+        // Head of the entry list of every slot.
+        std::vector<uint32_t> slots;
+        // One bit per slot, set if the slot is not empty.
+        std::vector<uint64_t> occupied;
+        std::vector<Entry> entries;
+        uint32_t free_list;
+        uint32_t n_scheduled;
+        // Time up to which all timers have been fired.
+        uint64_t current;
+};
+
+template <typename F>
+void TimerWheel::advance(uint64_t now, F fire)
+{
+        // Time did not advance, but timers might have been scheduled in the
+        // past (into the current slot) since the last call.
+        if (now < current) {
+                fire_slot(current & mask, now, fire);
+                return;
+        }
+
+        // Visit every occupied slot between the current time and now, but
+        // every slot at most once.
+        uint64_t span = now - current;
+        uint32_t n_visit = (span >= n_slots) ? n_slots : (uint32_t)span + 1;
+        uint32_t start = current & mask;
+        uint32_t visited = 0;
+
+        // Timers scheduled by fire() must not go into slots already visited.
+        current = now + 1;
+
+        while (visited < n_visit && n_scheduled > 0) {
+                uint32_t slot;
+                if (!find_occupied((start + visited) & mask, slot))
+                        break;
+                uint32_t dist = (slot - start) & mask;
+                if (dist >= n_visit || dist < visited)
+                        break;
+
+                fire_slot(slot, now, fire);
+
+                visited = dist + 1;
+        }
+}
+
+template <typename F>
+void TimerWheel::fire_slot(uint32_t slot, uint64_t now, F &fire)
+{
+        // Fire all timers of this slot whose round has come.
+        uint32_t *link = &slots[slot];
+        while (*link != NIL) {
+                Entry &e = entries[*link];
+                if (e.expiry <= now) {
+                        uint32_t idx = *link;
+                        *link = e.next;
+                        e.next = free_list;
+                        free_list = idx;
+                        n_scheduled--;
+                        fire(e.id, e.expiry);
+                } else {
+                        link = &e.next;
+                }
+        }
+        if (slots[slot] == NIL)
+                clear_occupied(slot);
+}
+
+#endif
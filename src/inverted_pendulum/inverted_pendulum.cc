@@ -106,3 +106,10 @@ void InvertedPendulum::simulate(double dt, state_sequence_t &states)
 
         t += dt;
 }
+
+void InvertedPendulum::step(double dt)
+{
+        rk4().do_step(*this, state, t, dt);
+
+        t += dt;
+}
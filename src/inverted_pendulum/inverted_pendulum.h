@@ -90,6 +90,14 @@ class InvertedPendulum : public EventReceiver
          */
         void simulate(double dt, state_sequence_t &states);
 
+        /**
+         * Advance the system by one integration step without recording
+         * intermediate states (no allocation).
+         *
+         * @param dt step size [s]
+         */
+        void step(double dt);
+
         /**
          * Functor: object can be called by boost::odeint to calculate the derivatives dxdt
          * of the equations of motion.
@@ -0,0 +1,212 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "shm_transport.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Marks a completely initialized segment.
+#define SHM_MAGIC 0x4e435331
+
+// Number of polls of the ring before sleeping on the futex.
+#define SHM_SPIN_ITERATIONS 1000
+
+// Interval for checking whether the controller has created the segment [ns]
+#define SHM_ATTACH_RETRY_NSEC 10000000
+
+struct ShmTransport::Segment {
+        std::atomic<uint32_t> magic;
+        ShmChannel to_controller;
+        ShmChannel to_plant;
+};
+
+static long futex(std::atomic<uint32_t> *addr, int op, uint32_t val, const struct timespec *timeout = NULL)
+{
+        return syscall(SYS_futex, (uint32_t *)addr, op, val, timeout, NULL, 0);
+}
+
+static inline uint64_t monotonic_usec()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+}
+
+ShmTransport::ShmTransport()
+        : segment(nullptr), tx(nullptr), rx(nullptr), role(Role::PLANT), wakeup(Wakeup::FUTEX),
+          recv_timeout_usec(0)
+{
+        name[0] = '\0';
+}
+
+ShmTransport::~ShmTransport()
+{
+        if (segment) {
+                munmap(segment, sizeof(Segment));
+                if (role == Role::CONTROLLER)
+                        shm_unlink(name);
+        }
+}
+
+bool ShmTransport::open(const char *name, Role role, Wakeup wakeup)
+{
+        this->role = role;
+        this->wakeup = wakeup;
+        strncpy(this->name, name, sizeof(this->name) - 1);
+        this->name[sizeof(this->name) - 1] = '\0';
+
+        int fd;
+        if (role == Role::CONTROLLER) {
+                // Remove stale segment of a previous run.
+                shm_unlink(name);
+                fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+                if (fd == -1)
+                        return false;
+                if (ftruncate(fd, sizeof(Segment)) == -1) {
+                        close(fd);
+                        return false;
+                }
+        } else {
+                const struct timespec retry = {0, SHM_ATTACH_RETRY_NSEC};
+                struct stat st;
+                while (true) {
+                        fd = shm_open(name, O_RDWR, 0);
+                        if (fd == -1 && errno != ENOENT)
+                                return false;
+                        if (fd != -1) {
+                                if (fstat(fd, &st) == -1) {
+                                        close(fd);
+                                        return false;
+                                }
+                                if ((size_t)st.st_size >= sizeof(Segment))
+                                        break;
+                                close(fd);
+                        }
+                        nanosleep(&retry, NULL);
+                }
+        }
+
+        void *addr = mmap(NULL, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+                return false;
+
+        if (role == Role::CONTROLLER) {
+                segment = new (addr) Segment();
+                segment->to_controller.seq.store(0);
+                segment->to_controller.waiting.store(0);
+                segment->to_plant.seq.store(0);
+                segment->to_plant.waiting.store(0);
+                segment->magic.store(SHM_MAGIC, std::memory_order_release);
+                tx = &segment->to_plant;
+                rx = &segment->to_controller;
+        } else {
+                segment = (Segment *)addr;
+                const struct timespec retry = {0, SHM_ATTACH_RETRY_NSEC};
+                while (segment->magic.load(std::memory_order_acquire) != SHM_MAGIC)
+                        nanosleep(&retry, NULL);
+                tx = &segment->to_controller;
+                rx = &segment->to_plant;
+        }
+
+        return true;
+}
+
+ssize_t ShmTransport::send(const uint8_t *data, size_t len)
+{
+        if (len > SHM_MAX_MSG_SIZE) {
+                errno = EMSGSIZE;
+                return -1;
+        }
+
+        shm_message_t msg;
+        msg.len = len;
+        memcpy(msg.data, data, len);
+        if (!tx->ring.push(msg)) {
+                // Receiver does not keep up. Like UDP, drop the message.
+                errno = EAGAIN;
+                return -1;
+        }
+
+        tx->seq.fetch_add(1);
+        if (wakeup == Wakeup::FUTEX && tx->waiting.load())
+                futex(&tx->seq, FUTEX_WAKE, 1);
+
+        return len;
+}
+
+ssize_t ShmTransport::recv(uint8_t *data, size_t max_len)
+{
+        shm_message_t msg;
+        unsigned int spins = 0;
+        uint64_t deadline_usec = (recv_timeout_usec > 0) ? monotonic_usec() + recv_timeout_usec : 0;
+
+        while (!rx->ring.pop(msg)) {
+                cpu_relax();
+                if (++spins < SHM_SPIN_ITERATIONS)
+                        continue;
+                spins = 0;
+
+                struct timespec timeout;
+                if (recv_timeout_usec > 0) {
+                        uint64_t now_usec = monotonic_usec();
+                        if (now_usec >= deadline_usec) {
+                                errno = EAGAIN;
+                                return -1;
+                        }
+                        timeout.tv_sec = (deadline_usec - now_usec) / 1000000;
+                        timeout.tv_nsec = ((deadline_usec - now_usec) % 1000000) * 1000;
+                }
+                if (wakeup == Wakeup::BUSY_POLL)
+                        continue;
+
+                // Announce that we are going to sleep, then check the ring
+                // once more. A sender either sees the waiting flag or has
+                // pushed its message before our last check.
+                uint32_t seq = rx->seq.load();
+                rx->waiting.store(1);
+                if (rx->ring.pop(msg)) {
+                        rx->waiting.store(0);
+                        break;
+                }
+                long ret = futex(&rx->seq, FUTEX_WAIT, seq, (recv_timeout_usec > 0) ? &timeout : NULL);
+                rx->waiting.store(0);
+                if (ret == -1 && errno == EINTR)
+                        return -1;
+        }
+
+        if (msg.len > max_len) {
+                errno = EMSGSIZE;
+                return -1;
+        }
+        memcpy(data, msg.data, msg.len);
+
+        return msg.len;
+}
+
+bool ShmTransport::set_recv_timeout(unsigned int usec)
+{
+        recv_timeout_usec = usec;
+        return true;
+}
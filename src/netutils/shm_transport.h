@@ -0,0 +1,97 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef SHM_TRANSPORT_H
+#define SHM_TRANSPORT_H
+
+#include <atomic>
+
+#include "../utils/spsc_ring.h"
+#include "transport.h"
+
+// Maximum size of a message exchanged via shared memory [bytes]
+#define SHM_MAX_MSG_SIZE 508
+
+// Capacity of each ring in messages (must be a power of 2).
+#define SHM_RING_CAPACITY 1024
+
+struct shm_message_t {
+        uint32_t len;
+        uint8_t data[SHM_MAX_MSG_SIZE];
+};
+
+/**
+ * One direction of the shared-memory transport: a lock-free SPSC ring plus
+ * a futex word for waking up a sleeping receiver.
+ */
+struct ShmChannel {
+        SpscRing<shm_message_t, SHM_RING_CAPACITY> ring;
+        // Incremented with every message; receivers wait on it.
+        alignas(64) std::atomic<uint32_t> seq;
+        // Set while the receiver is (about to go) asleep.
+        std::atomic<uint32_t> waiting;
+};
+
+/**
+ * Transport between a plant and a controller running on the same host.
+ *
+ * Messages are exchanged via two lock-free SPSC rings (one per direction)
+ * in a POSIX shared-memory segment, avoiding socket system calls and
+ * kernel copies. A receiver waiting for a message either busy-polls the
+ * ring, or spins shortly and then sleeps on a futex, which the sender only
+ * wakes up if the receiver is actually asleep.
+ *
+ * The controller creates the segment; the plant attaches to it.
+ */
+class ShmTransport : public Transport
+{
+      public:
+        enum class Role {
+                PLANT,
+                CONTROLLER
+        };
+
+        enum class Wakeup {
+                // Spin shortly, then sleep on a futex.
+                FUTEX,
+                // Spin until a message arrives (burns one core per receiver).
+                BUSY_POLL
+        };
+
+        ShmTransport();
+        ~ShmTransport();
+
+        /**
+         * Create (controller) or attach to (plant) the shared-memory segment.
+         * The plant waits until the controller has created the segment.
+         *
+         * @param name name of the segment (see shm_open())
+         * @param role role of this side
+         * @param wakeup how to wait for messages
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *name, Role role, Wakeup wakeup);
+
+        ssize_t send(const uint8_t *data, size_t len) override;
+        ssize_t recv(uint8_t *data, size_t max_len) override;
+        bool set_recv_timeout(unsigned int usec) override;
+
+      private:
+        struct Segment;
+
+        Segment *segment;
+        ShmChannel *tx;
+        ShmChannel *rx;
+        Role role;
+        Wakeup wakeup;
+        // Timeout of recv() (0: none) [us]
+        unsigned int recv_timeout_usec;
+        char name[256];
+};
+
+#endif
@@ -0,0 +1,161 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "state_feed.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Marks a completely initialized segment.
+#define STATE_FEED_MAGIC 0x4e435346
+
+// Interval for checking whether the publisher has created the segment [ns]
+#define STATE_FEED_ATTACH_RETRY_NSEC 10000000
+
+StateFeedPublisher::StateFeedPublisher() : segment(nullptr)
+{
+        name[0] = '\0';
+}
+
+StateFeedPublisher::~StateFeedPublisher()
+{
+        if (segment) {
+                segment->closed.store(1, std::memory_order_release);
+                munmap(segment, sizeof(StateFeedSegment));
+                shm_unlink(name);
+        }
+}
+
+bool StateFeedPublisher::open(const char *name)
+{
+        strncpy(this->name, name, sizeof(this->name) - 1);
+        this->name[sizeof(this->name) - 1] = '\0';
+
+        // Remove stale segment of a previous run. Viewers still attached
+        // to it see it closed only if the run ended normally.
+        shm_unlink(name);
+        int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1)
+                return false;
+        if (ftruncate(fd, sizeof(StateFeedSegment)) == -1) {
+                close(fd);
+                shm_unlink(name);
+                return false;
+        }
+        void *addr = mmap(NULL, sizeof(StateFeedSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+                shm_unlink(name);
+                return false;
+        }
+
+        segment = new (addr) StateFeedSegment();
+        segment->closed.store(0);
+        segment->head.store(0);
+        segment->magic.store(STATE_FEED_MAGIC, std::memory_order_release);
+
+        return true;
+}
+
+bool StateFeedPublisher::is_open() const
+{
+        return (segment != nullptr);
+}
+
+void StateFeedPublisher::publish(double t, const pendulum_state_t &state)
+{
+        uint64_t index = segment->head.load(std::memory_order_relaxed);
+        feed_sample_t sample = {index, t, state};
+        segment->slots[index & (STATE_FEED_CAPACITY - 1)].store(sample);
+        segment->head.store(index + 1, std::memory_order_release);
+}
+
+StateFeedReader::StateFeedReader() : segment(nullptr)
+{
+}
+
+StateFeedReader::~StateFeedReader()
+{
+        if (segment)
+                munmap(segment, sizeof(StateFeedSegment));
+}
+
+bool StateFeedReader::open(const char *name)
+{
+        const struct timespec retry = {0, STATE_FEED_ATTACH_RETRY_NSEC};
+        int fd;
+        struct stat st;
+        while (true) {
+                fd = shm_open(name, O_RDONLY, 0);
+                if (fd == -1 && errno != ENOENT)
+                        return false;
+                if (fd != -1) {
+                        if (fstat(fd, &st) == -1) {
+                                close(fd);
+                                return false;
+                        }
+                        if ((size_t)st.st_size >= sizeof(StateFeedSegment))
+                                break;
+                        close(fd);
+                }
+                nanosleep(&retry, NULL);
+        }
+
+        // Readers only read; the seqlocks need no write access.
+        void *addr = mmap(NULL, sizeof(StateFeedSegment), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED)
+                return false;
+        segment = (StateFeedSegment *)addr;
+        while (segment->magic.load(std::memory_order_acquire) != STATE_FEED_MAGIC)
+                nanosleep(&retry, NULL);
+
+        return true;
+}
+
+bool StateFeedReader::read(uint64_t index, feed_sample_t &sample) const
+{
+        if (index >= published())
+                return false;
+        sample = segment->slots[index & (STATE_FEED_CAPACITY - 1)].load();
+
+        // The slot may have been reused for a newer state.
+        return (sample.index == index);
+}
+
+bool StateFeedReader::latest(feed_sample_t &sample) const
+{
+        uint64_t head = published();
+        while (head > 0) {
+                if (read(head - 1, sample))
+                        return true;
+                // Overtaken while reading; try the new head.
+                uint64_t next = published();
+                if (next == head)
+                        return false;
+                head = next;
+        }
+
+        return false;
+}
+
+uint64_t StateFeedReader::published() const
+{
+        return segment->head.load(std::memory_order_acquire);
+}
+
+bool StateFeedReader::closed() const
+{
+        return (segment->closed.load(std::memory_order_acquire) != 0);
+}
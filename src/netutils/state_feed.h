@@ -0,0 +1,132 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef STATE_FEED_H
+#define STATE_FEED_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "../utils/seqlock.h"
+
+#include <atomic>
+#include <stdint.h>
+
+// Number of states kept in the feed (must be a power of 2).
+#define STATE_FEED_CAPACITY 4096
+
+struct feed_sample_t {
+        // Number of the state (0 for the first published state)
+        uint64_t index;
+        double t;
+        pendulum_state_t state;
+};
+
+/**
+ * Live feed of the pendulum state from a running simulation to any number
+ * of viewers on the same host (see StateFeedPublisher and
+ * StateFeedReader).
+ *
+ * The states are published into a ring in a POSIX shared-memory segment,
+ * each slot protected by a seqlock. The publisher overwrites the oldest
+ * slot and never waits for readers, so a slow viewer cannot slow down the
+ * simulation; it just misses states (readers take the newest one).
+ */
+struct StateFeedSegment {
+        std::atomic<uint32_t> magic;
+        // Set when the publisher has finished.
+        std::atomic<uint32_t> closed;
+        // Number of states published so far.
+        alignas(64) std::atomic<uint64_t> head;
+        Seqlock<feed_sample_t> slots[STATE_FEED_CAPACITY];
+};
+
+class StateFeedPublisher
+{
+      public:
+        StateFeedPublisher();
+
+        /**
+         * Marks the feed as closed and removes the segment.
+         */
+        ~StateFeedPublisher();
+
+        /**
+         * Create the shared-memory segment (a stale segment of the same
+         * name is replaced).
+         *
+         * @param name name of the segment (see shm_open())
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *name);
+
+        /**
+         * @return true if the feed has been opened.
+         */
+        bool is_open() const;
+
+        /**
+         * Publish a state (wait-free).
+         *
+         * @param t time [s]
+         * @param state state
+         */
+        void publish(double t, const pendulum_state_t &state);
+
+      private:
+        StateFeedSegment *segment;
+        char name[256];
+};
+
+class StateFeedReader
+{
+      public:
+        StateFeedReader();
+        ~StateFeedReader();
+
+        /**
+         * Attach to the segment of a publisher. Waits until the publisher
+         * has created it.
+         *
+         * @param name name of the segment (see shm_open())
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *name);
+
+        /**
+         * Get the newest state.
+         *
+         * @param sample receives the newest state
+         * @return true on success; false if nothing has been published
+         * yet.
+         */
+        bool latest(feed_sample_t &sample) const;
+
+        /**
+         * Get a published state if it is still in the ring.
+         *
+         * @param index number of the state
+         * @param sample receives the state
+         * @return true on success; false if the state has not been
+         * published yet or has been overwritten.
+         */
+        bool read(uint64_t index, feed_sample_t &sample) const;
+
+        /**
+         * Number of states published so far.
+         */
+        uint64_t published() const;
+
+        /**
+         * @return true if the publisher has finished.
+         */
+        bool closed() const;
+
+      private:
+        StateFeedSegment *segment;
+};
+
+#endif
@@ -0,0 +1,198 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "transport.h"
+#include "socket_utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+// Size of the control message buffer for receive timestamps [bytes]
+#define CMSG_BUF_SIZE 64
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+}
+
+static inline uint64_t monotonic_nsec()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+UdpClientTransport::UdpClientTransport() : sock(-1)
+{
+}
+
+UdpClientTransport::~UdpClientTransport()
+{
+        if (sock != -1)
+                close(sock);
+}
+
+bool UdpClientTransport::open(const char *hostname, const char *service)
+{
+        sock = datagram_client_socket(hostname, service);
+        return (sock != -1);
+}
+
+ssize_t UdpClientTransport::send(const uint8_t *data, size_t len)
+{
+        return ::send(sock, data, len, 0);
+}
+
+ssize_t UdpClientTransport::recv(uint8_t *data, size_t max_len)
+{
+        return ::recv(sock, data, max_len, 0);
+}
+
+bool UdpClientTransport::set_recv_timeout(unsigned int usec)
+{
+        struct timeval tv;
+        tv.tv_sec = usec / 1000000;
+        tv.tv_usec = usec % 1000000;
+        return (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) == 0);
+}
+
+UdpServerTransport::UdpServerTransport()
+        : sock(-1), peer_addr_len(0), spin_usec(0), rx_timestamps(false), has_rx_ts(false), n_spin_hits(0),
+          n_block_hits(0)
+{
+}
+
+UdpServerTransport::~UdpServerTransport()
+{
+        if (sock != -1)
+                close(sock);
+}
+
+bool UdpServerTransport::open(const char *service)
+{
+        return (datagram_server_sockets(NULL, service, AF_UNSPEC, 0, &sock, 1) == 1);
+}
+
+ssize_t UdpServerTransport::send(const uint8_t *data, size_t len)
+{
+        return sendto(sock, data, len, 0, (struct sockaddr *)&peer_addr, peer_addr_len);
+}
+
+socklen_t UdpServerTransport::peer_address(struct sockaddr_storage &addr) const
+{
+        memcpy(&addr, &peer_addr, peer_addr_len);
+        return peer_addr_len;
+}
+
+bool UdpServerTransport::set_busy_poll(unsigned int spin_usec)
+{
+        this->spin_usec = spin_usec;
+
+        int flags = fcntl(sock, F_GETFL);
+        if (flags == -1 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) == -1)
+                return false;
+
+        int val = spin_usec;
+        if (setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val)) == -1)
+                return false;
+        val = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_PREFER_BUSY_POLL, &val, sizeof(val)) == -1)
+                return false;
+
+        return true;
+}
+
+bool UdpServerTransport::enable_rx_timestamps()
+{
+        int val = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &val, sizeof(val)) == -1)
+                return false;
+        rx_timestamps = true;
+        return true;
+}
+
+bool UdpServerTransport::rx_timestamp(struct timespec &ts) const
+{
+        ts = rx_ts;
+        return has_rx_ts;
+}
+
+ssize_t UdpServerTransport::recv_once(uint8_t *data, size_t max_len, int flags)
+{
+        peer_addr_len = sizeof(peer_addr);
+        if (!rx_timestamps)
+                return recvfrom(sock, data, max_len, flags, (struct sockaddr *)&peer_addr, &peer_addr_len);
+
+        struct iovec iov = {data, max_len};
+        uint8_t cmsg_buf[CMSG_BUF_SIZE];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &peer_addr;
+        msg.msg_namelen = sizeof(peer_addr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cmsg_buf;
+        msg.msg_controllen = sizeof(cmsg_buf);
+
+        ssize_t n = recvmsg(sock, &msg, flags);
+        if (n == -1)
+                return -1;
+        peer_addr_len = msg.msg_namelen;
+
+        has_rx_ts = false;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                        memcpy(&rx_ts, CMSG_DATA(cmsg), sizeof(rx_ts));
+                        has_rx_ts = true;
+                }
+        }
+
+        return n;
+}
+
+ssize_t UdpServerTransport::recv(uint8_t *data, size_t max_len)
+{
+        if (spin_usec == 0)
+                return recv_once(data, max_len, 0);
+
+        // Spin ...
+        uint64_t deadline = monotonic_nsec() + spin_usec * 1000ull;
+        do {
+                ssize_t n = recv_once(data, max_len, MSG_DONTWAIT);
+                if (n >= 0) {
+                        n_spin_hits++;
+                        return n;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        return -1;
+                cpu_relax();
+        } while (monotonic_nsec() < deadline);
+
+        // ... then block.
+        struct pollfd pfd = {sock, POLLIN, 0};
+        while (true) {
+                if (poll(&pfd, 1, -1) == -1)
+                        return -1;
+                ssize_t n = recv_once(data, max_len, MSG_DONTWAIT);
+                if (n >= 0) {
+                        n_block_hits++;
+                        return n;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                        return -1;
+        }
+}
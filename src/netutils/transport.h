@@ -0,0 +1,184 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * Message-oriented transport between plant and controller.
+ *
+ * A transport connects exactly one plant and one controller (except for the
+ * UDP server transport, which answers the sender of the last received
+ * message). recv() and send() may be called from different threads, but
+ * each of them only from one thread.
+ */
+class Transport
+{
+      public:
+        virtual ~Transport() = default;
+
+        /**
+         * Send a message to the peer. For a server transport, the peer is
+         * the sender of the last received message.
+         *
+         * @param data message
+         * @param len length of message [bytes]
+         * @return number of bytes sent; -1 on error (errno is set).
+         */
+        virtual ssize_t send(const uint8_t *data, size_t len) = 0;
+
+        /**
+         * Receive the next message. Blocks until a message is available
+         * or the wait is interrupted by a signal (errno is EINTR).
+         *
+         * @param data buffer receiving the message
+         * @param max_len size of buffer [bytes]
+         * @return length of message [bytes]; -1 on error (errno is set).
+         */
+        virtual ssize_t recv(uint8_t *data, size_t max_len) = 0;
+
+        /**
+         * Limit the time recv() waits for a message. If no message arrives
+         * in time, recv() fails with errno EAGAIN.
+         *
+         * @param usec timeout [us]; 0: wait without limit
+         * @return true on success; false on error (errno is set; ENOTSUP
+         * if the transport has no timeout).
+         */
+        virtual bool set_recv_timeout(unsigned int /* usec */)
+        {
+                errno = ENOTSUP;
+                return false;
+        }
+
+        /**
+         * Address of the peer, i.e., for a server transport the sender of
+         * the last received message. It identifies the plant of a message
+         * if the transport serves several plants.
+         *
+         * @param addr receives the address
+         * @return length of the address; 0 if the transport has a single
+         * peer.
+         */
+        virtual socklen_t peer_address(struct sockaddr_storage & /* addr */) const
+        {
+                return 0;
+        }
+};
+
+/**
+ * UDP transport of the plant sending to a fixed controller address.
+ */
+class UdpClientTransport : public Transport
+{
+      public:
+        UdpClientTransport();
+        ~UdpClientTransport();
+
+        /**
+         * Create a datagram socket "connected" to the controller.
+         *
+         * @param hostname hostname or IP address of controller
+         * @param service service name or port number of controller
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *hostname, const char *service);
+
+        ssize_t send(const uint8_t *data, size_t len) override;
+        ssize_t recv(uint8_t *data, size_t max_len) override;
+        bool set_recv_timeout(unsigned int usec) override;
+
+      private:
+        int sock;
+};
+
+/**
+ * UDP transport of the controller answering the sender of the last
+ * received message.
+ *
+ * By default, recv() blocks in the kernel. In busy-poll mode, the socket is
+ * non-blocking and recv() polls it for a bounded time before blocking
+ * (spin-then-block), trading CPU time for a shorter wakeup latency. The
+ * kernel is additionally asked to busy-poll the device queue
+ * (SO_BUSY_POLL, SO_PREFER_BUSY_POLL) where the driver supports it.
+ */
+class UdpServerTransport : public Transport
+{
+      public:
+        UdpServerTransport();
+        ~UdpServerTransport();
+
+        /**
+         * Create a datagram socket bound to the given service.
+         *
+         * @param service service name or port number
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *service);
+
+        /**
+         * Switch to busy-poll mode. Must be called after open().
+         *
+         * Spinning in user space is enabled in any case. Kernel busy
+         * polling might be denied (e.g., SO_BUSY_POLL values above
+         * net.core.busy_read require CAP_NET_ADMIN).
+         *
+         * @param spin_usec maximum time to poll before blocking [us]
+         * @return true if kernel busy polling was enabled; false otherwise
+         * (errno is set).
+         */
+        bool set_busy_poll(unsigned int spin_usec);
+
+        /**
+         * Let the kernel timestamp received datagrams (see rx_timestamp()).
+         *
+         * @return true on success; false on error (errno is set).
+         */
+        bool enable_rx_timestamps();
+
+        /**
+         * Kernel receive timestamp (CLOCK_REALTIME) of the last message
+         * returned by recv().
+         *
+         * @param ts timestamp
+         * @return true if the last message carried a timestamp.
+         */
+        bool rx_timestamp(struct timespec &ts) const;
+
+        /**
+         * Number of messages received while spinning and after blocking,
+         * respectively (busy-poll mode only).
+         */
+        uint64_t spin_hits() const { return n_spin_hits; }
+        uint64_t block_hits() const { return n_block_hits; }
+
+        ssize_t send(const uint8_t *data, size_t len) override;
+        ssize_t recv(uint8_t *data, size_t max_len) override;
+        socklen_t peer_address(struct sockaddr_storage &addr) const override;
+
+      private:
+        ssize_t recv_once(uint8_t *data, size_t max_len, int flags);
+
+        int sock;
+        struct sockaddr_storage peer_addr;
+        socklen_t peer_addr_len;
+        unsigned int spin_usec;
+        bool rx_timestamps;
+        bool has_rx_ts;
+        struct timespec rx_ts;
+        uint64_t n_spin_hits;
+        uint64_t n_block_hits;
+};
+
+#endif
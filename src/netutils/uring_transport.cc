@@ -0,0 +1,447 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "uring_transport.h"
+#include "socket_utils.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Number of submission queue entries per ring.
+#define URING_SQ_ENTRIES 256
+
+// Number of completion queue entries per ring.
+#define URING_CQ_ENTRIES 1024
+
+// Buffer group id of the receive buffers.
+#define URING_RX_BGID 0
+
+// user_data of the multishot receive request. Send requests use the index
+// of their send slot as user_data.
+#define URING_RX_TAG UINT64_MAX
+
+static inline unsigned load_acquire(const unsigned *p)
+{
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(unsigned *p, unsigned v)
+{
+        __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+UringTransport::UringTransport()
+        : sock(-1), reply_to_sender(false), batch_sends(false), tx_ring(&rx_ring), buf_ring(nullptr),
+          buf_ring_len(0), rx_buffers(nullptr), buf_ring_tail(0), recv_armed(false), recv_timeout_usec(0),
+          rx_pending_head(0),
+          peer_addr_len(0), n_syscalls(0)
+{
+        memset(&rx_msg, 0, sizeof(rx_msg));
+}
+
+UringTransport::~UringTransport()
+{
+        destroy_ring(rx_ring);
+        destroy_ring(tx_ring_separate);
+        if (buf_ring)
+                munmap(buf_ring, buf_ring_len);
+        delete[] rx_buffers;
+        if (sock != -1)
+                close(sock);
+}
+
+bool UringTransport::open_client(const char *hostname, const char *service, bool batch_sends)
+{
+        int s = datagram_client_socket(hostname, service);
+        if (s == -1)
+                return false;
+
+        return open_socket(s, false, batch_sends);
+}
+
+bool UringTransport::open_server(const char *service, bool batch_sends)
+{
+        int s;
+        if (datagram_server_sockets(NULL, service, AF_UNSPEC, 0, &s, 1) != 1)
+                return false;
+
+        return open_socket(s, true, batch_sends);
+}
+
+bool UringTransport::open_socket(int sock, bool reply_to_sender, bool batch_sends)
+{
+        this->sock = sock;
+        this->reply_to_sender = reply_to_sender;
+        this->batch_sends = batch_sends;
+
+        if (!setup_ring(rx_ring, URING_SQ_ENTRIES))
+                return false;
+        if (batch_sends) {
+                tx_ring = &rx_ring;
+        } else {
+                if (!setup_ring(tx_ring_separate, URING_SQ_ENTRIES))
+                        return false;
+                tx_ring = &tx_ring_separate;
+        }
+
+        // Register ring of receive buffers with the kernel.
+        buf_ring_len = URING_RX_BUFFERS * sizeof(struct io_uring_buf);
+        void *p = mmap(NULL, buf_ring_len, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+        if (p == MAP_FAILED) {
+                buf_ring = nullptr;
+                return false;
+        }
+        buf_ring = (struct io_uring_buf *)p;
+
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = (uint64_t)buf_ring;
+        reg.ring_entries = URING_RX_BUFFERS;
+        reg.bgid = URING_RX_BGID;
+        if (syscall(__NR_io_uring_register, rx_ring.fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+                return false;
+
+        rx_buffers = new uint8_t[URING_RX_BUFFERS * URING_BUF_SIZE];
+        for (unsigned bid = 0; bid < URING_RX_BUFFERS; bid++)
+                recycle_rx_buffer(bid);
+        rx_pending.reserve(URING_CQ_ENTRIES);
+
+        // Template of the multishot recvmsg request: only the size of the
+        // name (source address) is used by the kernel.
+        rx_msg.msg_namelen = sizeof(struct sockaddr_storage);
+        rx_msg.msg_controllen = 0;
+
+        tx_slots.resize(URING_TX_BUFFERS);
+        for (unsigned i = 0; i < URING_TX_BUFFERS; i++)
+                tx_free.push_back(i);
+
+        arm_recv();
+
+        return true;
+}
+
+bool UringTransport::setup_ring(Ring &ring, unsigned entries)
+{
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = URING_CQ_ENTRIES;
+
+        ring.fd = syscall(__NR_io_uring_setup, entries, &params);
+        if (ring.fd < 0) {
+                ring.fd = -1;
+                return false;
+        }
+
+        ring.sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring.cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                if (ring.cq_len > ring.sq_len)
+                        ring.sq_len = ring.cq_len;
+                ring.cq_len = ring.sq_len;
+        }
+
+        ring.sq_ptr = mmap(NULL, ring.sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                           IORING_OFF_SQ_RING);
+        if (ring.sq_ptr == MAP_FAILED) {
+                ring.sq_ptr = nullptr;
+                return false;
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                ring.cq_ptr = ring.sq_ptr;
+        } else {
+                ring.cq_ptr = mmap(NULL, ring.cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                                   IORING_OFF_CQ_RING);
+                if (ring.cq_ptr == MAP_FAILED) {
+                        ring.cq_ptr = nullptr;
+                        return false;
+                }
+        }
+
+        ring.sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+        void *sqes = mmap(NULL, ring.sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                          IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+                return false;
+        ring.sqes = (struct io_uring_sqe *)sqes;
+
+        uint8_t *sq = (uint8_t *)ring.sq_ptr;
+        uint8_t *cq = (uint8_t *)ring.cq_ptr;
+        ring.sq_head = (unsigned *)(sq + params.sq_off.head);
+        ring.sq_tail = (unsigned *)(sq + params.sq_off.tail);
+        ring.sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+        ring.sq_array = (unsigned *)(sq + params.sq_off.array);
+        ring.cq_head = (unsigned *)(cq + params.cq_off.head);
+        ring.cq_tail = (unsigned *)(cq + params.cq_off.tail);
+        ring.cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+        ring.cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+        ring.sq_entries = params.sq_entries;
+        ring.sqe_tail = *ring.sq_tail;
+        ring.to_submit = 0;
+
+        return true;
+}
+
+void UringTransport::destroy_ring(Ring &ring)
+{
+        if (ring.sqes)
+                munmap(ring.sqes, ring.sqes_len);
+        if (ring.cq_ptr && ring.cq_ptr != ring.sq_ptr)
+                munmap(ring.cq_ptr, ring.cq_len);
+        if (ring.sq_ptr)
+                munmap(ring.sq_ptr, ring.sq_len);
+        if (ring.fd != -1)
+                close(ring.fd);
+        ring = Ring();
+}
+
+struct io_uring_sqe *UringTransport::get_sqe(Ring &ring)
+{
+        // Submission queue full: submit what we have.
+        while (ring.sqe_tail - load_acquire(ring.sq_head) >= ring.sq_entries) {
+                if (enter(ring, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        return nullptr;
+        }
+
+        unsigned idx = ring.sqe_tail & *ring.sq_mask;
+        ring.sq_array[idx] = idx;
+        ring.sqe_tail++;
+        ring.to_submit++;
+
+        struct io_uring_sqe *sqe = &ring.sqes[idx];
+        memset(sqe, 0, sizeof(*sqe));
+
+        return sqe;
+}
+
+int UringTransport::enter(Ring &ring, unsigned min_complete, unsigned int timeout_usec)
+{
+        store_release(ring.sq_tail, ring.sqe_tail);
+
+        unsigned flags = (min_complete > 0) ? IORING_ENTER_GETEVENTS : 0;
+        int ret;
+        if (timeout_usec > 0) {
+                // Wait at most the timeout for completions (fails with ETIME).
+                struct __kernel_timespec ts;
+                ts.tv_sec = timeout_usec / 1000000;
+                ts.tv_nsec = (timeout_usec % 1000000) * 1000;
+                struct io_uring_getevents_arg arg;
+                memset(&arg, 0, sizeof(arg));
+                arg.ts = (uint64_t)(uintptr_t)&ts;
+                ret = syscall(__NR_io_uring_enter, ring.fd, ring.to_submit, min_complete, flags | IORING_ENTER_EXT_ARG,
+                              &arg, sizeof(arg));
+        } else {
+                ret = syscall(__NR_io_uring_enter, ring.fd, ring.to_submit, min_complete, flags, NULL, 0);
+        }
+        n_syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (ret >= 0)
+                ring.to_submit -= ((unsigned)ret < ring.to_submit) ? ret : ring.to_submit;
+
+        return ret;
+}
+
+void UringTransport::drain_cq(Ring &ring)
+{
+        unsigned head = *ring.cq_head;
+        unsigned tail = load_acquire(ring.cq_tail);
+
+        while (head != tail) {
+                const struct io_uring_cqe &cqe = ring.cqes[head & *ring.cq_mask];
+                if (cqe.user_data == URING_RX_TAG) {
+                        if (!(cqe.flags & IORING_CQE_F_MORE))
+                                recv_armed = false;
+                        rx_pending.push_back({cqe.res, cqe.flags});
+                } else {
+                        // Send completed: send slot can be reused.
+                        tx_free.push_back((unsigned)cqe.user_data);
+                }
+                head++;
+        }
+
+        store_release(ring.cq_head, head);
+}
+
+void UringTransport::arm_recv()
+{
+        struct io_uring_sqe *sqe = get_sqe(rx_ring);
+        if (!sqe)
+                return;
+
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = sock;
+        sqe->addr = (uint64_t)&rx_msg;
+        sqe->len = 1;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = URING_RX_BGID;
+        sqe->user_data = URING_RX_TAG;
+
+        recv_armed = true;
+}
+
+void UringTransport::recycle_rx_buffer(unsigned bid)
+{
+        struct io_uring_buf *buf = &buf_ring[buf_ring_tail & (URING_RX_BUFFERS - 1)];
+        buf->addr = (uint64_t)(rx_buffers + bid * URING_BUF_SIZE);
+        buf->len = URING_BUF_SIZE;
+        buf->bid = bid;
+        buf_ring_tail++;
+
+        // The tail of the buffer ring overlays the resv field of the first entry.
+        __atomic_store_n(&buf_ring[0].resv, (uint16_t)buf_ring_tail, __ATOMIC_RELEASE);
+}
+
+static uint64_t monotonic_usec()
+{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+ssize_t UringTransport::recv(uint8_t *data, size_t max_len)
+{
+        uint64_t deadline_usec = (recv_timeout_usec > 0) ? monotonic_usec() + recv_timeout_usec : 0;
+
+        while (true) {
+                if (rx_pending_head == rx_pending.size()) {
+                        rx_pending.clear();
+                        rx_pending_head = 0;
+                        drain_cq(rx_ring);
+                }
+
+                if (rx_pending_head < rx_pending.size()) {
+                        RxCompletion c = rx_pending[rx_pending_head++];
+                        if (c.res < 0) {
+                                // Out of buffers: request terminated and is
+                                // re-armed below once buffers were recycled.
+                                if (c.res == -ENOBUFS)
+                                        continue;
+                                errno = -c.res;
+                                return -1;
+                        }
+                        if (!(c.flags & IORING_CQE_F_BUFFER))
+                                continue;
+
+                        unsigned bid = c.flags >> IORING_CQE_BUFFER_SHIFT;
+                        const uint8_t *buf = rx_buffers + bid * URING_BUF_SIZE;
+                        const struct io_uring_recvmsg_out *out = (const struct io_uring_recvmsg_out *)buf;
+                        const uint8_t *name = buf + sizeof(*out);
+                        const uint8_t *payload = name + rx_msg.msg_namelen + rx_msg.msg_controllen;
+
+                        size_t len = out->payloadlen;
+                        if (len > max_len)
+                                len = max_len;
+                        memcpy(data, payload, len);
+                        if (reply_to_sender) {
+                                peer_addr_len = (out->namelen < sizeof(peer_addr)) ? out->namelen : sizeof(peer_addr);
+                                memcpy(&peer_addr, name, peer_addr_len);
+                        }
+                        recycle_rx_buffer(bid);
+
+                        return len;
+                }
+
+                // Nothing received yet: submit queued requests (including
+                // batched sends) and wait for the next completion.
+                if (!recv_armed)
+                        arm_recv();
+                unsigned int timeout_usec = 0;
+                if (recv_timeout_usec > 0) {
+                        uint64_t now_usec = monotonic_usec();
+                        if (now_usec >= deadline_usec) {
+                                errno = EAGAIN;
+                                return -1;
+                        }
+                        timeout_usec = deadline_usec - now_usec;
+                }
+                if (enter(rx_ring, 1, timeout_usec) < 0 && errno != EAGAIN && errno != EBUSY && errno != ETIME)
+                        return -1;
+        }
+}
+
+bool UringTransport::set_recv_timeout(unsigned int usec)
+{
+        recv_timeout_usec = usec;
+        return true;
+}
+
+socklen_t UringTransport::peer_address(struct sockaddr_storage &addr) const
+{
+        memcpy(&addr, &peer_addr, peer_addr_len);
+        return peer_addr_len;
+}
+
+ssize_t UringTransport::send(const uint8_t *data, size_t len)
+{
+        if (len > URING_BUF_SIZE) {
+                errno = EMSGSIZE;
+                return -1;
+        }
+
+        // Get a free send slot. In batched mode, completions of sends are
+        // reaped from the shared ring (receive completions are kept for
+        // recv()).
+        if (tx_free.empty())
+                drain_cq(*tx_ring);
+        while (tx_free.empty()) {
+                if (enter(*tx_ring, 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        return -1;
+                drain_cq(*tx_ring);
+        }
+        unsigned slot_idx = tx_free.back();
+        tx_free.pop_back();
+        TxSlot &slot = tx_slots[slot_idx];
+        memcpy(slot.data, data, len);
+
+        struct io_uring_sqe *sqe = get_sqe(*tx_ring);
+        if (!sqe) {
+                tx_free.push_back(slot_idx);
+                return -1;
+        }
+        sqe->fd = sock;
+        sqe->user_data = slot_idx;
+        if (reply_to_sender) {
+                slot.iov.iov_base = slot.data;
+                slot.iov.iov_len = len;
+                memset(&slot.msg, 0, sizeof(slot.msg));
+                memcpy(&slot.addr, &peer_addr, peer_addr_len);
+                slot.msg.msg_name = &slot.addr;
+                slot.msg.msg_namelen = peer_addr_len;
+                slot.msg.msg_iov = &slot.iov;
+                slot.msg.msg_iovlen = 1;
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->addr = (uint64_t)&slot.msg;
+                sqe->len = 1;
+        } else {
+                sqe->opcode = IORING_OP_SEND;
+                sqe->addr = (uint64_t)slot.data;
+                sqe->len = len;
+        }
+
+        if (!batch_sends && !flush())
+                return -1;
+
+        return len;
+}
+
+bool UringTransport::flush()
+{
+        if (tx_ring->to_submit == 0)
+                return true;
+
+        return (enter(*tx_ring, 0) >= 0);
+}
+
+uint64_t UringTransport::syscalls() const
+{
+        return n_syscalls.load(std::memory_order_relaxed);
+}
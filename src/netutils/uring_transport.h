@@ -0,0 +1,160 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef URING_TRANSPORT_H
+#define URING_TRANSPORT_H
+
+#include <atomic>
+#include <linux/io_uring.h>
+#include <vector>
+
+#include "transport.h"
+
+// Number of receive buffers provided to the kernel (must be a power of 2).
+#define URING_RX_BUFFERS 256
+
+// Size of a receive or send buffer [bytes]
+#define URING_BUF_SIZE 2048
+
+// Number of send buffers.
+#define URING_TX_BUFFERS 256
+
+/**
+ * UDP transport based on io_uring (using the raw kernel interface, no
+ * liburing required).
+ *
+ * Datagrams are received by a single multishot recvmsg request into a ring
+ * of buffers registered with the kernel, so one system call can return many
+ * datagrams and the request does not need to be re-armed per datagram.
+ *
+ * Sends are queued as submission queue entries. In batched mode, queued
+ * sends are submitted together with the next wait for incoming datagrams,
+ * i.e., a controller answering a burst of states needs a single system call
+ * for the whole burst. In this mode, send() and recv() must be called from
+ * the same thread. Otherwise, sends use a separate ring and are submitted
+ * immediately, so send() and recv() may be called from different threads
+ * (like the plant does).
+ */
+class UringTransport : public Transport
+{
+      public:
+        UringTransport();
+        ~UringTransport();
+
+        /**
+         * Create a datagram socket "connected" to the controller (plant side).
+         *
+         * @param hostname hostname or IP address of controller
+         * @param service service name or port number of controller
+         * @param batch_sends defer sends until the next recv()
+         * @return true on success; false on error (errno is set).
+         */
+        bool open_client(const char *hostname, const char *service, bool batch_sends);
+
+        /**
+         * Create a datagram socket bound to the given service (controller
+         * side). Messages are sent to the sender of the last received message.
+         *
+         * @param service service name or port number
+         * @param batch_sends defer sends until the next recv()
+         * @return true on success; false on error (errno is set).
+         */
+        bool open_server(const char *service, bool batch_sends);
+
+        ssize_t send(const uint8_t *data, size_t len) override;
+        ssize_t recv(uint8_t *data, size_t max_len) override;
+        bool set_recv_timeout(unsigned int usec) override;
+        socklen_t peer_address(struct sockaddr_storage &addr) const override;
+
+        /**
+         * Submit all queued sends.
+         *
+         * @return true on success; false on error (errno is set).
+         */
+        bool flush();
+
+        /**
+         * Number of io_uring_enter() system calls so far.
+         */
+        uint64_t syscalls() const;
+
+      private:
+        struct Ring {
+                int fd = -1;
+                void *sq_ptr = nullptr;
+                size_t sq_len = 0;
+                void *cq_ptr = nullptr;
+                size_t cq_len = 0;
+                struct io_uring_sqe *sqes = nullptr;
+                size_t sqes_len = 0;
+                unsigned *sq_head = nullptr;
+                unsigned *sq_tail = nullptr;
+                unsigned *sq_mask = nullptr;
+                unsigned *sq_array = nullptr;
+                unsigned *cq_head = nullptr;
+                unsigned *cq_tail = nullptr;
+                unsigned *cq_mask = nullptr;
+                struct io_uring_cqe *cqes = nullptr;
+                unsigned sq_entries = 0;
+                // Local copy of the SQ tail; published by enter().
+                unsigned sqe_tail = 0;
+                // Number of SQEs queued but not yet submitted.
+                unsigned to_submit = 0;
+        };
+
+        struct RxCompletion {
+                int32_t res;
+                uint32_t flags;
+        };
+
+        struct TxSlot {
+                uint8_t data[URING_BUF_SIZE];
+                struct iovec iov;
+                struct msghdr msg;
+                struct sockaddr_storage addr;
+        };
+
+        bool open_socket(int sock, bool reply_to_sender, bool batch_sends);
+        bool setup_ring(Ring &ring, unsigned entries);
+        void destroy_ring(Ring &ring);
+        struct io_uring_sqe *get_sqe(Ring &ring);
+        int enter(Ring &ring, unsigned min_complete, unsigned int timeout_usec = 0);
+        void drain_cq(Ring &ring);
+        void arm_recv();
+        void recycle_rx_buffer(unsigned bid);
+
+        int sock;
+        bool reply_to_sender;
+        bool batch_sends;
+        Ring rx_ring;
+        Ring tx_ring_separate;
+        Ring *tx_ring;
+
+        // Provided buffer ring for receiving.
+        struct io_uring_buf *buf_ring;
+        size_t buf_ring_len;
+        uint8_t *rx_buffers;
+        unsigned buf_ring_tail;
+        struct msghdr rx_msg;
+        bool recv_armed;
+        // Timeout of recv() (0: none) [us]
+        unsigned int recv_timeout_usec;
+        // Receive completions reaped but not yet delivered by recv().
+        std::vector<RxCompletion> rx_pending;
+        size_t rx_pending_head;
+
+        std::vector<TxSlot> tx_slots;
+        std::vector<unsigned> tx_free;
+
+        struct sockaddr_storage peer_addr;
+        socklen_t peer_addr_len;
+
+        std::atomic<uint64_t> n_syscalls;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "async_logger.h"
+
+#include <cmath>
+#include <inttypes.h>
+#include <time.h>
+
+// Sleep time of the writer thread if the ring is empty [ns]
+#define WRITER_IDLE_NSEC 1000000
+
+// Size of the stdio buffer of the log file [bytes]
+#define LOG_FILE_BUFFER_SIZE (1 << 20)
+
+AsyncLogger::AsyncLogger()
+        : ring(nullptr), file(nullptr), format(Format::POSITION_ANGLE), running(false), stop(false), n_dropped(0),
+          n_written(0)
+{
+}
+
+AsyncLogger::~AsyncLogger()
+{
+        close();
+}
+
+bool AsyncLogger::open(const char *path, Format format)
+{
+        file = fopen(path, "w");
+        if (file == nullptr)
+                return false;
+        setvbuf(file, nullptr, _IOFBF, LOG_FILE_BUFFER_SIZE);
+
+        this->format = format;
+        if (format == Format::FULL_STATE)
+                fprintf(file, "# t,x,v,phi,omega,u\n");
+
+        ring = new SpscRing<log_record_t, LOG_RING_CAPACITY>();
+        stop.store(false);
+        if (pthread_create(&thread, NULL, writer_thread_run, this)) {
+                fclose(file);
+                file = nullptr;
+                delete ring;
+                ring = nullptr;
+                return false;
+        }
+        running = true;
+
+        return true;
+}
+
+void AsyncLogger::close()
+{
+        if (running) {
+                stop.store(true);
+                pthread_join(thread, NULL);
+                running = false;
+        }
+
+        if (file) {
+                fclose(file);
+                file = nullptr;
+        }
+
+        delete ring;
+        ring = nullptr;
+}
+
+bool AsyncLogger::log(uint64_t t_usec, const double state[4], double force)
+{
+        log_record_t rec;
+        rec.t_usec = t_usec;
+        rec.state[0] = state[0];
+        rec.state[1] = state[1];
+        rec.state[2] = state[2];
+        rec.state[3] = state[3];
+        rec.force = force;
+
+        if (!ring->push(rec)) {
+                n_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+        }
+
+        return true;
+}
+
+uint64_t AsyncLogger::dropped() const
+{
+        return n_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogger::written() const
+{
+        return n_written.load(std::memory_order_relaxed);
+}
+
+void AsyncLogger::write_record(const log_record_t &rec)
+{
+        int ret;
+        if (format == Format::FULL_STATE) {
+                ret = fprintf(file, "%.6f,%f,%f,%f,%f,%f\n", 0.000001 * rec.t_usec, rec.state[0], rec.state[1],
+                              rec.state[2], rec.state[3], rec.force);
+        } else {
+                ret = fprintf(file, "%" PRIu64 ",%f,%f\n", rec.t_usec, rec.state[0], rec.state[2] * (180.0 / M_PI));
+        }
+
+        if (ret < 0)
+                perror("Failed to write log entry");
+        else
+                n_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void *AsyncLogger::writer_thread_run(void *param)
+{
+        AsyncLogger *logger = (AsyncLogger *)param;
+        const struct timespec idle = {0, WRITER_IDLE_NSEC};
+
+        while (true) {
+                // Read the stop flag before draining such that no record
+                // pushed before close() is lost.
+                bool stopping = logger->stop.load();
+
+                log_record_t rec;
+                bool idle_pass = true;
+                while (logger->ring->pop(rec)) {
+                        logger->write_record(rec);
+                        idle_pass = false;
+                }
+
+                if (stopping)
+                        break;
+
+                if (idle_pass) {
+                        fflush(logger->file);
+                        nanosleep(&idle, NULL);
+                }
+        }
+
+        return NULL;
+}
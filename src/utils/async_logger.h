@@ -0,0 +1,104 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <atomic>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "spsc_ring.h"
+
+// Capacity of the log ring in records (must be a power of 2).
+#define LOG_RING_CAPACITY (1 << 16)
+
+/**
+ * Fixed-size binary log record as pushed by the real-time thread.
+ */
+struct log_record_t {
+        // Timestamp [us]
+        uint64_t t_usec;
+        // Pendulum state [x, v, phi, omega]
+        double state[4];
+        // Force onto cart [N]
+        double force;
+};
+
+/**
+ * Logger decoupling the real-time loop from file I/O.
+ *
+ * The real-time thread pushes fixed binary records into a lock-free ring.
+ * A background writer thread drains the ring and formats the records into
+ * the log file. If the ring is full, records are dropped and counted
+ * instead of blocking the real-time thread.
+ *
+ * log() must always be called from the same thread.
+ */
+class AsyncLogger
+{
+      public:
+        enum class Format {
+                // t [us], x [m], phi [deg] (legacy log format of ncs-plant)
+                POSITION_ANGLE,
+                // t [s], x, v, phi, omega, u (state trace format plus force)
+                FULL_STATE
+        };
+
+        AsyncLogger();
+        ~AsyncLogger();
+
+        /**
+         * Open the log file and start the writer thread.
+         *
+         * @param path path of log file
+         * @param format format of log entries
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *path, Format format);
+
+        /**
+         * Flush all pending records, stop the writer thread, and close the
+         * log file.
+         */
+        void close();
+
+        /**
+         * Enqueue a log record. Never blocks.
+         *
+         * @return true if the record was enqueued; false if it was dropped
+         * because the ring was full.
+         */
+        bool log(uint64_t t_usec, const double state[4], double force);
+
+        /**
+         * Number of records dropped because the ring was full.
+         */
+        uint64_t dropped() const;
+
+        /**
+         * Number of records written to the log file.
+         */
+        uint64_t written() const;
+
+      private:
+        static void *writer_thread_run(void *param);
+        void write_record(const log_record_t &rec);
+
+        SpscRing<log_record_t, LOG_RING_CAPACITY> *ring;
+        FILE *file;
+        Format format;
+        pthread_t thread;
+        bool running;
+        std::atomic_bool stop;
+        std::atomic<uint64_t> n_dropped;
+        std::atomic<uint64_t> n_written;
+};
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+int log_level = LOG_LEVEL_WARN;
+
+static const char *level_names[] = {"off", "error", "warn", "info", "debug", "trace"};
+
+bool log_parse_level(const char *name, int &level)
+{
+        for (int l = LOG_LEVEL_OFF; l <= LOG_LEVEL_TRACE; l++) {
+                if (strcmp(name, level_names[l]) == 0) {
+                        level = l;
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+void log_printf(const char *format, ...)
+{
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+}
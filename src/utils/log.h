@@ -0,0 +1,84 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+/**
+ * Leveled logging to stderr.
+ *
+ * A message is printed if its level is not above the runtime level
+ * (log_level, default: LOG_LEVEL_WARN). Log statements above the
+ * compile-time level LOG_COMPILE_LEVEL (cmake -DLOG_COMPILE_LEVEL=...,
+ * default: debug) are removed by the preprocessor, including the
+ * evaluation of their arguments.
+ */
+
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// Runtime log level
+extern int log_level;
+
+/**
+ * Parse the name of a log level (off, error, warn, info, debug, trace).
+ *
+ * @return true on success; false if the name is unknown.
+ */
+bool log_parse_level(const char *name, int &level);
+
+/**
+ * Print a message to stderr (use the LOG_... macros instead).
+ */
+void log_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#define LOG_AT(level, ...)                                                                                             \
+        do {                                                                                                           \
+                if (log_level >= (level))                                                                              \
+                        log_printf(__VA_ARGS__);                                                                       \
+        } while (0)
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do { } while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) LOG_AT(LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "matrix.h"
+
+#include <cmath>
+#include <utility>
+
+// Number of terms of the Taylor series of the matrix exponential.
+#define EXP_TERMS 16
+
+Matrix::Matrix(size_t rows, size_t cols) : n_rows(rows), n_cols(cols), data(rows * cols, 0.0)
+{
+}
+
+Matrix Matrix::identity(size_t n)
+{
+        Matrix I(n, n);
+        for (size_t i = 0; i < n; i++)
+                I(i, i) = 1.0;
+
+        return I;
+}
+
+Matrix Matrix::operator+(const Matrix &other) const
+{
+        Matrix sum(n_rows, n_cols);
+        for (size_t i = 0; i < data.size(); i++)
+                sum.data[i] = data[i] + other.data[i];
+
+        return sum;
+}
+
+Matrix Matrix::operator-(const Matrix &other) const
+{
+        Matrix diff(n_rows, n_cols);
+        for (size_t i = 0; i < data.size(); i++)
+                diff.data[i] = data[i] - other.data[i];
+
+        return diff;
+}
+
+Matrix Matrix::operator*(const Matrix &other) const
+{
+        Matrix prod(n_rows, other.n_cols);
+        for (size_t i = 0; i < n_rows; i++) {
+                for (size_t k = 0; k < n_cols; k++) {
+                        double a = (*this)(i, k);
+                        if (a == 0.0)
+                                continue;
+                        for (size_t j = 0; j < other.n_cols; j++)
+                                prod(i, j) += a * other(k, j);
+                }
+        }
+
+        return prod;
+}
+
+Matrix Matrix::operator*(double s) const
+{
+        Matrix prod(n_rows, n_cols);
+        for (size_t i = 0; i < data.size(); i++)
+                prod.data[i] = s * data[i];
+
+        return prod;
+}
+
+Matrix Matrix::transpose() const
+{
+        Matrix t(n_cols, n_rows);
+        for (size_t i = 0; i < n_rows; i++)
+                for (size_t j = 0; j < n_cols; j++)
+                        t(j, i) = (*this)(i, j);
+
+        return t;
+}
+
+Matrix Matrix::select(const std::vector<size_t> &row_idx, const std::vector<size_t> &col_idx) const
+{
+        Matrix sub(row_idx.size(), col_idx.size());
+        for (size_t i = 0; i < row_idx.size(); i++)
+                for (size_t j = 0; j < col_idx.size(); j++)
+                        sub(i, j) = (*this)(row_idx[i], col_idx[j]);
+
+        return sub;
+}
+
+double Matrix::max_abs() const
+{
+        double max = 0.0;
+        for (double d : data)
+                max = std::fmax(max, std::fabs(d));
+
+        return max;
+}
+
+bool Matrix::solve(const Matrix &B, Matrix &X) const
+{
+        size_t n = n_rows;
+        Matrix A = *this;
+        X = B;
+
+        for (size_t col = 0; col < n; col++) {
+                size_t pivot = col;
+                for (size_t i = col + 1; i < n; i++) {
+                        if (std::fabs(A(i, col)) > std::fabs(A(pivot, col)))
+                                pivot = i;
+                }
+                if (A(pivot, col) == 0.0)
+                        return false;
+                if (pivot != col) {
+                        for (size_t j = 0; j < n; j++)
+                                std::swap(A(col, j), A(pivot, j));
+                        for (size_t j = 0; j < X.n_cols; j++)
+                                std::swap(X(col, j), X(pivot, j));
+                }
+                for (size_t i = col + 1; i < n; i++) {
+                        double f = A(i, col) / A(col, col);
+                        if (f == 0.0)
+                                continue;
+                        for (size_t j = col; j < n; j++)
+                                A(i, j) -= f * A(col, j);
+                        for (size_t j = 0; j < X.n_cols; j++)
+                                X(i, j) -= f * X(col, j);
+                }
+        }
+
+        // Back substitution.
+        for (size_t i = n; i-- > 0;) {
+                for (size_t j = 0; j < X.n_cols; j++) {
+                        double sum = X(i, j);
+                        for (size_t k = i + 1; k < n; k++)
+                                sum -= A(i, k) * X(k, j);
+                        X(i, j) = sum / A(i, i);
+                }
+        }
+
+        return true;
+}
+
+bool Matrix::inverse(Matrix &inv) const
+{
+        return solve(identity(n_rows), inv);
+}
+
+Matrix Matrix::exp() const
+{
+        // Scale such that the norm is below 0.5, then square again.
+        int squarings = 0;
+        double norm = max_abs() * n_rows;
+        while (norm > 0.5) {
+                norm /= 2.0;
+                squarings++;
+        }
+        Matrix A = (*this) * std::ldexp(1.0, -squarings);
+
+        Matrix result = identity(n_rows);
+        Matrix term = identity(n_rows);
+        for (int k = 1; k <= EXP_TERMS; k++) {
+                term = (term * A) * (1.0 / k);
+                result = result + term;
+        }
+        for (int i = 0; i < squarings; i++)
+                result = result * result;
+
+        return result;
+}
@@ -0,0 +1,96 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * Small dense matrix (row-major) for offline computations such as
+ * controller synthesis. Not meant for the per-packet path.
+ */
+class Matrix
+{
+      public:
+        /**
+         * Create a rows x cols matrix of zeros.
+         */
+        Matrix(size_t rows = 0, size_t cols = 0);
+
+        static Matrix identity(size_t n);
+
+        size_t rows() const
+        {
+                return n_rows;
+        }
+
+        size_t cols() const
+        {
+                return n_cols;
+        }
+
+        double &operator()(size_t i, size_t j)
+        {
+                return data[i * n_cols + j];
+        }
+
+        double operator()(size_t i, size_t j) const
+        {
+                return data[i * n_cols + j];
+        }
+
+        Matrix operator+(const Matrix &other) const;
+        Matrix operator-(const Matrix &other) const;
+        Matrix operator*(const Matrix &other) const;
+        Matrix operator*(double s) const;
+
+        Matrix transpose() const;
+
+        /**
+         * Copy of the sub-matrix selected by the given row and column
+         * indices.
+         */
+        Matrix select(const std::vector<size_t> &row_idx, const std::vector<size_t> &col_idx) const;
+
+        /**
+         * Maximum absolute value of all elements.
+         */
+        double max_abs() const;
+
+        /**
+         * Solve A*X = B (A = this, square) by Gaussian elimination with
+         * partial pivoting.
+         *
+         * @param B right-hand side
+         * @param X receives the solution
+         * @return true on success; false if A is singular.
+         */
+        bool solve(const Matrix &B, Matrix &X) const;
+
+        /**
+         * Inverse of a square matrix.
+         *
+         * @return true on success; false if the matrix is singular.
+         */
+        bool inverse(Matrix &inv) const;
+
+        /**
+         * Matrix exponential exp(A) (A = this, square) by scaling and
+         * squaring of the Taylor series.
+         */
+        Matrix exp() const;
+
+      private:
+        size_t n_rows;
+        size_t n_cols;
+        std::vector<double> data;
+};
+
+#endif
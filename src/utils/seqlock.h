@@ -0,0 +1,78 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+/**
+ * Single value shared between exactly one writer and any number of readers.
+ *
+ * The writer never blocks or waits for readers. Readers retry if the writer
+ * updated the value while they were copying it, so they always get a
+ * consistent snapshot. Neither side allocates memory.
+ *
+ * @tparam T type of value (must be trivially copyable)
+ */
+template <typename T>
+class Seqlock
+{
+        static_assert(std::is_trivially_copyable<T>::value, "Seqlock value must be trivially copyable");
+
+      public:
+        Seqlock() : seq(0)
+        {
+                memset(&value, 0, sizeof(value));
+        }
+
+        /**
+         * Publish a new value. Must only be called by the writer.
+         */
+        void store(const T &v)
+        {
+                uint64_t s = seq.load(std::memory_order_relaxed);
+                seq.store(s + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                memcpy(&value, &v, sizeof(T));
+                seq.store(s + 2, std::memory_order_release);
+        }
+
+        /**
+         * Get a consistent copy of the latest value.
+         */
+        T load() const
+        {
+                T v;
+                uint64_t s1, s2;
+                do {
+                        s1 = seq.load(std::memory_order_acquire);
+                        memcpy(&v, &value, sizeof(T));
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        s2 = seq.load(std::memory_order_relaxed);
+                } while ((s1 & 1) || s1 != s2);
+                return v;
+        }
+
+        /**
+         * Number of values published so far.
+         */
+        uint64_t version() const
+        {
+                return seq.load(std::memory_order_acquire) / 2;
+        }
+
+      private:
+        std::atomic<uint64_t> seq;
+        T value;
+};
+
+#endif
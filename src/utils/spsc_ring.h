@@ -0,0 +1,103 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Lock-free ring buffer for exactly one producer thread and one consumer
+ * thread.
+ *
+ * Neither push() nor pop() ever block. If the ring is full, push() fails
+ * and the caller decides what to do with the element (e.g., count it as
+ * dropped).
+ *
+ * The ring does not contain any pointers, so it can also be placed into
+ * memory shared between processes (construct it with placement new in the
+ * shared segment).
+ *
+ * @tparam T element type (should be trivially copyable)
+ * @tparam N capacity of the ring; must be a power of 2
+ */
+template <typename T, size_t N>
+class SpscRing
+{
+        static_assert(N > 0 && (N & (N - 1)) == 0, "Capacity of ring must be a power of 2");
+
+      public:
+        SpscRing() : head(0), tail(0)
+        {
+        }
+
+        /**
+         * Add an element to the ring. Must only be called by the producer.
+         *
+         * @param elem element to add
+         * @return true if the element was added; false if the ring is full.
+         */
+        bool push(const T &elem)
+        {
+                uint64_t h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) == N)
+                        return false;
+                slots[h & (N - 1)] = elem;
+                head.store(h + 1, std::memory_order_release);
+                return true;
+        }
+
+        /**
+         * Remove the oldest element from the ring. Must only be called by the
+         * consumer.
+         *
+         * @param elem receives the removed element
+         * @return true if an element was removed; false if the ring is empty.
+         */
+        bool pop(T &elem)
+        {
+                uint64_t t = tail.load(std::memory_order_relaxed);
+                if (head.load(std::memory_order_acquire) == t)
+                        return false;
+                elem = slots[t & (N - 1)];
+                tail.store(t + 1, std::memory_order_release);
+                return true;
+        }
+
+        /**
+         * Check whether the ring is empty. The result is only a snapshot if
+         * called concurrently with push() or pop().
+         */
+        bool empty() const
+        {
+                return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Total number of elements ever pushed to the ring.
+         */
+        uint64_t pushed() const
+        {
+                return head.load(std::memory_order_acquire);
+        }
+
+        static constexpr size_t capacity()
+        {
+                return N;
+        }
+
+      private:
+        // Producer and consumer index on separate cache lines to avoid false sharing.
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) T slots[N];
+};
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "live_follow.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+// Distance of the status line from the border of the window [px]
+#define STATUS_MARGIN 20.0F
+
+// Height of a status line [px]
+#define STATUS_LINE 24.0F
+
+LiveFollow::LiveFollow() : has_state(false), n_skipped(0)
+{
+        name[0] = '\0';
+}
+
+bool LiveFollow::open(const char *name)
+{
+        snprintf(this->name, sizeof(this->name), "%s", name);
+        return reader.open(name);
+}
+
+bool LiveFollow::update(time_state_t &time_state)
+{
+        feed_sample_t sample;
+        if (reader.latest(sample)) {
+                if (has_state && sample.index > last.index)
+                        n_skipped += sample.index - last.index - 1;
+                last = sample;
+                has_state = true;
+        }
+
+        if (!has_state)
+                return false;
+
+        time_state.first = last.t;
+        time_state.second = last.state;
+        return true;
+}
+
+uint64_t LiveFollow::skipped() const
+{
+        return n_skipped;
+}
+
+void LiveFollow::draw(sf::RenderTarget &target, const sf::Font &font, unsigned int line) const
+{
+        char status[384];
+        if (has_state)
+                snprintf(status, sizeof(status), "%s: t = %.4f s   %" PRIu64 " states skipped%s", name, last.t,
+                         n_skipped, reader.closed() ? "   (ended)" : "");
+        else
+                snprintf(status, sizeof(status), "%s: waiting for first state", name);
+
+        sf::Text text;
+        text.setFont(font);
+        text.setCharacterSize(16);
+        text.setFillColor(sf::Color(0x7E, 0x7E, 0x7E));
+        text.setPosition(STATUS_MARGIN, target.getSize().y - STATUS_MARGIN - (line + 1) * STATUS_LINE);
+        text.setString(status);
+        target.draw(text);
+}
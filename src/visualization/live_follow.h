@@ -0,0 +1,69 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef LIVE_FOLLOW_H
+#define LIVE_FOLLOW_H
+
+#include <SFML/Graphics.hpp>
+#include <stdint.h>
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+#include "../netutils/state_feed.h"
+
+/**
+ * Live-follow mode of the visualizers: each frame shows the newest state
+ * of a running simulation (see StateFeedPublisher). States published
+ * between two frames are skipped, so the simulation never waits for the
+ * viewer.
+ */
+class LiveFollow
+{
+      public:
+        LiveFollow();
+
+        /**
+         * Attach to the live feed of a simulation. Waits until the
+         * simulation has created it.
+         *
+         * @param name name of the feed
+         * @return true on success; false on error (errno is set).
+         */
+        bool open(const char *name);
+
+        /**
+         * Get the newest state.
+         *
+         * @param time_state receives the newest state; unchanged if
+         * nothing has been published yet
+         * @return true if a state has been published.
+         */
+        bool update(time_state_t &time_state);
+
+        /**
+         * Number of published states that have not been shown.
+         */
+        uint64_t skipped() const;
+
+        /**
+         * Draw the status line.
+         *
+         * @param line line counted from the bottom of the window (to
+         * stack the status lines of several feeds)
+         */
+        void draw(sf::RenderTarget &target, const sf::Font &font, unsigned int line = 0) const;
+
+      private:
+        StateFeedReader reader;
+        char name[256];
+
+        bool has_state;
+        feed_sample_t last;
+        uint64_t n_skipped;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "pendulum_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Layout of the scene [px]
+#define SCENE_WIDTH 1024.0F
+#define SCENE_HEIGHT 480.0F
+#define SCENE_TRACK_Y 240.0F
+#define SCENE_ORIGIN_X 320.0F
+#define SCENE_PX_PER_M 100.0F
+#define CART_SIZE 100.0F
+#define POLE_WIDTH 20.0F
+#define POLE_LENGTH 200.0F
+
+PendulumBatch::PendulumBatch() : vertices(sf::Triangles)
+{
+}
+
+void PendulumBatch::clear()
+{
+        vertices.clear();
+}
+
+void PendulumBatch::add_rect(const scene_cell_t &cell, float ox, float oy, float left, float top, float right,
+                             float bottom, float angle, const sf::Color &color)
+{
+        float scale = std::min(cell.width / SCENE_WIDTH, cell.height / SCENE_HEIGHT);
+        float x0 = cell.x + 0.5F * (cell.width - scale * SCENE_WIDTH);
+        float y0 = cell.y + 0.5F * (cell.height - scale * SCENE_HEIGHT);
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+
+        const float corners[4][2] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+        sf::Vector2f p[4];
+        for (int k = 0; k < 4; k++) {
+                float x = ox + c * corners[k][0] - s * corners[k][1];
+                float y = oy + s * corners[k][0] + c * corners[k][1];
+                p[k] = sf::Vector2f(x0 + scale * x, y0 + scale * y);
+        }
+
+        vertices.append(sf::Vertex(p[0], color));
+        vertices.append(sf::Vertex(p[1], color));
+        vertices.append(sf::Vertex(p[2], color));
+        vertices.append(sf::Vertex(p[0], color));
+        vertices.append(sf::Vertex(p[2], color));
+        vertices.append(sf::Vertex(p[3], color));
+}
+
+void PendulumBatch::add_track(const scene_cell_t &cell, const sf::Color &color)
+{
+        // At least one pixel high in small cells.
+        float scale = std::min(cell.width / SCENE_WIDTH, cell.height / SCENE_HEIGHT);
+        float half = std::max(1.0F, 0.5F / scale);
+        add_rect(cell, 0.0F, SCENE_TRACK_Y, 0.0F, -half, SCENE_WIDTH, half, 0.0F, color);
+}
+
+void PendulumBatch::add_pendulum(const scene_cell_t &cell, const pendulum_state_t &state,
+                                 const sf::Color &cart_color, const sf::Color &pole_color)
+{
+        float x = SCENE_ORIGIN_X + SCENE_PX_PER_M * state[0];
+        float half = 0.5F * CART_SIZE;
+        add_rect(cell, x, SCENE_TRACK_Y, -half, -half, half, half, 0.0F, cart_color);
+
+        // Same orientation as the rotated pole of the visualizer
+        // (setRotation(-phi)).
+        half = 0.5F * POLE_WIDTH;
+        add_rect(cell, x, SCENE_TRACK_Y, -half, -POLE_LENGTH, half, 0.0F, -state[2], pole_color);
+}
+
+void PendulumBatch::draw(sf::RenderTarget &target) const
+{
+        target.draw(vertices);
+}
+
+const sf::VertexArray &PendulumBatch::triangles() const
+{
+        return vertices;
+}
@@ -0,0 +1,83 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef PENDULUM_BATCH_H
+#define PENDULUM_BATCH_H
+
+#include <SFML/Graphics.hpp>
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+/**
+ * Area of the window showing one pendulum scene. The scene has the layout
+ * of the single-pendulum visualizer (1024 x 480 px, cart at 320 px for
+ * x = 0, 100 px per m) scaled and centered into the cell.
+ */
+struct scene_cell_t {
+        float x;
+        float y;
+        float width;
+        float height;
+};
+
+/**
+ * Tracks, carts, and poles of many pendulums collected in one vertex
+ * array, so that a frame takes a single draw call regardless of the
+ * number of pendulums.
+ */
+class PendulumBatch
+{
+      public:
+        PendulumBatch();
+
+        /**
+         * Remove all shapes (the memory is kept for the next frame).
+         */
+        void clear();
+
+        /**
+         * Add the track of a scene.
+         */
+        void add_track(const scene_cell_t &cell, const sf::Color &color);
+
+        /**
+         * Add the cart and pole of a pendulum.
+         *
+         * @param cell scene of the pendulum
+         * @param state state of the pendulum
+         * @param cart_color color of the cart
+         * @param pole_color color of the pole
+         */
+        void add_pendulum(const scene_cell_t &cell, const pendulum_state_t &state, const sf::Color &cart_color,
+                          const sf::Color &pole_color);
+
+        void draw(sf::RenderTarget &target) const;
+
+        /**
+         * Triangles of all shapes (e.g., for rendering without OpenGL).
+         */
+        const sf::VertexArray &triangles() const;
+
+      private:
+        /**
+         * Add a rectangle of the scene, rotated by angle (SFML rotation,
+         * clockwise) around the origin.
+         *
+         * @param cell scene
+         * @param ox, oy origin in scene coordinates
+         * @param left, top, right, bottom corners relative to the origin
+         * @param angle rotation [rad]
+         * @param color color
+         */
+        void add_rect(const scene_cell_t &cell, float ox, float oy, float left, float top, float right,
+                      float bottom, float angle, const sf::Color &color);
+
+        sf::VertexArray vertices;
+};
+
+#endif
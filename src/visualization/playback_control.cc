@@ -0,0 +1,168 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "playback_control.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+// Playback speeds (index PLAYBACK_SPEED_NORMAL: real time)
+static const double speeds[] = {0.1, 0.2, 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 100.0};
+#define PLAYBACK_SPEEDS (sizeof(speeds) / sizeof(speeds[0]))
+#define PLAYBACK_SPEED_NORMAL 3
+
+// Geometry of the progress bar (distance to the window border) [px]
+#define BAR_MARGIN 20.0F
+#define BAR_HEIGHT 6.0F
+// Vertical distance from the bar at which mouse clicks still hit it [px]
+#define BAR_GRAB 10.0F
+
+PlaybackControl::PlaybackControl(double start, double end, unsigned int frame_rate)
+        : start(start), end(end), frame_period(1.0 / frame_rate), position(start), paused(false),
+          speed_idx(PLAYBACK_SPEED_NORMAL), dragging(false)
+{
+}
+
+void PlaybackControl::seek(double t)
+{
+        position = std::max(start, std::min(end, t));
+}
+
+void PlaybackControl::change_speed(int steps)
+{
+        speed_idx = std::max(0, std::min((int)PLAYBACK_SPEEDS - 1, speed_idx + steps));
+}
+
+double PlaybackControl::bar_time(int x, const sf::Vector2u &window_size) const
+{
+        double width = window_size.x - 2.0 * BAR_MARGIN;
+        double fraction = (x - BAR_MARGIN) / width;
+
+        return start + std::max(0.0, std::min(1.0, fraction)) * (end - start);
+}
+
+bool PlaybackControl::on_bar(int y, const sf::Vector2u &window_size) const
+{
+        float bar_y = window_size.y - BAR_MARGIN;
+
+        return (y >= bar_y - BAR_GRAB && y <= bar_y + BAR_HEIGHT + BAR_GRAB);
+}
+
+bool PlaybackControl::handle_event(const sf::Event &event, const sf::Vector2u &window_size)
+{
+        switch (event.type) {
+        case sf::Event::KeyPressed:
+                switch (event.key.code) {
+                case sf::Keyboard::Space:
+                        paused = !paused;
+                        // Restart from the beginning after the end.
+                        if (!paused && position >= end)
+                                position = start;
+                        break;
+                case sf::Keyboard::Period:
+                        paused = true;
+                        seek(position + frame_period * speeds[speed_idx]);
+                        break;
+                case sf::Keyboard::Comma:
+                        paused = true;
+                        seek(position - frame_period * speeds[speed_idx]);
+                        break;
+                case sf::Keyboard::Right:
+                        seek(position + PLAYBACK_SEEK_SHORT);
+                        break;
+                case sf::Keyboard::Left:
+                        seek(position - PLAYBACK_SEEK_SHORT);
+                        break;
+                case sf::Keyboard::PageUp:
+                        seek(position + PLAYBACK_SEEK_LONG);
+                        break;
+                case sf::Keyboard::PageDown:
+                        seek(position - PLAYBACK_SEEK_LONG);
+                        break;
+                case sf::Keyboard::Home:
+                        seek(start);
+                        break;
+                case sf::Keyboard::End:
+                        seek(end);
+                        break;
+                case sf::Keyboard::Up:
+                        change_speed(1);
+                        break;
+                case sf::Keyboard::Down:
+                        change_speed(-1);
+                        break;
+                default:
+                        return false;
+                }
+                return true;
+        case sf::Event::MouseButtonPressed:
+                if (event.mouseButton.button != sf::Mouse::Left || !on_bar(event.mouseButton.y, window_size))
+                        return false;
+                dragging = true;
+                seek(bar_time(event.mouseButton.x, window_size));
+                return true;
+        case sf::Event::MouseMoved:
+                if (!dragging)
+                        return false;
+                seek(bar_time(event.mouseMove.x, window_size));
+                return true;
+        case sf::Event::MouseButtonReleased:
+                if (!dragging)
+                        return false;
+                dragging = false;
+                return true;
+        default:
+                return false;
+        }
+}
+
+double PlaybackControl::update()
+{
+        double elapsed = clock.restart().asSeconds();
+        if (!paused && !dragging) {
+                seek(position + elapsed * speeds[speed_idx]);
+                if (position >= end)
+                        paused = true;
+        }
+
+        return position;
+}
+
+double PlaybackControl::time() const
+{
+        return position;
+}
+
+void PlaybackControl::draw(sf::RenderTarget &target, const sf::Font &font) const
+{
+        sf::Vector2u size = target.getSize();
+        float width = size.x - 2.0F * BAR_MARGIN;
+        float y = size.y - BAR_MARGIN;
+        float fraction = (end > start) ? (position - start) / (end - start) : 1.0F;
+
+        sf::RectangleShape bar(sf::Vector2f(width, BAR_HEIGHT));
+        bar.setPosition(BAR_MARGIN, y);
+        bar.setFillColor(sf::Color(0xDD, 0xDD, 0xDD));
+        target.draw(bar);
+
+        sf::RectangleShape done(sf::Vector2f(width * fraction, BAR_HEIGHT));
+        done.setPosition(BAR_MARGIN, y);
+        done.setFillColor(sf::Color(0x7E, 0x7E, 0x7E));
+        target.draw(done);
+
+        char status[128];
+        snprintf(status, sizeof(status), "t = %.4f s / %.4f s   %gx%s", position, end, speeds[speed_idx],
+                 paused ? "   (paused)" : "");
+        sf::Text text;
+        text.setFont(font);
+        text.setCharacterSize(16);
+        text.setFillColor(sf::Color(0x7E, 0x7E, 0x7E));
+        text.setPosition(BAR_MARGIN, y - 24.0F);
+        text.setString(status);
+        target.draw(text);
+}
@@ -0,0 +1,91 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef PLAYBACK_CONTROL_H
+#define PLAYBACK_CONTROL_H
+
+#include <SFML/Graphics.hpp>
+
+// Seek distances of the arrow and page keys [s]
+#define PLAYBACK_SEEK_SHORT 1.0
+#define PLAYBACK_SEEK_LONG 10.0
+
+/**
+ * Playback position of the visualizers, controlled with keyboard and
+ * mouse:
+ *
+ *   Space            pause / resume
+ *   . / ,            pause and step one frame forward / backward
+ *   Right / Left     seek 1 s forward / backward
+ *   PageUp / PageDn  seek 10 s forward / backward
+ *   Home / End       seek to start / end
+ *   Up / Down        faster / slower (0.1x to 100x)
+ *   mouse on bar     seek to the position clicked or dragged to
+ *
+ * The position advances with the wall-clock time multiplied by the
+ * speed. At the end of the trace, playback pauses.
+ */
+class PlaybackControl
+{
+      public:
+        /**
+         * @param start time of the first state [s]
+         * @param end time of the last state [s]
+         * @param frame_rate frames per second (duration of a step)
+         */
+        PlaybackControl(double start, double end, unsigned int frame_rate);
+
+        /**
+         * Handle a window event.
+         *
+         * @param event event
+         * @param window_size size of the window (position of the bar)
+         * @return true if the event was a playback control.
+         */
+        bool handle_event(const sf::Event &event, const sf::Vector2u &window_size);
+
+        /**
+         * Advance the position by the wall-clock time since the last
+         * call.
+         *
+         * @return position [s]
+         */
+        double update();
+
+        /**
+         * Position [s].
+         */
+        double time() const;
+
+        /**
+         * Draw the progress bar and the status line.
+         */
+        void draw(sf::RenderTarget &target, const sf::Font &font) const;
+
+      private:
+        void seek(double t);
+        void change_speed(int steps);
+
+        // Position on the bar of a point of the window [s].
+        double bar_time(int x, const sf::Vector2u &window_size) const;
+        bool on_bar(int y, const sf::Vector2u &window_size) const;
+
+        const double start;
+        const double end;
+        const double frame_period;
+
+        double position;
+        bool paused;
+        // Index of the speed in the list of speeds.
+        int speed_idx;
+        bool dragging;
+
+        sf::Clock clock;
+};
+
+#endif
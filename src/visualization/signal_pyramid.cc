@@ -0,0 +1,121 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "signal_pyramid.h"
+#include "state_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <errno.h>
+
+// Number of states read between checks for cancellation
+#define PYRAMID_CANCEL_CHECK 65536
+
+SignalPyramid::SignalPyramid() : start(0.0), width(1.0), force(false), built(false)
+{
+}
+
+bool SignalPyramid::build(const char *path, const std::atomic<bool> &cancel)
+{
+        StateTrace trace;
+        if (!trace.open(path))
+                return false;
+
+        size_t n = PYRAMID_MIN_BUCKETS;
+        while (n < PYRAMID_MAX_BUCKETS && n < trace.file_size() / PYRAMID_BYTES_PER_STATE)
+                n *= 2;
+        double t_start = trace.start_time();
+        double duration = trace.end_time() - t_start;
+        double w = (duration > 0.0) ? duration / n : 1.0;
+
+        Bucket empty;
+        std::fill(empty.lo, empty.lo + PYRAMID_SIGNALS, INFINITY);
+        std::fill(empty.hi, empty.hi + PYRAMID_SIGNALS, -INFINITY);
+        std::vector<std::vector<Bucket>> pyramid(1, std::vector<Bucket>(n, empty));
+
+        size_t position = 0;
+        time_state_t state;
+        double u;
+        bool has_u = false;
+        for (size_t k = 1; trace.scan(position, state, &u); k++) {
+                if (k % PYRAMID_CANCEL_CHECK == 0 && cancel.load(std::memory_order_relaxed))
+                        return false;
+                double i = std::floor((state.first - t_start) / w);
+                Bucket &b = pyramid[0][(size_t)std::min(std::max(i, 0.0), (double)(n - 1))];
+                for (int s = 0; s < 4; s++) {
+                        float v = state.second[s];
+                        b.lo[s] = std::min(b.lo[s], v);
+                        b.hi[s] = std::max(b.hi[s], v);
+                }
+                if (!std::isnan(u)) {
+                        has_u = true;
+                        b.lo[4] = std::min(b.lo[4], (float)u);
+                        b.hi[4] = std::max(b.hi[4], (float)u);
+                }
+        }
+
+        while (pyramid.back().size() > 1) {
+                const std::vector<Bucket> &below = pyramid.back();
+                std::vector<Bucket> level(below.size() / 2);
+                for (size_t i = 0; i < level.size(); i++) {
+                        for (int s = 0; s < PYRAMID_SIGNALS; s++) {
+                                level[i].lo[s] = std::min(below[2 * i].lo[s], below[2 * i + 1].lo[s]);
+                                level[i].hi[s] = std::max(below[2 * i].hi[s], below[2 * i + 1].hi[s]);
+                        }
+                }
+                pyramid.push_back(std::move(level));
+        }
+
+        levels = std::move(pyramid);
+        start = t_start;
+        width = w;
+        force = has_u;
+        built.store(true, std::memory_order_release);
+
+        return true;
+}
+
+bool SignalPyramid::ready() const
+{
+        return built.load(std::memory_order_acquire);
+}
+
+bool SignalPyramid::has_force() const
+{
+        return force;
+}
+
+void SignalPyramid::query(int signal, double t0, double dt, size_t n, float *lo, float *hi) const
+{
+        // Coarsest level with buckets not wider than an interval.
+        size_t level = 0;
+        double w = width;
+        while (level + 1 < levels.size() && 2.0 * w <= dt) {
+                level++;
+                w *= 2.0;
+        }
+        const std::vector<Bucket> &buckets = levels[level];
+        double n_buckets = buckets.size();
+
+        for (size_t i = 0; i < n; i++) {
+                lo[i] = INFINITY;
+                hi[i] = -INFINITY;
+                double a = std::floor((t0 + i * dt - start) / w);
+                double b = std::ceil((t0 + (i + 1) * dt - start) / w);
+                b = std::max(b, a + 1.0);
+                a = std::max(a, 0.0);
+                b = std::min(b, n_buckets);
+                // Outside of the trace.
+                if (b <= a)
+                        continue;
+                for (size_t k = (size_t)a; k < (size_t)b; k++) {
+                        lo[i] = std::min(lo[i], buckets[k].lo[signal]);
+                        hi[i] = std::max(hi[i], buckets[k].hi[signal]);
+                }
+        }
+}
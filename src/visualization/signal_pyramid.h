@@ -0,0 +1,99 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef SIGNAL_PYRAMID_H
+#define SIGNAL_PYRAMID_H
+
+#include <atomic>
+#include <stddef.h>
+#include <vector>
+
+// Range of the number of buckets of the finest level (a power of 2 near
+// the number of states of the trace).
+#define PYRAMID_MIN_BUCKETS 1024
+#define PYRAMID_MAX_BUCKETS (1 << 19)
+
+// Number of signals (x, v, phi, omega, u)
+#define PYRAMID_SIGNALS 5
+
+// Average length of a line of a trace for estimating the number of
+// states from the size of the file [bytes]
+#define PYRAMID_BYTES_PER_STATE 48
+
+/**
+ * Min/max decimation pyramid of the signals of a state trace (x, v, phi,
+ * omega, and the force u if the trace has it) for plotting traces of any
+ * length.
+ *
+ * The finest level divides the duration of the trace into buckets of
+ * equal length holding the minimum and maximum of each signal within the
+ * bucket; each further level merges pairs of buckets of the level below.
+ * A query for the min/max per pixel column reads the coarsest level whose
+ * buckets are not wider than a column, i.e., at most three buckets per
+ * column, so plotting takes time proportional to the number of columns
+ * and not to the number of states shown.
+ */
+class SignalPyramid
+{
+      public:
+        SignalPyramid();
+
+        /**
+         * Build the pyramid from all states of a trace (one pass over the
+         * file).
+         *
+         * @param path path of the trace
+         * @param cancel stops building when set
+         * @return true on success; false on error (errno is set) or if
+         * cancelled.
+         */
+        bool build(const char *path, const std::atomic<bool> &cancel);
+
+        /**
+         * @return true if build() has finished successfully (then the
+         * pyramid can be queried by other threads).
+         */
+        bool ready() const;
+
+        /**
+         * @return true if the trace has a force column (only valid if
+         * ready()).
+         */
+        bool has_force() const;
+
+        /**
+         * Get the minimum and maximum of a signal over consecutive
+         * intervals of time (e.g., the pixel columns of a plot).
+         *
+         * @param signal index of the signal (0: x, 1: v, 2: phi, 3: omega,
+         * 4: u)
+         * @param t0 start of the first interval [s]
+         * @param dt length of an interval [s]
+         * @param n number of intervals
+         * @param lo receives the minimum of each interval (greater than
+         * the maximum if the interval holds no states)
+         * @param hi receives the maximum of each interval
+         */
+        void query(int signal, double t0, double dt, size_t n, float *lo, float *hi) const;
+
+      private:
+        struct Bucket {
+                float lo[PYRAMID_SIGNALS];
+                float hi[PYRAMID_SIGNALS];
+        };
+
+        std::vector<std::vector<Bucket>> levels;
+        double start;
+        // Length of the buckets of the finest level [s]
+        double width;
+        bool force;
+
+        std::atomic<bool> built;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "software_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int width, unsigned int height)
+    : w(width), h(height), rgba((size_t)width * height * 4, 0)
+{
+}
+
+void SoftwareRasterizer::clear(const sf::Color &color)
+{
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+                rgba[i] = color.r;
+                rgba[i + 1] = color.g;
+                rgba[i + 2] = color.b;
+                rgba[i + 3] = color.a;
+        }
+}
+
+void SoftwareRasterizer::draw(const sf::VertexArray &triangles)
+{
+        for (size_t i = 0; i + 2 < triangles.getVertexCount(); i += 3)
+                fill_triangle(triangles[i], triangles[i + 1], triangles[i + 2]);
+}
+
+void SoftwareRasterizer::fill_triangle(const sf::Vertex &a, const sf::Vertex &b, const sf::Vertex &c)
+{
+        sf::Vector2f p0 = a.position;
+        sf::Vector2f p1 = b.position;
+        sf::Vector2f p2 = c.position;
+
+        // Counter-clockwise in the coordinates of the image (y down), such
+        // that all edge functions are non-negative inside.
+        float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+        if (area == 0.0F)
+                return;
+        if (area < 0.0F)
+                std::swap(p1, p2);
+
+        int x_min = std::max(0, (int)std::floor(std::min({p0.x, p1.x, p2.x})));
+        int x_max = std::min((int)w - 1, (int)std::ceil(std::max({p0.x, p1.x, p2.x})));
+        int y_min = std::max(0, (int)std::floor(std::min({p0.y, p1.y, p2.y})));
+        int y_max = std::min((int)h - 1, (int)std::ceil(std::max({p0.y, p1.y, p2.y})));
+
+        const sf::Color &color = a.color;
+        unsigned int alpha = color.a;
+        unsigned int keep = 255 - alpha;
+
+        // Edge function of edge (u, v) at pixel center (x, y):
+        // (v.x - u.x) * (y - u.y) - (v.y - u.y) * (x - u.x); it changes by
+        // -(v.y - u.y) per pixel in x.
+        const sf::Vector2f *edges[3][2] = {{&p0, &p1}, {&p1, &p2}, {&p2, &p0}};
+        for (int y = y_min; y <= y_max; y++) {
+                float py = y + 0.5F;
+                float e[3];
+                float dx[3];
+                for (int k = 0; k < 3; k++) {
+                        const sf::Vector2f &u = *edges[k][0];
+                        const sf::Vector2f &v = *edges[k][1];
+                        e[k] = (v.x - u.x) * (py - u.y) - (v.y - u.y) * (x_min + 0.5F - u.x);
+                        dx[k] = -(v.y - u.y);
+                }
+                sf::Uint8 *p = &rgba[((size_t)y * w + x_min) * 4];
+                for (int x = x_min; x <= x_max; x++, p += 4) {
+                        if (e[0] >= 0.0F && e[1] >= 0.0F && e[2] >= 0.0F) {
+                                if (alpha == 255) {
+                                        p[0] = color.r;
+                                        p[1] = color.g;
+                                        p[2] = color.b;
+                                } else {
+                                        p[0] = (color.r * alpha + p[0] * keep + 127) / 255;
+                                        p[1] = (color.g * alpha + p[1] * keep + 127) / 255;
+                                        p[2] = (color.b * alpha + p[2] * keep + 127) / 255;
+                                }
+                                p[3] = 255;
+                        }
+                        e[0] += dx[0];
+                        e[1] += dx[1];
+                        e[2] += dx[2];
+                }
+        }
+}
+
+const sf::Uint8 *SoftwareRasterizer::pixels() const
+{
+        return rgba.data();
+}
+
+unsigned int SoftwareRasterizer::width() const
+{
+        return w;
+}
+
+unsigned int SoftwareRasterizer::height() const
+{
+        return h;
+}
@@ -0,0 +1,56 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/**
+ * Renders triangles into an RGBA image in memory without OpenGL, so that
+ * frames can be rendered on machines without a display server and by
+ * several threads at once (one rasterizer per thread).
+ *
+ * Triangles are filled with the color of their first vertex (the shapes
+ * of PendulumBatch have one color each) and blended with its alpha.
+ * Pixels are sampled at their centers, i.e., edges are not antialiased.
+ */
+class SoftwareRasterizer
+{
+      public:
+        SoftwareRasterizer(unsigned int width, unsigned int height);
+
+        /**
+         * Fill the image with a color.
+         */
+        void clear(const sf::Color &color);
+
+        /**
+         * Draw the triangles of a vertex array (primitive type
+         * sf::Triangles).
+         */
+        void draw(const sf::VertexArray &triangles);
+
+        /**
+         * Pixels of the image, row by row, 4 bytes (RGBA) each.
+         */
+        const sf::Uint8 *pixels() const;
+
+        unsigned int width() const;
+        unsigned int height() const;
+
+      private:
+        void fill_triangle(const sf::Vertex &a, const sf::Vertex &b, const sf::Vertex &c);
+
+        const unsigned int w;
+        const unsigned int h;
+        std::vector<sf::Uint8> rgba;
+};
+
+#endif
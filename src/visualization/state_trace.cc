@@ -0,0 +1,349 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "state_trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+StateTrace::StateTrace() : data(NULL), size(0), t_end(0.0), cursor_valid(false), cursor_next(0)
+{
+}
+
+StateTrace::~StateTrace()
+{
+        close();
+}
+
+bool StateTrace::open(const char *path)
+{
+        close();
+
+        int fd = ::open(path, O_RDONLY);
+        if (fd == -1)
+                return false;
+        struct stat st;
+        if (fstat(fd, &st) == -1) {
+                ::close(fd);
+                return false;
+        }
+        if (st.st_size == 0) {
+                ::close(fd);
+                errno = EINVAL;
+                return false;
+        }
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED)
+                return false;
+        data = (const char *)map;
+        size = st.st_size;
+
+        // Seeking touches few scattered pages; read-ahead would read
+        // most of the file while probing the index.
+        madvise(map, size, MADV_RANDOM);
+
+        for (size_t k = 0; k < TRACE_INDEX_POINTS; k++) {
+                time_state_t state;
+                size_t next;
+                size_t offset = next_state(line_start(size / TRACE_INDEX_POINTS * k), state, next);
+                if (offset == size)
+                        break;
+                if (!index.empty() && offset <= index.back().offset)
+                        continue;
+                // Not ordered by time: keep the index monotonic.
+                if (!index.empty() && state.first < index.back().t)
+                        continue;
+                index.push_back({state.first, offset});
+        }
+        if (index.empty()) {
+                close();
+                errno = EINVAL;
+                return false;
+        }
+
+        // Last state: search backwards from the end of the file.
+        t_end = index.back().t;
+        size_t end = size;
+        while (end > index.back().offset) {
+                const char *nl = (const char *)memrchr(data, '\n', end - 1);
+                size_t start = (nl == NULL) ? 0 : nl - data + 1;
+                time_state_t state;
+                size_t next;
+                if (parse_line(start, state, next)) {
+                        t_end = state.first;
+                        break;
+                }
+                end = start;
+        }
+
+        return true;
+}
+
+void StateTrace::close()
+{
+        if (data != NULL)
+                munmap((void *)data, size);
+        data = NULL;
+        size = 0;
+        index.clear();
+        cursor_valid = false;
+}
+
+double StateTrace::start_time() const
+{
+        return index.empty() ? 0.0 : index.front().t;
+}
+
+double StateTrace::end_time() const
+{
+        return t_end;
+}
+
+size_t StateTrace::index_size() const
+{
+        return index.size();
+}
+
+bool StateTrace::scan(size_t &position, time_state_t &state, double *u)
+{
+        if (data == NULL || position >= size)
+                return false;
+        if (position == 0)
+                madvise((void *)data, size, MADV_SEQUENTIAL);
+
+        size_t next;
+        if (next_state(position, state, next, u) >= size)
+                return false;
+        position = next;
+
+        return true;
+}
+
+size_t StateTrace::file_size() const
+{
+        return size;
+}
+
+size_t StateTrace::line_start(size_t offset) const
+{
+        if (offset == 0 || offset >= size)
+                return std::min(offset, size);
+        if (data[offset - 1] == '\n')
+                return offset;
+        const char *nl = (const char *)memchr(data + offset, '\n', size - offset);
+
+        return (nl == NULL) ? size : nl - data + 1;
+}
+
+bool StateTrace::parse_line(size_t offset, time_state_t &state, size_t &next, double *u) const
+{
+        const char *nl = (const char *)memchr(data + offset, '\n', size - offset);
+        size_t len = (nl == NULL) ? size - offset : nl - (data + offset);
+        next = (nl == NULL) ? size : offset + len + 1;
+
+        // The mapping is not terminated; decode a terminated copy.
+        if (len == 0 || len >= TRACE_MAX_LINE_LEN)
+                return false;
+        char line[TRACE_MAX_LINE_LEN];
+        memcpy(line, data + offset, len);
+        line[len] = '\0';
+        if (!isdigit(line[0]) && line[0] != '-' && line[0] != '+' && line[0] != '.')
+                return false;
+
+        char *p = line;
+        for (int i = 0; i < 5; i++) {
+                char *end;
+                double d = strtod(p, &end);
+                if (end == p)
+                        return false;
+                if (i == 0)
+                        state.first = d;
+                else
+                        state.second[i - 1] = d;
+                p = end;
+                if (i < 4) {
+                        if (*p != ',')
+                                return false;
+                        p++;
+                }
+        }
+
+        // Optional force.
+        double force = NAN;
+        if (*p == ',') {
+                char *start = p + 1;
+                force = strtod(start, &p);
+                if (p == start)
+                        return false;
+        }
+        while (isspace(*p))
+                p++;
+        if (*p != '\0')
+                return false;
+        if (u != NULL)
+                *u = force;
+
+        return true;
+}
+
+size_t StateTrace::next_state(size_t offset, time_state_t &state, size_t &next, double *u) const
+{
+        while (offset < size) {
+                if (parse_line(offset, state, next, u))
+                        return offset;
+                offset = next;
+        }
+
+        return size;
+}
+
+bool StateTrace::parse_time(size_t offset, double &t, size_t &next) const
+{
+        const char *line = data + offset;
+        const char *nl = (const char *)memchr(line, '\n', size - offset);
+        size_t len = (nl == NULL) ? size - offset : nl - line;
+        next = (nl == NULL) ? size : offset + len + 1;
+
+        if (len == 0 || len >= TRACE_MAX_LINE_LEN)
+                return false;
+        if (!isdigit(line[0]) && line[0] != '-' && line[0] != '+' && line[0] != '.')
+                return false;
+        size_t field = 0;
+        int commas = 0;
+        for (size_t i = 0; i < len; i++) {
+                if (line[i] == ',') {
+                        if (commas == 0)
+                                field = i;
+                        commas++;
+                }
+        }
+        if (commas != 4 && commas != 5)
+                return false;
+
+        char time[TRACE_MAX_LINE_LEN];
+        memcpy(time, line, field);
+        time[field] = '\0';
+        char *end;
+        t = strtod(time, &end);
+
+        return (end == time + field);
+}
+
+size_t StateTrace::next_time(size_t offset, double &t, size_t &next) const
+{
+        while (offset < size) {
+                if (parse_time(offset, t, next))
+                        return offset;
+                offset = next;
+        }
+
+        return size;
+}
+
+size_t StateTrace::seek(double t) const
+{
+        // Index entry of the last state with time <= t.
+        auto it = std::upper_bound(index.begin(), index.end(), t,
+                                   [](double time, const IndexEntry &e) { return time < e.t; });
+        if (it == index.begin())
+                return index.front().offset;
+        size_t lo = (it - 1)->offset;
+        size_t hi = (it == index.end()) ? size : it->offset;
+
+        // Bisect the bytes: the state at lo has time <= t, the state at hi
+        // (if any) time > t.
+        double time;
+        size_t next;
+        while (hi - lo > TRACE_SCAN_BYTES) {
+                size_t mid = next_time(line_start(lo + (hi - lo) / 2), time, next);
+                if (mid >= hi)
+                        break;
+                if (time <= t)
+                        lo = mid;
+                else
+                        hi = mid;
+        }
+
+        // Scan the remaining lines.
+        size_t offset = lo;
+        parse_time(lo, time, next);
+        while (next < hi) {
+                size_t following;
+                size_t candidate = next_time(next, time, following);
+                if (candidate >= hi || time > t)
+                        break;
+                offset = candidate;
+                next = following;
+        }
+
+        return offset;
+}
+
+bool StateTrace::state_at(double t, time_state_t &state)
+{
+        if (data == NULL)
+                return false;
+
+        // Playback: scan forward from the last state if it is close. Only
+        // the state finally reached is decoded completely.
+        if (cursor_valid && cursor_state.first <= t) {
+                size_t offset = cursor_next;
+                size_t limit = std::min(size, cursor_next + TRACE_SCAN_BYTES);
+                size_t found = size;
+                double time;
+                size_t next;
+                while (offset < limit) {
+                        size_t candidate = next_time(offset, time, next);
+                        if (candidate >= size || time > t)
+                                break;
+                        found = candidate;
+                        offset = next;
+                }
+                if (offset < limit || offset >= size) {
+                        if (found == size || parse_line(found, cursor_state, cursor_next)) {
+                                state = cursor_state;
+                                return true;
+                        }
+                }
+        }
+
+        size_t offset = seek(t);
+        cursor_valid = parse_line(offset, cursor_state, cursor_next);
+        state = cursor_state;
+
+        return cursor_valid;
+}
+
+bool StateTrace::interpolate(double t, time_state_t &state)
+{
+        if (!state_at(t, state))
+                return false;
+        if (t <= state.first)
+                return true;
+
+        time_state_t after;
+        size_t next;
+        if (next_state(cursor_next, after, next) == size || after.first <= state.first)
+                return true;
+
+        double alpha = (t - state.first) / (after.first - state.first);
+        for (int i = 0; i < 4; i++)
+                state.second[i] += alpha * (after.second[i] - state.second[i]);
+        state.first = t;
+
+        return true;
+}
@@ -0,0 +1,178 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef STATE_TRACE_H
+#define STATE_TRACE_H
+
+#include "../inverted_pendulum/inverted_pendulum.h"
+
+#include <stddef.h>
+#include <vector>
+
+// Number of evenly spaced byte offsets probed for the time index.
+#define TRACE_INDEX_POINTS 1024
+
+// Seeking bisects the byte range until it is shorter than this, then
+// scans lines. Playback also scans forward up to this distance.
+#define TRACE_SCAN_BYTES 1024
+
+// Lines longer than this are not states.
+#define TRACE_MAX_LINE_LEN 256
+
+/**
+ * Read-only access to a recorded state trace (CSV lines t,x,v,phi,omega
+ * in increasing time, as written by the simulators and ncs-plant, or
+ * t,x,v,phi,omega,u with the force as written by ncs-plant -F) without
+ * loading it.
+ *
+ * The file is memory-mapped, and only the lines needed are decoded. When
+ * opening, the times at TRACE_INDEX_POINTS evenly spaced byte offsets form
+ * a sparse time index, so opening costs the same for any size of trace.
+ * Seeking to a time bisects the byte range between two index entries
+ * (O(log n) in the number of states); playback continues from the last
+ * position by scanning forward.
+ *
+ * Lines that are no states (header, comments starting with #, malformed
+ * lines) are skipped.
+ */
+class StateTrace
+{
+      public:
+        StateTrace();
+        ~StateTrace();
+
+        /**
+         * Map a trace and build the time index.
+         *
+         * @param path path of CSV file
+         * @return true on success; false on error (errno is set; EINVAL
+         * if the file contains no state).
+         */
+        bool open(const char *path);
+
+        /**
+         * Unmap the trace.
+         */
+        void close();
+
+        /**
+         * Time of the first and last state [s].
+         */
+        double start_time() const;
+        double end_time() const;
+
+        /**
+         * Get the newest state at a given time.
+         *
+         * @param t time [s]
+         * @param state receives the last state with time <= t (the first
+         * state if t is before the start)
+         * @return true on success; false if no trace is open or the line
+         * of the state is malformed.
+         */
+        bool state_at(double t, time_state_t &state);
+
+        /**
+         * Get the state at a given time, interpolated linearly between the
+         * stored states before and after it (for playback speeds at which
+         * frames fall between samples).
+         *
+         * @param t time [s]
+         * @param state receives the state (time t within the trace)
+         * @return true on success; false if no trace is open or the line
+         * of the state is malformed.
+         */
+        bool interpolate(double t, time_state_t &state);
+
+        /**
+         * Read all states one after another (e.g., for summaries of the
+         * whole trace). Starting a scan switches the mapping to
+         * sequential read-ahead, so use a separate instance for playback.
+         *
+         * @param position position in the file (0 to start at the first
+         * state); advanced to the following state
+         * @param state receives the state
+         * @param u receives the force of the state if not NULL (NAN if
+         * the trace has no force)
+         * @return true if there was a state; false at the end of the
+         * trace.
+         */
+        bool scan(size_t &position, time_state_t &state, double *u = NULL);
+
+        /**
+         * Size of the file [bytes].
+         */
+        size_t file_size() const;
+
+        /**
+         * Number of entries of the time index.
+         */
+        size_t index_size() const;
+
+      private:
+        struct IndexEntry {
+                double t;
+                size_t offset;
+        };
+
+        /**
+         * Decode the line at an offset.
+         *
+         * @param offset start of line
+         * @param state receives the state
+         * @param next receives the start of the following line
+         * @param u receives the force if not NULL (NAN if the line has
+         * no force)
+         * @return true if the line is a state.
+         */
+        bool parse_line(size_t offset, time_state_t &state, size_t &next, double *u = NULL) const;
+
+        /**
+         * Start of the first line at or after an offset.
+         */
+        size_t line_start(size_t offset) const;
+
+        /**
+         * First state at or after the start of a line.
+         *
+         * @return offset of the state; size of the file if there is none.
+         */
+        size_t next_state(size_t offset, time_state_t &state, size_t &next, double *u = NULL) const;
+
+        /**
+         * Decode the time of a line only (for scanning; a line is
+         * checked completely when its state is decoded).
+         *
+         * @return true if the line starts with a time followed by four
+         * or five further fields.
+         */
+        bool parse_time(size_t offset, double &t, size_t &next) const;
+
+        /**
+         * Like next_state(), decoding the time only.
+         */
+        size_t next_time(size_t offset, double &t, size_t &next) const;
+
+        /**
+         * Offset of the last state with time <= t.
+         */
+        size_t seek(double t) const;
+
+        const char *data;
+        size_t size;
+        std::vector<IndexEntry> index;
+        double t_end;
+
+        // Last state returned by state_at() and the start of the
+        // following line.
+        bool cursor_valid;
+        time_state_t cursor_state;
+        size_t cursor_next;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#include "strip_charts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <string>
+
+// Distance of the charts from the left and right border and between two
+// charts [px]
+#define CHART_MARGIN 20
+#define CHART_PADDING 4
+
+// Range of the time shown [s]
+#define CHART_MIN_SPAN 0.001
+#define CHART_MAX_SPAN 100000.0
+
+struct chart_signal_t {
+        // Index in the state
+        int index;
+        const char *label;
+};
+
+static const chart_signal_t chart_signals[CHART_COUNT] = {
+        {2, "phi [rad]"},
+        {0, "x [m]"},
+        {3, "omega [rad/s]"},
+};
+
+// Replaces the last chart if the trace has a force.
+static const chart_signal_t chart_force = {4, "u [N]"};
+
+StripCharts::StripCharts(float top, double span)
+    : top(top), span(span), cancel(false), failed(false), lines(sf::Lines)
+{
+}
+
+StripCharts::~StripCharts()
+{
+        cancel = true;
+        if (builder.joinable())
+                builder.join();
+}
+
+void StripCharts::open(const char *path)
+{
+        builder = std::thread([this](std::string path) {
+                if (!pyramid.build(path.c_str(), cancel))
+                        failed = true;
+        }, std::string(path));
+}
+
+void StripCharts::zoom(double factor)
+{
+        span = std::min(std::max(span * factor, CHART_MIN_SPAN), CHART_MAX_SPAN);
+}
+
+bool StripCharts::handle_event(const sf::Event &event)
+{
+        switch (event.type) {
+        case sf::Event::KeyPressed:
+                switch (event.key.code) {
+                case sf::Keyboard::Add:
+                case sf::Keyboard::Equal:
+                        zoom(0.5);
+                        return true;
+                case sf::Keyboard::Subtract:
+                case sf::Keyboard::Hyphen:
+                        zoom(2.0);
+                        return true;
+                default:
+                        return false;
+                }
+        case sf::Event::MouseWheelScrolled:
+                if (event.mouseWheelScroll.y < top || event.mouseWheelScroll.y >= top + CHART_COUNT * CHART_HEIGHT)
+                        return false;
+                zoom(event.mouseWheelScroll.delta > 0 ? 0.5 : 2.0);
+                return true;
+        default:
+                return false;
+        }
+}
+
+void StripCharts::draw(sf::RenderTarget &target, const sf::Font &font, double t)
+{
+        const sf::Color grey = sf::Color(0x7E, 0x7E, 0x7E);
+        const sf::Color light_grey = sf::Color(0xDD, 0xDD, 0xDD);
+        const sf::Color blue = sf::Color(0x33, 0x55, 0xAA);
+        const sf::Color red = sf::Color(0xCC, 0x33, 0x33);
+
+        sf::Text text;
+        text.setFont(font);
+        text.setCharacterSize(12);
+        text.setFillColor(grey);
+
+        if (!pyramid.ready()) {
+                text.setPosition(CHART_MARGIN, top + CHART_PADDING);
+                text.setString(failed ? "charts not available" : "building charts ...");
+                target.draw(text);
+                return;
+        }
+
+        sf::Vector2u size = target.getSize();
+        size_t n = (size.x > 2 * CHART_MARGIN) ? size.x - 2 * CHART_MARGIN : 1;
+        lo.resize(n);
+        hi.resize(n);
+        double dt = span / n;
+        double t0 = t - 0.5 * span;
+        float left = CHART_MARGIN;
+        float right = CHART_MARGIN + n;
+
+        lines.clear();
+        std::vector<sf::Text> labels;
+        for (int c = 0; c < CHART_COUNT; c++) {
+                float y_top = top + c * CHART_HEIGHT + CHART_PADDING;
+                float y_bottom = top + (c + 1) * CHART_HEIGHT - CHART_PADDING;
+                float height = y_bottom - y_top;
+
+                lines.append(sf::Vertex(sf::Vector2f(left, y_top), light_grey));
+                lines.append(sf::Vertex(sf::Vector2f(right, y_top), light_grey));
+                lines.append(sf::Vertex(sf::Vector2f(left, y_bottom), light_grey));
+                lines.append(sf::Vertex(sf::Vector2f(right, y_bottom), light_grey));
+
+                const chart_signal_t &signal =
+                        (c == CHART_COUNT - 1 && pyramid.has_force()) ? chart_force : chart_signals[c];
+                pyramid.query(signal.index, t0, dt, n, lo.data(), hi.data());
+                float vmin = INFINITY;
+                float vmax = -INFINITY;
+                for (size_t i = 0; i < n; i++) {
+                        if (lo[i] <= hi[i]) {
+                                vmin = std::min(vmin, lo[i]);
+                                vmax = std::max(vmax, hi[i]);
+                        }
+                }
+
+                char label[128];
+                if (vmin > vmax) {
+                        snprintf(label, sizeof(label), "%s", signal.label);
+                } else {
+                        snprintf(label, sizeof(label), "%s   %.4g .. %.4g", signal.label, vmin, vmax);
+                        if (vmax - vmin < 1e-9F) {
+                                vmin -= 1e-9F;
+                                vmax += 1e-9F;
+                        }
+                        float scale = height / (vmax - vmin);
+                        if (vmin < 0.0F && vmax > 0.0F) {
+                                float y0 = y_bottom + vmin * scale;
+                                lines.append(sf::Vertex(sf::Vector2f(left, y0), light_grey));
+                                lines.append(sf::Vertex(sf::Vector2f(right, y0), light_grey));
+                        }
+
+                        // One vertical line per column, extended to the
+                        // previous column so that steep edges stay
+                        // connected.
+                        bool prev = false;
+                        float prev_lo = 0.0F;
+                        float prev_hi = 0.0F;
+                        for (size_t i = 0; i < n; i++) {
+                                if (lo[i] > hi[i]) {
+                                        prev = false;
+                                        continue;
+                                }
+                                float a = lo[i];
+                                float b = hi[i];
+                                if (prev) {
+                                        a = std::min(a, prev_hi);
+                                        b = std::max(b, prev_lo);
+                                }
+                                prev = true;
+                                prev_lo = lo[i];
+                                prev_hi = hi[i];
+
+                                float x = left + i + 0.5F;
+                                float ya = y_bottom - (a - vmin) * scale + 0.5F;
+                                float yb = y_bottom - (b - vmin) * scale - 0.5F;
+                                lines.append(sf::Vertex(sf::Vector2f(x, ya), blue));
+                                lines.append(sf::Vertex(sf::Vector2f(x, yb), blue));
+                        }
+                }
+
+                sf::Text text_label = text;
+                text_label.setPosition(left + CHART_PADDING, y_top);
+                text_label.setString(label);
+                labels.push_back(text_label);
+        }
+
+        // Playback position in the middle.
+        float x = left + 0.5F * n;
+        lines.append(sf::Vertex(sf::Vector2f(x, top), red));
+        lines.append(sf::Vertex(sf::Vector2f(x, top + CHART_COUNT * CHART_HEIGHT), red));
+
+        target.draw(lines);
+        for (const sf::Text &label : labels)
+                target.draw(label);
+
+        char status[64];
+        snprintf(status, sizeof(status), "%g s shown", span);
+        text.setString(status);
+        text.setPosition(right - 80.0F, top + CHART_PADDING);
+        target.draw(text);
+}
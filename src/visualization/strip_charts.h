@@ -0,0 +1,89 @@
+/**
+ * SPDX-FileCopyrightText: 2025 University of Stuttgart
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * SPDX-FileContributor: Frank Duerr (frank.duerr@ipvs.uni-stuttgart.de)
+ */
+
+#ifndef STRIP_CHARTS_H
+#define STRIP_CHARTS_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "signal_pyramid.h"
+
+// Height of one chart [px]
+#define CHART_HEIGHT 80
+
+// Number of charts (phi, x, and u or omega)
+#define CHART_COUNT 3
+
+/**
+ * Strip charts of the angle, position, and force of a trace around the
+ * playback position, drawn below the pendulum (the angular velocity
+ * instead of the force if the trace has no force):
+ *
+ *   + / -            zoom in / out (halve / double the time shown)
+ *   mouse wheel      zoom in / out (over the charts)
+ *
+ * The charts follow the playback position, i.e., seeking pans them. Each
+ * pixel column shows the range of the signal within its time interval
+ * (see SignalPyramid), and the value axis fits the range shown. The
+ * pyramid is built in a background thread, so playback starts
+ * immediately.
+ */
+class StripCharts
+{
+      public:
+        /**
+         * @param top position of the charts in the window [px]
+         * @param span time shown initially [s]
+         */
+        StripCharts(float top, double span);
+
+        /**
+         * Stops building the pyramid.
+         */
+        ~StripCharts();
+
+        /**
+         * Start building the pyramid of a trace in the background.
+         */
+        void open(const char *path);
+
+        /**
+         * Handle a window event.
+         *
+         * @return true if the event was a chart control.
+         */
+        bool handle_event(const sf::Event &event);
+
+        /**
+         * Draw the charts centered at a time.
+         *
+         * @param t time [s]
+         */
+        void draw(sf::RenderTarget &target, const sf::Font &font, double t);
+
+      private:
+        void zoom(double factor);
+
+        const float top;
+        double span;
+
+        SignalPyramid pyramid;
+        std::thread builder;
+        std::atomic<bool> cancel;
+        std::atomic<bool> failed;
+
+        // Min/max per pixel column (reused every frame).
+        std::vector<float> lo;
+        std::vector<float> hi;
+        sf::VertexArray lines;
+};
+
+#endif